@@ -0,0 +1,625 @@
+/*
+// Copyright (c) 2015 Pierre Guillot.
+// For information on usage and redistribution, and for a DISCLAIMER OF ALL
+// WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+*/
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+
+#include <Hoa.hpp>
+using namespace hoa;
+
+template <typename Function>
+double hoa_benchmark(const size_t iterations, Function function)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < iterations; ++i)
+    {
+        function();
+    }
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / double(iterations);
+}
+
+template <Dimension D>
+void hoa_benchmark_regular(const char* name, const size_t order, const size_t nplws, const size_t vectorsize)
+{
+    DecoderRegular<D, float> decoder(order, nplws);
+    decoder.prepare(vectorsize);
+    const size_t nharm = decoder.getNumberOfHarmonics();
+
+    std::vector<float> inputs(nharm * vectorsize);
+    std::vector<float> outputs(nplws * vectorsize);
+    std::vector<float> harmonics(nharm);
+    std::vector<float> planewaves(nplws);
+    std::vector<const float*> ins(nharm);
+    std::vector<float*> outs(nplws);
+    for(size_t i = 0; i < inputs.size(); ++i)
+    {
+        inputs[i] = std::sin(float(i) * 0.37f);
+    }
+    for(size_t i = 0; i < nharm; ++i) { ins[i] = inputs.data() + i * vectorsize; }
+    for(size_t i = 0; i < nplws; ++i) { outs[i] = outputs.data() + i * vectorsize; }
+
+    auto sample = [&]()
+    {
+        for(size_t j = 0; j < vectorsize; ++j)
+        {
+            for(size_t i = 0; i < nharm; ++i) { harmonics[i] = ins[i][j]; }
+            decoder.process(harmonics.data(), planewaves.data());
+            for(size_t i = 0; i < nplws; ++i) { outs[i][j] = planewaves[i]; }
+        }
+    };
+    auto block = [&]() { decoder.processBlock(ins.data(), outs.data()); };
+
+    const size_t iterations = 2000;
+    const double tsample = hoa_benchmark(iterations, sample);
+    decoder.setTransposed(true);
+    const double ttransposed = hoa_benchmark(iterations, sample);
+    const double tblock = hoa_benchmark(iterations, block);
+    std::printf("%s order %zu, %zu planewaves, %zu samples: "
+                "process %.2f us, transposed %.2f us, block %.2f us (x%.1f)\n",
+                name, order, nplws, vectorsize, tsample, ttransposed, tblock, tsample / tblock);
+}
+
+void hoa_benchmark_irregular_ring(const size_t order, const size_t nplws)
+{
+    DecoderIrregular<Hoa2d, float> decoder(order, nplws);
+    for(size_t i = 0; i < nplws; ++i)
+    {
+        decoder.setPlanewaveAzimuth(i, (float(i) + 0.3f * std::sin(float(i))) * float(HOA_2PI) / float(nplws));
+    }
+    const double tprepare = hoa_benchmark(200, [&]() { decoder.prepare(64); });
+    std::printf("DecoderIrregular 2D order %zu, %zu planewaves: prepare %.2f us\n", order, nplws, tprepare);
+}
+
+void hoa_benchmark_irregular(const size_t order)
+{
+    // a dome of 60 loudspeakers
+    const std::vector<std::pair<size_t, float>> rings = {{24, 0.f}, {16, 0.35f}, {12, 0.8f}, {7, 1.2f}, {1, 1.5707963f}};
+    DecoderIrregular<Hoa3d, float> decoder(order, 60);
+    size_t index = 0;
+    for(auto const& ring : rings)
+    {
+        for(size_t i = 0; i < ring.first; ++i, ++index)
+        {
+            decoder.setPlanewaveAzimuth(index, float(i) * float(HOA_2PI) / float(ring.first));
+            decoder.setPlanewaveElevation(index, ring.second);
+        }
+    }
+    const double tprepare = hoa_benchmark(20, [&]() { decoder.prepare(64); });
+    std::printf("DecoderIrregular 3D order %zu, 60 planewaves: prepare %.2f ms\n", order, tprepare / 1000.);
+}
+
+template <class Decoder>
+void hoa_benchmark_inversion(const char* name, const size_t order, const size_t nplws)
+{
+    Decoder decoder(order, nplws);
+    for(size_t i = 0; i < nplws; ++i)
+    {
+        decoder.setPlanewaveAzimuth(i, float(i) * 2.39996323f);
+        decoder.setPlanewaveElevation(i, std::asin(1.f - (2.f * float(i) + 1.f) / float(nplws)));
+    }
+    const size_t nharm = decoder.getNumberOfHarmonics();
+    const double tprepare = hoa_benchmark(5, [&]() { decoder.prepare(64); });
+    std::printf("%s order %zu, %zu planewaves: prepare %.2f ms, matrix %zu kB, svd workspace ~%zu kB\n",
+                name, order, nplws, tprepare / 1000., nplws * nharm * sizeof(float) / 1024,
+                3 * nplws * nharm * sizeof(double) / 1024);
+}
+
+void hoa_benchmark_cache(const size_t order, const size_t nplws)
+{
+    DecoderModeMatching<Hoa3d, float> decoder(order, nplws);
+    for(size_t i = 0; i < nplws; ++i)
+    {
+        decoder.setPlanewaveAzimuth(i, float(i) * 2.39996323f);
+        decoder.setPlanewaveElevation(i, std::asin(1.f - (2.f * float(i) + 1.f) / float(nplws)));
+    }
+    DecoderCache<Hoa3d, float> cache(".");
+    const std::string path = cache.getPath(DecoderCache<Hoa3d, float>::hash(decoder));
+    std::remove(path.c_str());
+    const double tcold = hoa_benchmark(1, [&]() { cache.prepare(decoder); });
+    const double twarm = hoa_benchmark(20, [&]() { cache.prepare(decoder); });
+    std::remove(path.c_str());
+    std::printf("DecoderCache DecoderModeMatching 3D order %zu, %zu planewaves: "
+                "cold %.2f ms, cached %.3f ms\n", order, nplws, tcold / 1000., twarm / 1000.);
+}
+
+void hoa_benchmark_panner(std::vector<std::pair<size_t, float>> const& rings, const size_t nsources, const size_t vectorsize)
+{
+    size_t nplws = 0;
+    for(auto const& ring : rings) { nplws += ring.first; }
+    Panner<Hoa3d, float> panner(nplws, nsources, vectorsize);
+    size_t index = 0;
+    for(auto const& ring : rings)
+    {
+        for(size_t i = 0; i < ring.first; ++i, ++index)
+        {
+            panner.setPlanewaveAzimuth(index, float(i) * float(HOA_2PI) / float(ring.first));
+            panner.setPlanewaveElevation(index, ring.second);
+        }
+    }
+    const double tprepare = hoa_benchmark(20, [&]() { panner.prepare(); });
+
+    std::vector<float> inputs(nsources * vectorsize);
+    std::vector<float> outputs(nplws * vectorsize);
+    std::vector<const float*> ins(nsources);
+    std::vector<float*> outs(nplws);
+    for(size_t i = 0; i < inputs.size(); ++i)
+    {
+        inputs[i] = std::sin(float(i) * 0.37f);
+    }
+    for(size_t i = 0; i < nsources; ++i) { ins[i] = inputs.data() + i * vectorsize; }
+    for(size_t i = 0; i < nplws; ++i) { outs[i] = outputs.data() + i * vectorsize; }
+
+    size_t step = 0;
+    const double tmove = hoa_benchmark(100, [&]()
+    {
+        for(size_t i = 0; i < nsources; ++i, ++step)
+        {
+            panner.setAzimuth(i, float(step) * 0.731f);
+            panner.setElevation(i, std::sin(float(step) * 0.377f));
+        }
+    });
+    const double tblock = hoa_benchmark(2000, [&]() { panner.processBlock(ins.data(), outs.data()); });
+    std::printf("Panner 3D %zu planewaves, %zu sources, %zu samples: prepare %.2f us, "
+                "move all sources %.2f us, block %.2f us\n",
+                nplws, nsources, vectorsize, tprepare, tmove, tblock);
+}
+
+void hoa_benchmark_sparse(const size_t nharm, const size_t nplws, const size_t vectorsize)
+{
+    std::vector<float> matrix(nplws * nharm);
+    std::vector<float> packed(Signal<float>::packsize(nharm, nplws));
+    std::vector<float> inputs(nharm * vectorsize);
+    std::vector<float> outputs(nplws * vectorsize);
+    std::vector<const float*> ins(nharm);
+    std::vector<float*> outs(nplws);
+    for(size_t i = 0; i < inputs.size(); ++i)
+    {
+        inputs[i] = std::sin(float(i) * 0.37f);
+    }
+    for(size_t i = 0; i < nharm; ++i) { ins[i] = inputs.data() + i * vectorsize; }
+    for(size_t i = 0; i < nplws; ++i) { outs[i] = outputs.data() + i * vectorsize; }
+
+    std::printf("Sparse %zu harmonics, %zu planewaves, %zu samples:\n", nharm, nplws, vectorsize);
+    for(size_t percent : {5, 10, 25, 50, 75, 100})
+    {
+        // a deterministic pattern with the given ratio of non-null coefficients
+        for(size_t i = 0; i < matrix.size(); ++i)
+        {
+            matrix[i] = ((i * 2654435761u) % 100 < percent) ? std::cos(float(i)) : 0.f;
+        }
+        Signal<float>::pack(nharm, nplws, matrix.data(), packed.data());
+        SparseMatrix<float> sparse;
+        const float density = sparse.compress(nplws, nharm, matrix.data(), 0.f);
+
+        const size_t iterations = 2000;
+        const double tdense = hoa_benchmark(iterations, [&]()
+        {
+            Signal<float>::mul(nharm, nplws, vectorsize, packed.data(), ins.data(), outs.data());
+        });
+        const double tsparse = hoa_benchmark(iterations, [&]()
+        {
+            sparse.mul(vectorsize, ins.data(), outs.data());
+        });
+        std::printf("    density %.2f: dense %.2f us, sparse %.2f us (x%.2f)\n",
+                    density, tdense, tsparse, tdense / tsparse);
+    }
+}
+
+void hoa_benchmark_zones(const size_t order, const size_t nzones, const size_t nplws, const size_t vectorsize)
+{
+    DecoderZones<Hoa3d, float> zones(order, std::vector<size_t>(nzones, nplws), vectorsize);
+    DecoderRegular<Hoa3d, float> decoder(order, nplws);
+    decoder.prepare(vectorsize);
+    for(size_t i = 0; i < nzones; ++i)
+    {
+        zones.setDecoder(i, decoder);
+    }
+    const size_t nharm = decoder.getNumberOfHarmonics();
+
+    std::vector<float> inputs(nharm * vectorsize);
+    std::vector<float> outputs(nzones * nplws * vectorsize);
+    std::vector<const float*> ins(nharm);
+    std::vector<float*> outs(nzones * nplws);
+    for(size_t i = 0; i < inputs.size(); ++i)
+    {
+        inputs[i] = std::sin(float(i) * 0.37f);
+    }
+    for(size_t i = 0; i < nharm; ++i) { ins[i] = inputs.data() + i * vectorsize; }
+    for(size_t i = 0; i < outs.size(); ++i) { outs[i] = outputs.data() + i * vectorsize; }
+
+    auto separate = [&]()
+    {
+        for(size_t i = 0; i < nzones; ++i)
+        {
+            decoder.processBlock(ins.data(), outs.data() + i * nplws);
+        }
+    };
+    auto stacked = [&]() { zones.processBlock(ins.data(), outs.data()); };
+
+    const size_t iterations = 2000;
+    const double tseparate = hoa_benchmark(iterations, separate);
+    const double tstacked = hoa_benchmark(iterations, stacked);
+    std::printf("DecoderZones 3D order %zu, %zu zones of %zu planewaves, %zu samples: "
+                "separate %.2f us, stacked %.2f us (x%.2f)\n",
+                order, nzones, nplws, vectorsize, tseparate, tstacked, tseparate / tstacked);
+}
+
+void hoa_benchmark_lod(const size_t order, const size_t nplws, const size_t vectorsize)
+{
+    LevelOfDetail<Hoa3d, float> lod(order, nplws, vectorsize);
+    for(size_t i = 1; i <= order; ++i)
+    {
+        DecoderRegular<Hoa3d, float> decoder(i, nplws);
+        decoder.prepare(vectorsize);
+        lod.setDecoder(decoder);
+    }
+    const size_t nharm = lod.getNumberOfHarmonics();
+
+    std::vector<float> inputs(nharm * vectorsize);
+    std::vector<float> outputs(nplws * vectorsize);
+    std::vector<const float*> ins(nharm);
+    std::vector<float*> outs(nplws);
+    for(size_t i = 0; i < inputs.size(); ++i)
+    {
+        inputs[i] = std::sin(float(i) * 0.37f);
+    }
+    for(size_t i = 0; i < nharm; ++i) { ins[i] = inputs.data() + i * vectorsize; }
+    for(size_t i = 0; i < nplws; ++i) { outs[i] = outputs.data() + i * vectorsize; }
+
+    std::printf("LevelOfDetail 3D order %zu, %zu planewaves, %zu samples:", order, nplws, vectorsize);
+    for(size_t i = order; i > 0; --i)
+    {
+        lod.setOrder(i);
+        lod.processBlock(ins.data(), outs.data());
+        lod.processBlock(ins.data(), outs.data());
+        const double tblock = hoa_benchmark(2000, [&]() { lod.processBlock(ins.data(), outs.data()); });
+        std::printf(" order %zu %.2f us%s", i, tblock, i > 1 ? "," : "\n");
+    }
+}
+
+void hoa_benchmark_mixed(const size_t order, const size_t vertical, const size_t nplws, const size_t vectorsize)
+{
+    auto run = [&](const size_t vorder, double& tencode, double& tdecode)
+    {
+        Encoder<Hoa3d, float> encoder(order, vorder);
+        DecoderModeMatching<Hoa3d, float> decoder(order, nplws, vorder);
+        for(size_t i = 0; i < nplws; ++i)
+        {
+            decoder.setPlanewaveAzimuth(i, float(i) * 2.39996323f);
+            decoder.setPlanewaveElevation(i, std::asin(1.f - (2.f * float(i) + 1.f) / float(nplws)));
+        }
+        decoder.prepare(vectorsize);
+        const size_t nharm = decoder.getNumberOfHarmonics();
+
+        std::vector<float> harmonics(nharm);
+        std::vector<float> inputs(nharm * vectorsize);
+        std::vector<float> outputs(nplws * vectorsize);
+        std::vector<const float*> ins(nharm);
+        std::vector<float*> outs(nplws);
+        for(size_t i = 0; i < inputs.size(); ++i)
+        {
+            inputs[i] = std::sin(float(i) * 0.37f);
+        }
+        for(size_t i = 0; i < nharm; ++i) { ins[i] = inputs.data() + i * vectorsize; }
+        for(size_t i = 0; i < nplws; ++i) { outs[i] = outputs.data() + i * vectorsize; }
+
+        size_t step = 0;
+        const float input = 1.f;
+        tencode = hoa_benchmark(20000, [&]()
+        {
+            encoder.setAzimuth(float(++step) * 0.01f);
+            encoder.setElevation(float(step) * 0.003f);
+            encoder.process(&input, harmonics.data());
+        });
+        tdecode = hoa_benchmark(2000, [&]() { decoder.processBlock(ins.data(), outs.data()); });
+        return nharm;
+    };
+    double tfullencode, tfulldecode, tmixedencode, tmixeddecode;
+    const size_t nfull = run(order, tfullencode, tfulldecode);
+    const size_t nmixed = run(vertical, tmixedencode, tmixeddecode);
+    std::printf("Mixed order 3D %zuH%zuV, %zu planewaves, %zu samples: %zu/%zu harmonics, "
+                "encode %.3f/%.3f us, block decode %.2f/%.2f us (x%.2f)\n",
+                order, vertical, nplws, vectorsize, nmixed, nfull,
+                tmixedencode, tfullencode, tmixeddecode, tfulldecode, tfulldecode / tmixeddecode);
+}
+
+template <Dimension D, class HrirType>
+void hoa_benchmark_binaural(const char* name, const size_t order, const size_t vectorsize)
+{
+    using hrir_t = Hrir<D, HrirType>;
+    DecoderBinaural<D, float, HrirType> decoder(order);
+    decoder.prepare(vectorsize);
+    const size_t nharm = decoder.getNumberOfHarmonics();
+    const size_t ncols = hrir_t::getNumberOfColumns();
+    const size_t rsize = hrir_t::getNumberOfRows();
+
+    std::vector<float> inputs(nharm * vectorsize);
+    std::vector<float> outputs(2 * vectorsize);
+    std::vector<const float*> ins(nharm);
+    std::vector<float*> outs = {outputs.data(), outputs.data() + vectorsize};
+    for(size_t i = 0; i < inputs.size(); ++i)
+    {
+        inputs[i] = std::sin(float(i) * 0.37f);
+    }
+    for(size_t i = 0; i < nharm; ++i) { ins[i] = inputs.data() + i * vectorsize; }
+
+    // the time-domain convolution: a matrix product and an overlap-add by ear
+    std::vector<float> harmonics(ncols * vectorsize, 0.f);
+    std::vector<float> result(rsize * vectorsize);
+    std::vector<float> left(rsize + vectorsize, 0.f);
+    std::vector<float> right(rsize + vectorsize, 0.f);
+    auto channel = [&](const float* response, float* buffer, float* output)
+    {
+        Signal<float>::mul(rsize, vectorsize, ncols, response, harmonics.data(), result.data());
+        for(size_t i = 0; i < vectorsize; ++i)
+        {
+            Signal<float>::add(rsize, result.data() + i, vectorsize, buffer + i, 1ul);
+        }
+        Signal<float>::copy(vectorsize, buffer, output);
+        Signal<float>::copy(rsize, buffer + vectorsize, buffer);
+        Signal<float>::clear(vectorsize, buffer + rsize);
+    };
+    auto direct = [&]()
+    {
+        for(size_t i = 0; i < std::min(nharm, ncols); ++i)
+        {
+            Signal<float>::copy(vectorsize, ins[i], harmonics.data() + i * vectorsize);
+        }
+        channel(hrir_t::template getLeftMatrix<float>(), left.data(), outs[0]);
+        channel(hrir_t::template getRightMatrix<float>(), right.data(), outs[1]);
+    };
+
+    const size_t iterations = 200;
+    const double tdirect = hoa_benchmark(iterations, direct);
+    const double tfft = hoa_benchmark(iterations, [&]() { decoder.processBlock(ins.data(), outs.data()); });
+    std::printf("%s order %zu, %zu samples responses, %zu samples: time-domain %.2f us, partitioned fft %.2f us (x%.2f)\n",
+                name, order, rsize, vectorsize, tdirect, tfft, tdirect / tfft);
+}
+
+template <Dimension D, class HrirType>
+void hoa_benchmark_partitioning(const char* name, const size_t order, const size_t vectorsize)
+{
+    using hrir_t = Hrir<D, HrirType>;
+    using convolver_t = ConvolverNonUniform<float>;
+    DecoderBinaural<D, float, HrirType> decoder(order);
+    const size_t nharm = decoder.getNumberOfHarmonics();
+
+    std::vector<float> inputs(nharm * vectorsize);
+    std::vector<float> outputs(2 * vectorsize);
+    std::vector<const float*> ins(nharm);
+    std::vector<float*> outs = {outputs.data(), outputs.data() + vectorsize};
+    for(size_t i = 0; i < inputs.size(); ++i)
+    {
+        inputs[i] = std::sin(float(i) * 0.37f);
+    }
+    for(size_t i = 0; i < nharm; ++i) { ins[i] = inputs.data() + i * vectorsize; }
+
+    // the vectors are paced at 48 kHz: the background thread has the time of the vectors to
+    // convolve the tail, the time spent in the audio thread is measured for each vector
+    const size_t iterations = 4000;
+    const auto period = std::chrono::nanoseconds(size_t(1e9 * double(vectorsize) / 48000.));
+    auto run = [&](const convolver_t::Partitioning partitioning)
+    {
+        decoder.setPartitioning(partitioning);
+        decoder.prepare(vectorsize);
+        double tsum = 0.;
+        auto next = std::chrono::steady_clock::now();
+        for(size_t i = 0; i < iterations; ++i)
+        {
+            tsum += hoa_benchmark(1, [&]() { decoder.processBlock(ins.data(), outs.data()); });
+            next += period;
+            std::this_thread::sleep_until(next);
+        }
+        return tsum / double(iterations);
+    };
+    const double tuniform = run(convolver_t::Uniform);
+    const double tnonuniform = run(convolver_t::NonUniform);
+    std::printf("%s order %zu, %zu samples responses, %zu samples: uniform %.2f us, non-uniform %.2f us (x%.2f), latency %zu\n",
+                name, order, hrir_t::getNumberOfRows(), vectorsize, tuniform, tnonuniform, tuniform / tnonuniform, decoder.getLatency());
+}
+
+template <Dimension D, class HrirType>
+void hoa_benchmark_crop(const char* name, const size_t cropsize, const size_t vectorsize)
+{
+    using hrir_t = Hrir<D, HrirType>;
+    const size_t nharm = hrir_t::getNumberOfColumns();
+    ConvolverDirect<float> direct(nharm, 2);
+    Convolver<float> fft(nharm, 2);
+    for(size_t i = 0; i < nharm; ++i)
+    {
+        direct.setResponse(0, i, cropsize, hrir_t::template getLeftMatrix<float>() + i, nharm);
+        direct.setResponse(1, i, cropsize, hrir_t::template getRightMatrix<float>() + i, nharm);
+        fft.setResponse(0, i, cropsize, hrir_t::template getLeftMatrix<float>() + i, nharm);
+        fft.setResponse(1, i, cropsize, hrir_t::template getRightMatrix<float>() + i, nharm);
+    }
+    direct.prepare(vectorsize);
+    fft.prepare(vectorsize);
+
+    std::vector<float> inputs(nharm * vectorsize);
+    std::vector<float> outputs(2 * vectorsize);
+    std::vector<const float*> ins(nharm);
+    std::vector<float*> outs = {outputs.data(), outputs.data() + vectorsize};
+    for(size_t i = 0; i < inputs.size(); ++i)
+    {
+        inputs[i] = std::sin(float(i) * 0.37f);
+    }
+    for(size_t i = 0; i < nharm; ++i) { ins[i] = inputs.data() + i * vectorsize; }
+
+    const size_t iterations = 2000;
+    const double tdirect = hoa_benchmark(iterations, [&]() { direct.process(ins.data(), outs.data()); });
+    const double tfft = hoa_benchmark(iterations, [&]() { fft.process(ins.data(), outs.data()); });
+    std::printf("%s crop %zu, %zu samples: direct %.2f us, partitioned fft %.2f us (x%.2f, %s)\n",
+                name, cropsize, vectorsize, tdirect, tfft, tfft / tdirect,
+                ConvolverDirect<float>::isEfficient(cropsize, vectorsize) ? "direct" : "fft");
+}
+
+template <class HrirType>
+void hoa_benchmark_truncation(const char* name, const size_t order, const float threshold, const size_t vectorsize)
+{
+    using hrir_t = Hrir<Hoa3d, HrirType>;
+    DecoderBinaural<Hoa3d, float, HrirType> decoder(order);
+    const size_t nharm = decoder.getNumberOfHarmonics();
+    const size_t ncols = std::min(nharm, hrir_t::getNumberOfColumns());
+
+    std::vector<float> inputs(nharm * vectorsize);
+    std::vector<float> outputs(2 * vectorsize);
+    std::vector<const float*> ins(nharm);
+    std::vector<float*> outs = {outputs.data(), outputs.data() + vectorsize};
+    for(size_t i = 0; i < inputs.size(); ++i)
+    {
+        inputs[i] = std::sin(float(i) * 0.37f);
+    }
+    for(size_t i = 0; i < nharm; ++i) { ins[i] = inputs.data() + i * vectorsize; }
+
+    const size_t iterations = 2000;
+    decoder.prepare(vectorsize);
+    const double tfull = hoa_benchmark(iterations, [&]() { decoder.processBlock(ins.data(), outs.data()); });
+    decoder.setTruncation(threshold);
+    const double ttruncated = hoa_benchmark(iterations, [&]() { decoder.processBlock(ins.data(), outs.data()); });
+    size_t taps = 0;
+    for(size_t i = 0; i < ncols; ++i) { taps += decoder.getResponseSize(i); }
+    std::printf("%s order %zu, %zu samples, truncation %.0f dB: %zu/%zu taps, full %.2f us, truncated %.2f us (x%.2f)\n",
+                name, order, vectorsize, threshold, taps, ncols * hrir_t::getNumberOfRows(),
+                tfull, ttruncated, tfull / ttruncated);
+}
+
+template <class HrirType>
+void hoa_benchmark_head_tracking(const char* name, const size_t order, const size_t vectorsize)
+{
+    DecoderBinaural<Hoa3d, float, HrirType> decoder(order);
+    DecoderBinaural<Hoa3d, float, HrirType> tracked(order);
+    decoder.prepare(vectorsize);
+    tracked.prepare(vectorsize);
+    const size_t nharm = decoder.getNumberOfHarmonics();
+
+    std::vector<float> inputs(nharm * vectorsize);
+    std::vector<float> outputs(2 * vectorsize);
+    std::vector<const float*> ins(nharm);
+    std::vector<float*> outs = {outputs.data(), outputs.data() + vectorsize};
+    for(size_t i = 0; i < inputs.size(); ++i)
+    {
+        inputs[i] = std::sin(float(i) * 0.37f);
+    }
+    for(size_t i = 0; i < nharm; ++i) { ins[i] = inputs.data() + i * vectorsize; }
+
+    // a new orientation for each block
+    const size_t iterations = 2000;
+    size_t count = 0;
+    const double tfixed = hoa_benchmark(iterations, [&]() { decoder.processBlock(ins.data(), outs.data()); });
+    const double ttracked = hoa_benchmark(iterations, [&]()
+    {
+        const float angle = float(count++) * 0.01f;
+        tracked.setHeadOrientation(angle, angle * 0.3f, angle * 0.2f);
+        tracked.processBlock(ins.data(), outs.data());
+    });
+    std::printf("%s order %zu, %zu samples: fixed %.2f us, head tracking %.2f us (+%.0f%%), latency %zu samples\n",
+                name, order, vectorsize, tfixed, ttracked, (ttracked / tfixed - 1.) * 100., tracked.getHeadTrackingLatency());
+}
+
+template <class HrirType>
+void hoa_benchmark_batch(const char* name, const size_t order, const size_t nlisteners, const size_t nthreads, const size_t vectorsize)
+{
+    std::vector<std::unique_ptr<DecoderBinaural<Hoa3d, float, HrirType>>> decoders;
+    DecoderBinauralBatch<float, HrirType> batch(order, nlisteners, nthreads);
+    for(size_t l = 0; l < nlisteners; ++l)
+    {
+        decoders.emplace_back(new DecoderBinaural<Hoa3d, float, HrirType>(order));
+        decoders.back()->prepare(vectorsize);
+    }
+    batch.prepare(vectorsize);
+    const size_t nharm = batch.getNumberOfHarmonics();
+
+    std::vector<float> inputs(nharm * vectorsize);
+    std::vector<float> outputs(nlisteners * 2 * vectorsize);
+    std::vector<const float*> ins(nharm);
+    std::vector<float*> outs(nlisteners * 2);
+    for(size_t i = 0; i < inputs.size(); ++i)
+    {
+        inputs[i] = std::sin(float(i) * 0.37f);
+    }
+    for(size_t i = 0; i < nharm; ++i) { ins[i] = inputs.data() + i * vectorsize; }
+    for(size_t i = 0; i < nlisteners * 2; ++i) { outs[i] = outputs.data() + i * vectorsize; }
+
+    // a new orientation for each listener and each block
+    const size_t iterations = 200;
+    size_t count = 0;
+    const double tseparate = hoa_benchmark(iterations, [&]()
+    {
+        const float angle = float(count++) * 0.01f;
+        for(size_t l = 0; l < nlisteners; ++l)
+        {
+            decoders[l]->setHeadOrientation(angle + float(l), angle * 0.3f, angle * 0.2f);
+            decoders[l]->processBlock(ins.data(), outs.data() + l * 2);
+        }
+    });
+    count = 0;
+    const double tbatch = hoa_benchmark(iterations, [&]()
+    {
+        const float angle = float(count++) * 0.01f;
+        for(size_t l = 0; l < nlisteners; ++l)
+        {
+            batch.setHeadOrientation(l, angle + float(l), angle * 0.3f, angle * 0.2f);
+        }
+        batch.processBlock(ins.data(), outs.data());
+    });
+    std::printf("%s order %zu, %zu listeners, %zu threads, %zu samples: decoders %.2f us, batch %.2f us (x%.2f)\n",
+                name, order, nlisteners, nthreads, vectorsize, tseparate, tbatch, tseparate / tbatch);
+}
+
+int main()
+{
+    hoa_benchmark_regular<Hoa2d>("DecoderRegular 2D", 7, 16, 64);
+    hoa_benchmark_regular<Hoa2d>("DecoderRegular 2D", 15, 32, 256);
+    hoa_benchmark_regular<Hoa3d>("DecoderRegular 3D", 3, 24, 64);
+    hoa_benchmark_regular<Hoa3d>("DecoderRegular 3D", 7, 64, 64);
+    hoa_benchmark_regular<Hoa3d>("DecoderRegular 3D", 7, 64, 256);
+    hoa_benchmark_irregular_ring(7, 32);
+    hoa_benchmark_irregular_ring(7, 128);
+    hoa_benchmark_irregular(3);
+    hoa_benchmark_irregular(7);
+    hoa_benchmark_inversion<DecoderModeMatching<Hoa3d, float>>("DecoderModeMatching 3D", 7, 64);
+    hoa_benchmark_inversion<DecoderModeMatching<Hoa3d, float>>("DecoderModeMatching 3D", 15, 256);
+    hoa_benchmark_inversion<DecoderEnergyPreserving<Hoa3d, float>>("DecoderEnergyPreserving 3D", 7, 64);
+    hoa_benchmark_inversion<DecoderEnergyPreserving<Hoa3d, float>>("DecoderEnergyPreserving 3D", 15, 256);
+    hoa_benchmark_panner({{24, 0.f}, {16, 0.35f}, {12, 0.8f}, {7, 1.2f}, {1, 1.5707963f}}, 32, 64);
+    hoa_benchmark_panner({{64, 0.f}, {56, 0.3f}, {48, 0.6f}, {36, 0.9f}, {24, 1.2f}, {1, 1.5707963f}}, 32, 64);
+    hoa_benchmark_sparse(16, 256, 64);
+    hoa_benchmark_sparse(64, 256, 64);
+    hoa_benchmark_sparse(64, 512, 256);
+    hoa_benchmark_cache(15, 256);
+    hoa_benchmark_zones(3, 3, 24, 64);
+    hoa_benchmark_zones(7, 8, 64, 64);
+    hoa_benchmark_lod(7, 64, 64);
+    hoa_benchmark_mixed(7, 3, 64, 64);
+    hoa_benchmark_mixed(15, 5, 256, 64);
+    hoa_benchmark_binaural<Hoa2d, hrir::Sadie_D2_2D>("DecoderBinaural 2D", 7, 64);
+    hoa_benchmark_binaural<Hoa2d, hrir::Listen_1002C_2D>("DecoderBinaural 2D", 7, 512);
+    hoa_benchmark_binaural<Hoa3d, hrir::Sadie_D2_3D>("DecoderBinaural 3D", 7, 64);
+    hoa_benchmark_binaural<Hoa3d, hrir::Listen_1002C_3D>("DecoderBinaural 3D", 7, 512);
+    hoa_benchmark_partitioning<Hoa2d, hrir::Listen_1002C_2D>("DecoderBinaural 2D", 7, 32);
+    hoa_benchmark_partitioning<Hoa3d, hrir::Listen_1002C_3D>("DecoderBinaural 3D", 7, 32);
+    hoa_benchmark_partitioning<Hoa3d, hrir::Listen_1002C_3D>("DecoderBinaural 3D", 7, 16);
+    hoa_benchmark_partitioning<Hoa3d, hrir::Listen_1002C_3D>("DecoderBinaural 3D", 7, 8);
+    hoa_benchmark_crop<Hoa2d, hrir::Sadie_D2_2D>("DecoderBinaural 2D", 16, 16);
+    hoa_benchmark_crop<Hoa2d, hrir::Sadie_D2_2D>("DecoderBinaural 2D", 32, 16);
+    hoa_benchmark_crop<Hoa2d, hrir::Sadie_D2_2D>("DecoderBinaural 2D", 32, 64);
+    hoa_benchmark_crop<Hoa2d, hrir::Sadie_D2_2D>("DecoderBinaural 2D", 64, 64);
+    hoa_benchmark_crop<Hoa2d, hrir::Sadie_D2_2D>("DecoderBinaural 2D", 128, 64);
+    hoa_benchmark_crop<Hoa2d, hrir::Sadie_D2_2D>("DecoderBinaural 2D", 64, 256);
+    hoa_benchmark_crop<Hoa2d, hrir::Sadie_D2_2D>("DecoderBinaural 2D", 128, 256);
+    hoa_benchmark_truncation<hrir::Sadie_D2_3D>("DecoderBinaural 3D", 3, -40.f, 32);
+    hoa_benchmark_truncation<hrir::Sadie_D2_3D>("DecoderBinaural 3D", 3, -60.f, 16);
+    hoa_benchmark_truncation<hrir::Listen_1002C_3D>("DecoderBinaural 3D", 3, -40.f, 32);
+    hoa_benchmark_head_tracking<hrir::Sadie_D2_3D>("DecoderBinaural 3D", 3, 64);
+    hoa_benchmark_head_tracking<hrir::Listen_1002C_3D>("DecoderBinaural 3D", 3, 256);
+    hoa_benchmark_batch<hrir::Sadie_D2_3D>("DecoderBinauralBatch 3D", 3, 32, 1, 64);
+    hoa_benchmark_batch<hrir::Sadie_D2_3D>("DecoderBinauralBatch 3D", 3, 32, 4, 64);
+    hoa_benchmark_batch<hrir::Listen_1002C_3D>("DecoderBinauralBatch 3D", 3, 32, 1, 256);
+    return 0;
+}
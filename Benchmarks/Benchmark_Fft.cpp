@@ -0,0 +1,81 @@
+/*
+// Copyright (c) 2015 Pierre Guillot.
+// For information on usage and redistribution, and for a DISCLAIMER OF ALL
+// WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+*/
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+#include <Hoa.hpp>
+using namespace hoa;
+
+template <typename Function>
+double hoa_benchmark(const size_t iterations, Function function)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < iterations; ++i)
+    {
+        function();
+    }
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / double(iterations);
+}
+
+// the naive DFT of a real signal with precomputed cosines and sines
+void hoa_dft(const size_t size, const float* input, const float* cosines, const float* sines, float* real, float* imag)
+{
+    for(size_t k = 0; k <= size / 2; ++k)
+    {
+        float re = 0.f, im = 0.f;
+        for(size_t i = 0, index = 0; i < size; ++i, index = (index + k) & (size - 1))
+        {
+            re += input[i] * cosines[index];
+            im -= input[i] * sines[index];
+        }
+        real[k] = re;
+        imag[k] = im;
+    }
+}
+
+void hoa_benchmark_fft(const size_t size)
+{
+    Fft<float> fft(size);
+    std::vector<float> signal(size);
+    std::vector<float> result(size);
+    std::vector<float> real(size / 2 + 1);
+    std::vector<float> imag(size / 2 + 1);
+    for(size_t i = 0; i < size; ++i) { signal[i] = std::sin(float(i) * 0.37f); }
+
+    const size_t iterations = std::max(size_t(20), size_t(4000000) / size);
+    const double tforward = hoa_benchmark(iterations, [&]() { fft.forward(signal.data(), real.data(), imag.data()); });
+    const double tinverse = hoa_benchmark(iterations, [&]() { fft.inverse(real.data(), imag.data(), result.data()); });
+    const double flops = 2.5 * double(size) * std::log2(double(size));
+    std::printf("Fft %6zu: forward %9.2f us, inverse %9.2f us, %.2f GFlops", size, tforward, tinverse, flops / tforward * 1e-3);
+
+    if(size <= 4096)
+    {
+        std::vector<float> cosines(size), sines(size);
+        for(size_t i = 0; i < size; ++i)
+        {
+            cosines[i] = float(std::cos(HOA_2PI * double(i) / double(size)));
+            sines[i] = float(std::sin(HOA_2PI * double(i) / double(size)));
+        }
+        const double tdft = hoa_benchmark(std::max(size_t(2), size_t(200000) / size), [&]()
+        {
+            hoa_dft(size, signal.data(), cosines.data(), sines.data(), real.data(), imag.data());
+        });
+        std::printf(", naive DFT %10.2f us (x%.0f)", tdft, tdft / tforward);
+    }
+    std::printf("\n");
+}
+
+int main()
+{
+    for(size_t size = 32; size <= 65536; size *= 2)
+    {
+        hoa_benchmark_fft(size);
+    }
+    return 0;
+}
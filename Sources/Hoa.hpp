@@ -15,9 +15,22 @@
 #include "Hoa_Planewaves.hpp"
 #include "Hoa_Encoder.hpp"
 #include "Hoa_MultiEncoder.hpp"
+#include "Hoa_VoiceManager.hpp"
+#include "Hoa_ClusterEncoder.hpp"
 #include "Hoa_Optim.hpp"
 #include "Hoa_Rotate.hpp"
+#include "Hoa_Panner.hpp"
+#include "Hoa_Fft.hpp"
+#include "Hoa_Convolver.hpp"
 #include "Hoa_Decoder.hpp"
+#include "Hoa_DecoderCrossfader.hpp"
+#include "Hoa_DecoderZones.hpp"
+#include "Hoa_DecoderCache.hpp"
+#include "Hoa_DecoderBinauralBatch.hpp"
+#include "Hoa_LevelOfDetail.hpp"
+#include "Hoa_Alignment.hpp"
 #include "Hoa_Vector.hpp"
 #include "Hoa_Wider.hpp"
 #include "Hoa_Exchanger.hpp"
+#include "Hoa_Converter.hpp"
+#include "Hoa_Chain.hpp"
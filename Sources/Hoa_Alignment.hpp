@@ -0,0 +1,250 @@
+/*
+// Copyright (c) 2012-2017 CICM - Universite Paris 8 - Labex Arts H2H.
+// Authors :
+// 2012: Pierre Guillot, Eliott Paris & Julien Colafrancesco.
+// 2012-2015: Pierre Guillot & Eliott Paris.
+// 2015: Pierre Guillot & Eliott Paris & Thomas Le Meur (Light version)
+// 2016-2017: Pierre Guillot.
+// For information on usage and redistribution, and for a DISCLAIMER OF ALL
+// WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+*/
+
+#pragma once
+
+#include "Hoa_Processor.hpp"
+
+#include <limits>
+
+namespace hoa
+{
+    // ================================================================================ //
+    // ALIGNMENT //
+    // ================================================================================ //
+
+    //! @brief The class compensates the distances of the loudspeakers.
+    //! @details The decoders suppose that all the loudspeakers are at the same distance of
+    //! the listener. The alignment delays and attenuates the signals of the closest
+    //! loudspeakers so the wave fronts of all the loudspeakers reach the center at the same
+    //! time with the same level. For a loudspeaker at the distance \f$d_{i}\f$ with the
+    //! farthest loudspeaker at the distance \f$d_{max}\f$, the delay and the gain are:
+    //! \f[\tau_{i} = \frac{d_{max} - d_{i}}{c} \quad g_{i} = \frac{d_{i}}{d_{max}} \times t_{i}\f]
+    //! with \f$c\f$ the speed of sound and \f$t_{i}\f$ the gain trim of the loudspeaker.<br>
+    //! The fractional part of the delay uses a linear interpolation. Each loudspeaker owns a
+    //! ring buffer with a power of two size allocated by the constructor, so the process
+    //! methods don't allocate memory. The block processing can be performed in place on the
+    //! outputs of a decoder, the loudspeakers without delay are only scaled but their ring
+    //! buffers are still written, so a delay set later reads the last samples. Changing the
+    //! distances while processing can generate discontinuities.
+    template <Dimension D, typename T>
+    class Alignment
+    : public ProcessorPlanewaves<D, T>
+    {
+    public:
+
+        //! @brief Constructor.
+        //! @param nplws The number of loudspeakers.
+        //! @param samplerate The sample rate.
+        //! @param maxdelay The maximum delay in seconds.
+        //! @param vectorsize The vector size of the block processing.
+        Alignment(const size_t nplws, const T samplerate, const T maxdelay = T(0.1), const size_t vectorsize = 64)
+        : ProcessorPlanewaves<D, T>(nplws)
+        , m_sample_rate(samplerate)
+        , m_vector_size(vectorsize)
+        , m_max_delay(std::max(maxdelay * samplerate, T(0)))
+        , m_channels(nplws)
+        {
+            size_t size = 1;
+            while(size < size_t(std::ceil(m_max_delay)) + vectorsize + 2)
+            {
+                size <<= 1;
+            }
+            m_mask = size - 1;
+            m_buffers.resize(nplws * size);
+            update();
+        }
+
+        //! @brief Destructor.
+        ~Alignment() = default;
+
+        //! @brief Returns the sample rate.
+        inline T getSampleRate() const noexcept { return m_sample_rate; }
+
+        //! @brief Returns the vector size of the block processing.
+        inline size_t getVectorSize() const noexcept { return m_vector_size; }
+
+        //! @brief Returns the maximum delay in samples.
+        inline T getMaximumDelay() const noexcept { return m_max_delay; }
+
+        //! @brief Sets the speed of sound.
+        //! @param speed The speed of sound in meters per second (default 343).
+        void setSpeedOfSound(const T speed) noexcept
+        {
+            m_speed = speed;
+            update();
+        }
+
+        //! @brief Returns the speed of sound.
+        inline T getSpeedOfSound() const noexcept { return m_speed; }
+
+        //! @brief Sets the distance of a loudspeaker.
+        //! @param index The index of the loudspeaker.
+        //! @param distance The distance in meters (must be strictly positive, default is 1).
+        void setDistance(const size_t index, const T distance) noexcept
+        {
+            m_channels[index].distance = std::max(distance, std::numeric_limits<T>::epsilon());
+            update();
+        }
+
+        //! @brief Sets the distances of all the loudspeakers.
+        //! @param distances The distances in meters.
+        void setDistances(const T* distances) noexcept
+        {
+            for(size_t i = 0; i < m_channels.size(); ++i)
+            {
+                m_channels[i].distance = std::max(distances[i], std::numeric_limits<T>::epsilon());
+            }
+            update();
+        }
+
+        //! @brief Returns the distance of a loudspeaker.
+        inline T getDistance(const size_t index) const noexcept { return m_channels[index].distance; }
+
+        //! @brief Sets the gain trim of a loudspeaker.
+        //! @param index The index of the loudspeaker.
+        //! @param gain The linear gain (default is 1).
+        void setGain(const size_t index, const T gain) noexcept
+        {
+            m_channels[index].trim = gain;
+            update();
+        }
+
+        //! @brief Returns the gain trim of a loudspeaker.
+        inline T getGain(const size_t index) const noexcept { return m_channels[index].trim; }
+
+        //! @brief Returns the delay applied to a loudspeaker in samples.
+        inline T getDelay(const size_t index) const noexcept { return m_channels[index].delay; }
+
+        //! @brief Returns the whole gain applied to a loudspeaker.
+        inline T getCompensation(const size_t index) const noexcept { return m_channels[index].gain; }
+
+        //! @brief Clears the ring buffers.
+        void clear() noexcept
+        {
+            Signal<T>::clear(m_buffers.size(), m_buffers.data());
+        }
+
+        //! @brief The method performs the alignment of a sample of the loudspeakers.
+        //! @details The method can be used for in-place or not-in-place processing.
+        //! @param inputs  The inputs array.
+        //! @param outputs The outputs array.
+        void process(const T* inputs, T* outputs) noexcept override
+        {
+            const size_t size = m_mask + 1;
+            for(size_t i = 0; i < m_channels.size(); ++i)
+            {
+                Channel const& channel = m_channels[i];
+                T* buffer = m_buffers.data() + i * size;
+                buffer[m_position] = inputs[i];
+                outputs[i] = buffer[(m_position - channel.integer) & m_mask] * channel.current
+                + buffer[(m_position - channel.integer - 1) & m_mask] * channel.next;
+            }
+            m_position = (m_position + 1) & m_mask;
+        }
+
+        //! @brief The method performs the alignment of a block of the loudspeakers.
+        //! @details The method can be used for in-place processing, directly on the outputs
+        //! of a decoder.
+        //! @param inputs  The inputs channels.
+        //! @param outputs The outputs channels.
+        void processBlock(const T** inputs, T** outputs) noexcept
+        {
+            const size_t size  = m_mask + 1;
+            const size_t vsize = m_vector_size;
+            for(size_t i = 0; i < m_channels.size(); ++i)
+            {
+                Channel const& channel = m_channels[i];
+                const T* input = inputs[i];
+                T* output = outputs[i];
+                T* buffer = m_buffers.data() + i * size;
+                const size_t start = m_position;
+                const size_t first = std::min(vsize, size - start);
+                Signal<T>::copy(first, input, buffer + start);
+                Signal<T>::copy(vsize - first, input + first, buffer);
+                if(!channel.integer && channel.next == T(0))
+                {
+                    const T gain = channel.current;
+                    for(size_t j = 0; j < vsize; ++j)
+                    {
+                        output[j] = input[j] * gain;
+                    }
+                    continue;
+                }
+
+                const T current = channel.current;
+                const T next    = channel.next;
+                size_t read = (start - channel.integer - 1) & m_mask;
+                size_t j = 0;
+                while(j < vsize)
+                {
+                    // the contiguous part of the ring before the wrap
+                    const size_t count = std::min(vsize - j, size - 1 - read);
+                    const T* delayed = buffer + read;
+                    for(size_t k = 0; k < count; ++k)
+                    {
+                        output[j + k] = delayed[k + 1] * current + delayed[k] * next;
+                    }
+                    j += count;
+                    read = (read + count) & m_mask;
+                    if(j < vsize)
+                    {
+                        output[j] = buffer[0] * current + buffer[m_mask] * next;
+                        ++j;
+                        read = 0;
+                    }
+                }
+            }
+            m_position = (m_position + vsize) & m_mask;
+        }
+
+    private:
+
+        struct Channel
+        {
+            T       distance = T(1);
+            T       trim     = T(1);
+            T       delay    = T(0);
+            T       gain     = T(1);
+            size_t  integer  = 0ul;
+            T       current  = T(1);
+            T       next     = T(0);
+        };
+
+        //! @brief Computes the delays and the gains of the loudspeakers.
+        void update() noexcept
+        {
+            T farthest = T(0);
+            for(auto const& channel : m_channels)
+            {
+                farthest = std::max(farthest, channel.distance);
+            }
+            for(auto& channel : m_channels)
+            {
+                channel.delay   = std::min((farthest - channel.distance) / m_speed * m_sample_rate, m_max_delay);
+                channel.gain    = channel.distance / farthest * channel.trim;
+                channel.integer = size_t(channel.delay);
+                const T fraction = channel.delay - T(channel.integer);
+                channel.current = (T(1) - fraction) * channel.gain;
+                channel.next    = fraction * channel.gain;
+            }
+        }
+
+        const T                 m_sample_rate;
+        const size_t            m_vector_size;
+        const T                 m_max_delay;
+        T                       m_speed = T(343);
+        std::vector<Channel>    m_channels;
+        std::vector<T>          m_buffers {};
+        size_t                  m_mask = 0ul;
+        size_t                  m_position = 0ul;
+    };
+}
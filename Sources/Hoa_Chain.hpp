@@ -0,0 +1,203 @@
+/*
+// Copyright (c) 2012-2017 CICM - Universite Paris 8 - Labex Arts H2H.
+// Authors :
+// 2012: Pierre Guillot, Eliott Paris & Julien Colafrancesco.
+// 2012-2015: Pierre Guillot & Eliott Paris.
+// 2015: Pierre Guillot & Eliott Paris & Thomas Le Meur (Light version)
+// 2016-2017: Pierre Guillot.
+// For information on usage and redistribution, and for a DISCLAIMER OF ALL
+// WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+*/
+
+#pragma once
+
+#include "Hoa_DecoderCrossfader.hpp"
+
+namespace hoa
+{
+    // ================================================================================ //
+    // CHAIN //
+    // ================================================================================ //
+
+    //! @brief The class fuses a chain of linear processors into a single matrix.
+    //! @details The optimization, the widening, the rotation, the renumbering and the
+    //! normalization of the harmonics and the decoding are linear maps without memory,
+    //! applying them one after another costs a pass over the harmonics for each stage. The
+    //! chain computes the matrix of the whole sequence once and decodes with a single
+    //! matrix product.<br>
+    //! The matrix is compiled lazily by the update() method, that processes each harmonic
+    //! basis vector through the stages and the decoder only if the chain changed since the
+    //! last compilation. Adding or removing the stages and setting the decoder mark the chain
+    //! as changed, the parameters of the stages aren't observed so invalidate() must be
+    //! called after changing them. The update() method can then be called periodically from
+    //! a control thread: the new matrix is only published when it differs from the previous
+    //! one, and the audio thread crossfades to it without allocation nor lock (see
+    //! DecoderCrossfader). The stages are not owned by the chain and must not be processed
+    //! concurrently with the update.
+    //! The stages with a memory like the binaural decoders can't be fused.
+    template <Dimension D, typename T>
+    class Chain
+    : public ProcessorHarmonics<D, T>
+    {
+    public:
+
+        //! @brief Constructor.
+        //! @param order The order.
+        //! @param nplws The number of outputs of the decoder.
+        //! @param vectorsize The vector size of the block processing.
+        Chain(const size_t order, const size_t nplws, const size_t vectorsize = 64)
+        : ProcessorHarmonics<D, T>(order)
+        , m_crossfader(order, nplws, vectorsize)
+        , m_matrix(nplws * ProcessorHarmonics<D, T>::getNumberOfHarmonics())
+        , m_compiled(nplws * ProcessorHarmonics<D, T>::getNumberOfHarmonics())
+        , m_input(ProcessorHarmonics<D, T>::getNumberOfHarmonics())
+        , m_output(ProcessorHarmonics<D, T>::getNumberOfHarmonics())
+        , m_planewaves(nplws)
+        {
+            ;
+        }
+
+        //! @brief Destructor.
+        ~Chain() = default;
+
+        //! @brief Returns the number of outputs of the decoder.
+        inline size_t getNumberOfPlanewaves() const noexcept { return m_crossfader.getNumberOfPlanewaves(); }
+
+        //! @brief Appends a stage in the harmonics domain.
+        //! @details The stage must be linear without memory. A stage that doesn't have the
+        //! number of harmonics of the chain or that has a mixed order is rejected.
+        //! @param stage The processor.
+        //! @return true if the stage has been appended, otherwise false.
+        bool addStage(ProcessorHarmonics<D, T>& stage)
+        {
+            if(stage.getNumberOfHarmonics() != ProcessorHarmonics<D, T>::getNumberOfHarmonics()
+               || stage.isMixedOrder())
+            {
+                return false;
+            }
+            m_stages.push_back(&stage);
+            m_dirty = true;
+            return true;
+        }
+
+        //! @brief Removes all the stages in the harmonics domain.
+        void clearStages()
+        {
+            m_stages.clear();
+            m_dirty = true;
+        }
+
+        //! @brief Returns the number of stages in the harmonics domain.
+        inline size_t getNumberOfStages() const noexcept { return m_stages.size(); }
+
+        //! @brief Sets the decoder at the end of the chain.
+        //! @details The decoder must have the order and the number of outputs of the chain,
+        //! otherwise it is rejected. Without decoder, the chain outputs the harmonics and the
+        //! number of outputs must be the number of harmonics.
+        //! @param decoder The decoder.
+        //! @return true if the decoder has been set, otherwise false.
+        bool setDecoder(Decoder<D, T>& decoder)
+        {
+            if(decoder.getNumberOfHarmonics() != ProcessorHarmonics<D, T>::getNumberOfHarmonics()
+               || decoder.getNumberOfPlanewaves() != getNumberOfPlanewaves())
+            {
+                return false;
+            }
+            m_decoder = &decoder;
+            m_dirty = true;
+            return true;
+        }
+
+        //! @brief Notifies the chain that the parameters of a stage or of the decoder changed.
+        //! @details The matrix is compiled again by the next call to update().
+        inline void invalidate() noexcept { m_dirty = true; }
+
+        //! @brief Sets the number of samples of the crossfade between two matrices.
+        //! @param nsamples The number of samples.
+        inline void setFadeLength(const size_t nsamples) noexcept { m_crossfader.setFadeLength(nsamples); }
+
+        //! @brief Returns the number of samples of the crossfade between two matrices.
+        inline size_t getFadeLength() const noexcept { return m_crossfader.getFadeLength(); }
+
+        //! @brief Compiles the chain if it changed.
+        //! @details The method computes the matrix of the chain and publishes it to the audio
+        //! thread if it differs from the previous one. It must be called from the control
+        //! thread. Without decoder, the chain isn't compiled if the number of outputs isn't
+        //! the number of harmonics.
+        //! @return true if a new matrix has been published, otherwise false.
+        bool update() noexcept
+        {
+            const size_t nharm = ProcessorHarmonics<D, T>::getNumberOfHarmonics();
+            const size_t nplws = getNumberOfPlanewaves();
+            if(!m_dirty || (!m_decoder && nplws != nharm))
+            {
+                return false;
+            }
+            m_dirty = false;
+            for(size_t i = 0; i < nharm; ++i)
+            {
+                Signal<T>::clear(nharm, m_input.data());
+                m_input[i] = T(1);
+                const T* result = m_input.data();
+                for(auto* stage : m_stages)
+                {
+                    stage->process(result, m_output.data());
+                    std::swap(m_input, m_output);
+                    result = m_input.data();
+                }
+                if(m_decoder)
+                {
+                    m_decoder->process(result, m_planewaves.data());
+                    result = m_planewaves.data();
+                }
+                Signal<T>::copy(nplws, result, 1ul, m_compiled.data() + i, nharm);
+            }
+
+            if(m_valid && std::equal(m_compiled.begin(), m_compiled.end(), m_matrix.begin()))
+            {
+                return false;
+            }
+            std::swap(m_matrix, m_compiled);
+            m_crossfader.publish(getMatrix());
+            m_valid = true;
+            return true;
+        }
+
+        //! @brief Returns the last compiled matrix.
+        //! @details The matrix is stored row by row with a row for each output and a column
+        //! for each harmonic. The method must be called from the control thread.
+        inline const T* getMatrix() const noexcept { return m_matrix.data(); }
+
+        //! @brief The method performs the whole chain on a sample.
+        //! @details The method must be called from the audio thread.
+        //! @param inputs  The inputs array that contains the samples of the harmonics.
+        //! @param outputs The outputs array.
+        inline void process(const T* inputs, T* outputs) noexcept override
+        {
+            m_crossfader.process(inputs, outputs);
+        }
+
+        //! @brief The method performs the whole chain on a block of samples.
+        //! @details The method must be called from the audio thread, the outputs must not
+        //! share memory with the inputs.
+        //! @param inputs  The inputs channels.
+        //! @param outputs The outputs channels.
+        inline void processBlock(const T** inputs, T** outputs) noexcept
+        {
+            m_crossfader.processBlock(inputs, outputs);
+        }
+
+    private:
+
+        DecoderCrossfader<D, T>                 m_crossfader;
+        std::vector<ProcessorHarmonics<D, T>*>  m_stages {};
+        Decoder<D, T>*                          m_decoder = nullptr;
+        std::vector<T>                          m_matrix;
+        std::vector<T>                          m_compiled;
+        std::vector<T>                          m_input;
+        std::vector<T>                          m_output;
+        std::vector<T>                          m_planewaves;
+        bool                                    m_valid = false;
+        bool                                    m_dirty = true;
+    };
+}
@@ -0,0 +1,346 @@
+/*
+// Copyright (c) 2012-2017 CICM - Universite Paris 8 - Labex Arts H2H.
+// Authors :
+// 2012: Pierre Guillot, Eliott Paris & Julien Colafrancesco.
+// 2012-2015: Pierre Guillot & Eliott Paris.
+// 2015: Pierre Guillot & Eliott Paris & Thomas Le Meur (Light version)
+// 2016-2017: Pierre Guillot.
+// For information on usage and redistribution, and for a DISCLAIMER OF ALL
+// WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+*/
+
+#pragma once
+
+#include "Hoa_MultiEncoder.hpp"
+
+namespace hoa
+{
+    // ================================================================================ //
+    // CLUSTER ENCODER //
+    // ================================================================================ //
+
+    //! @brief The class encodes a large set of sources by groups of close sources.
+    //! @details The cluster encoder groups the sources of a multi encoder by angular
+    //! proximity into \f$K\f$ clusters using an incremental spherical k-means: each update
+    //! starts from the previous centroids and performs a few assignment and centroid
+    //! iterations. The signals of the sources of a cluster are summed and encoded once in the
+    //! direction of the centroid, thus the cost of the encoding depends on the number of
+    //! clusters and not on the number of sources. The sources that are farther than the
+    //! maximum angular error from the centroid of their cluster are encoded individually.<br>
+    //! The distance gain of the sources beyond the unit circle or sphere is applied to the
+    //! signals before the sum and the radius of a cluster is the mean of the radii of its
+    //! sources inside the unit circle or sphere.<br>
+    //! The clustering is performed by the update() method that should be called once per
+    //! block of samples while the process() method is called for each sample.
+    template <Dimension D, typename T>
+    class ClusterEncoder
+    : public MultiEncoder<D, T>
+    {
+    public:
+
+        //! @brief Constructor.
+        //! @param order The order.
+        //! @param nsources The number of sources.
+        //! @param nclusters The number of clusters.
+        ClusterEncoder(size_t order, size_t nsources, size_t nclusters)
+        : MultiEncoder<D, T>(order, nsources)
+        , m_sources(nsources)
+        , m_clusters(std::max(nclusters, size_t(1)))
+        , m_signals(std::max(nclusters, size_t(1)))
+        {
+            m_clustered.reserve(nsources);
+            m_individuals.reserve(nsources);
+            m_cluster_encoders.reserve(m_clusters.size());
+            for(size_t i = 0; i < m_clusters.size(); ++i)
+            {
+                m_cluster_encoders.emplace_back(order);
+            }
+            update();
+        }
+
+        //! @brief Destructor.
+        ~ClusterEncoder() = default;
+
+        //! @brief Returns the number of clusters.
+        inline size_t getNumberOfClusters() const noexcept { return m_clusters.size(); }
+
+        //! @brief Sets the maximum angular error between a source and its cluster.
+        //! @details Beyond this angle in radian, a source is encoded individually.
+        //! @param error The maximum angular error in radian.
+        inline void setMaximumError(const T error) noexcept
+        {
+            m_maximum_error = std::max(std::min(error, math<T>::pi()), T(0));
+            m_minimum_dot = (m_maximum_error < math<T>::pi()) ? std::cos(m_maximum_error) : T(-2);
+        }
+
+        //! @brief Returns the maximum angular error between a source and its cluster.
+        inline T getMaximumError() const noexcept { return m_maximum_error; }
+
+        //! @brief Sets the number of iterations of the k-means performed at each update.
+        //! @param niterations The number of iterations (minimum 1).
+        inline void setNumberOfIterations(const size_t niterations) noexcept
+        {
+            m_iterations = std::max(niterations, size_t(1));
+        }
+
+        //! @brief Returns the number of iterations of the k-means performed at each update.
+        inline size_t getNumberOfIterations() const noexcept { return m_iterations; }
+
+        //! @brief Returns true if a source is encoded with its cluster.
+        //! @param index The index of the source.
+        inline bool isClustered(const size_t index) const noexcept { return m_sources[index].clustered; }
+
+        //! @brief Returns the cluster of a source.
+        //! @param index The index of the source.
+        inline size_t getCluster(const size_t index) const noexcept { return m_sources[index].cluster; }
+
+        //! @brief Returns the number of sources of a cluster.
+        //! @param index The index of the cluster.
+        inline size_t getClusterSize(const size_t index) const noexcept { return m_clusters[index].size; }
+
+        //! @brief Returns the azimuth of the centroid of a cluster.
+        //! @param index The index of the cluster.
+        inline T getClusterAzimuth(const size_t index) const noexcept { return m_cluster_encoders[index].getAzimuth(); }
+
+        //! @brief Returns the elevation of the centroid of a cluster.
+        //! @param index The index of the cluster.
+        inline T getClusterElevation(const size_t index) const noexcept { return m_cluster_encoders[index].getElevation(); }
+
+        //! @brief Returns the radius of a cluster.
+        //! @param index The index of the cluster.
+        inline T getClusterRadius(const size_t index) const noexcept { return m_cluster_encoders[index].getRadius(); }
+
+        //! @brief Returns the number of sources encoded individually.
+        inline size_t getNumberOfIndividualSources() const noexcept { return m_individuals.size(); }
+
+        //! @brief Groups the sources into the clusters.
+        //! @details The method should be called once per block, it reads the positions of the
+        //! sources, refines the clusters and updates the coordinates of the cluster encoders.
+        //! The method doesn't allocate memory.
+        void update() noexcept
+        {
+            const size_t nsources   = MultiEncoder<D, T>::getNumberOfSources();
+            const size_t nclusters  = m_clusters.size();
+
+            m_clustered.clear();
+            for(size_t i = 0; i < nsources; ++i)
+            {
+                Point& source = m_sources[i];
+                source.clustered = false;
+                if(!MultiEncoder<D, T>::getMute(i))
+                {
+                    const T azimuth   = MultiEncoder<D, T>::getAzimuth(i);
+                    const T elevation = (D == Hoa2d) ? T(0) : MultiEncoder<D, T>::getElevation(i);
+                    const T radius    = MultiEncoder<D, T>::getRadius(i);
+                    if(azimuth != source.azimuth || elevation != source.elevation)
+                    {
+                        source.x = std::cos(azimuth + math<T>::pi_over_two()) * std::cos(elevation);
+                        source.y = std::sin(azimuth + math<T>::pi_over_two()) * std::cos(elevation);
+                        source.z = std::sin(elevation);
+                        source.azimuth = azimuth;
+                        source.elevation = elevation;
+                    }
+                    source.radius = std::min(radius, T(1));
+                    source.gain = radius > T(1) ? T(1) / radius : T(1);
+                    m_clustered.push_back(i);
+                }
+            }
+
+            if(!m_initialized && !m_clustered.empty())
+            {
+                for(size_t k = 0; k < nclusters; ++k)
+                {
+                    Point const& source = m_sources[m_clustered[(k * m_clustered.size()) / nclusters]];
+                    m_clusters[k].x = source.x;
+                    m_clusters[k].y = source.y;
+                    m_clusters[k].z = source.z;
+                }
+                m_initialized = true;
+            }
+
+            for(size_t it = 0; it < m_iterations; ++it)
+            {
+                assign();
+                for(auto& cluster : m_clusters)
+                {
+                    cluster.x = cluster.y = cluster.z = cluster.radius = T(0);
+                }
+                for(auto index : m_clustered)
+                {
+                    Point const& source = m_sources[index];
+                    Point& cluster = m_clusters[source.cluster];
+                    cluster.x += source.x;
+                    cluster.y += source.y;
+                    cluster.z += source.z;
+                    cluster.radius += source.radius;
+                }
+                for(auto& cluster : m_clusters)
+                {
+                    if(cluster.size)
+                    {
+                        normalize(cluster);
+                        cluster.radius /= T(cluster.size);
+                    }
+                    else
+                    {
+                        reseed(cluster);
+                    }
+                }
+            }
+            assign();
+
+            m_individuals.clear();
+            size_t nclustered = 0;
+            for(auto index : m_clustered)
+            {
+                Point& source = m_sources[index];
+                if(source.dot >= m_minimum_dot)
+                {
+                    source.clustered = true;
+                    m_clustered[nclustered++] = index;
+                }
+                else
+                {
+                    --m_clusters[source.cluster].size;
+                    m_individuals.push_back(index);
+                }
+            }
+            m_clustered.resize(nclustered);
+
+            for(size_t k = 0; k < nclusters; ++k)
+            {
+                Point const& cluster = m_clusters[k];
+                if(cluster.size)
+                {
+                    const T azimuth = (cluster.x == T(0) && cluster.y == T(0)) ? T(0) : std::atan2(cluster.y, cluster.x) - math<T>::pi_over_two();
+                    const T elevation = std::asin(std::max(std::min(cluster.z, T(1)), T(-1)));
+                    if(m_cluster_encoders[k].getAzimuth() != math<T>::wrap_two_pi(azimuth)) { m_cluster_encoders[k].setAzimuth(azimuth); }
+                    if(m_cluster_encoders[k].getElevation() != elevation) { m_cluster_encoders[k].setElevation(elevation); }
+                    if(m_cluster_encoders[k].getRadius() != cluster.radius) { m_cluster_encoders[k].setRadius(cluster.radius); }
+                }
+            }
+        }
+
+        //! @brief The method performs the encoding of the harmonics signal.
+        //! @details The inputs array contains the samples of the sources to encode and the
+        //! outputs array contains the spherical harmonics samples thus the minimum size of
+        //! the array must be the number of sources and the number of harmonics.
+        //! @param input   The inputs array.
+        //! @param outputs The outputs array.
+        void process(const T* input, T* outputs) noexcept override
+        {
+            const size_t nharmos    = MultiEncoder<D, T>::getNumberOfHarmonics();
+            const size_t nclusters  = m_clusters.size();
+            T* temp                 = MultiEncoder<D, T>::m_temp;
+            T* signals              = m_signals.data();
+
+            Signal<T>::clear(nclusters, signals);
+            for(auto index : m_clustered)
+            {
+                Point const& source = m_sources[index];
+                signals[source.cluster] += input[index] * source.gain;
+            }
+
+            Signal<T>::clear(nharmos, outputs);
+            for(size_t k = 0; k < nclusters; ++k)
+            {
+                if(m_clusters[k].size)
+                {
+                    m_cluster_encoders[k].process(signals+k, temp);
+                    MultiEncoder<D, T>::sigadd(nharmos, temp, outputs);
+                }
+            }
+            for(auto index : m_individuals)
+            {
+                MultiEncoder<D, T>::m_encoders[index].encoder->process(input+index, temp);
+                MultiEncoder<D, T>::sigadd(nharmos, temp, outputs);
+            }
+        }
+
+    private:
+
+        struct Point
+        {
+            T x = T(0);
+            T y = T(1);
+            T z = T(0);
+            T azimuth = T(0);
+            T elevation = T(0);
+            T radius = T(1);
+            T gain = T(1);
+            T dot = T(1);
+            size_t cluster = 0ul;
+            size_t size = 0ul;
+            bool clustered = false;
+        };
+
+        //! @brief Assigns each source to the nearest centroid.
+        void assign() noexcept
+        {
+            for(auto& cluster : m_clusters)
+            {
+                cluster.size = 0;
+            }
+            for(auto index : m_clustered)
+            {
+                Point& source = m_sources[index];
+                T best = T(-2);
+                for(size_t k = 0; k < m_clusters.size(); ++k)
+                {
+                    Point const& cluster = m_clusters[k];
+                    const T dot = source.x * cluster.x + source.y * cluster.y + source.z * cluster.z;
+                    if(dot > best)
+                    {
+                        best = dot;
+                        source.cluster = k;
+                    }
+                }
+                source.dot = best;
+                ++m_clusters[source.cluster].size;
+            }
+        }
+
+        //! @brief Moves an empty cluster to the source with the largest error.
+        void reseed(Point& cluster) noexcept
+        {
+            Point* worst = nullptr;
+            for(auto index : m_clustered)
+            {
+                Point& source = m_sources[index];
+                if(m_clusters[source.cluster].size > 1 && (!worst || source.dot < worst->dot))
+                {
+                    worst = &source;
+                }
+            }
+            if(worst)
+            {
+                cluster.x = worst->x;
+                cluster.y = worst->y;
+                cluster.z = worst->z;
+                cluster.radius = worst->radius;
+                worst->dot = T(1);
+            }
+        }
+
+        static inline void normalize(Point& point) noexcept
+        {
+            const T length = std::sqrt(point.x * point.x + point.y * point.y + point.z * point.z);
+            if(length > T(HOA_EPSILON))
+            {
+                point.x /= length; point.y /= length; point.z /= length;
+            }
+        }
+
+        T       m_maximum_error = math<T>::pi();
+        T       m_minimum_dot = T(-2);
+        size_t  m_iterations = 2ul;
+        bool    m_initialized = false;
+
+        std::vector<Point>          m_sources {};
+        std::vector<Point>          m_clusters {};
+        std::vector<T>              m_signals {};
+        std::vector<size_t>         m_clustered {};
+        std::vector<size_t>         m_individuals {};
+        std::vector<Encoder<D, T>>  m_cluster_encoders {};
+    };
+}
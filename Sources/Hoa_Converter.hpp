@@ -0,0 +1,189 @@
+/*
+// Copyright (c) 2012-2017 CICM - Universite Paris 8 - Labex Arts H2H.
+// Authors :
+// 2012: Pierre Guillot, Eliott Paris & Julien Colafrancesco.
+// 2012-2015: Pierre Guillot & Eliott Paris.
+// 2015: Pierre Guillot & Eliott Paris & Thomas Le Meur (Light version)
+// 2016-2017: Pierre Guillot.
+// For information on usage and redistribution, and for a DISCLAIMER OF ALL
+// WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+*/
+
+#pragma once
+
+#include "Hoa_Encoder.hpp"
+
+namespace hoa
+{
+    // ================================================================================ //
+    // CONVERTER //
+    // ================================================================================ //
+
+    //! @brief The class converts the harmonics between the dimensions and the orders.
+    //! @details The class allows the 2D and the 3D processors to share the same harmonics
+    //! and to truncate or to extend the order of decomposition:
+    //! - From 2D to 3D, the circular harmonics feed the sectoral spherical harmonics
+    //! \f$Y_{l,\pm l}\f$ and the other harmonics are set to zero.
+    //! - From 3D to 2D, the sectoral spherical harmonics are projected to the circular
+    //! harmonics and the other harmonics are ignored.
+    //! - In the same dimension, the harmonics of the lower degrees are copied and the
+    //! harmonics of the upper degrees are ignored (truncation) or set to zero (extension).
+    //! The circular harmonics and the sectoral spherical harmonics have the same azimuth
+    //! part but not the same normalization, the gain of a degree is the ratio of the values
+    //! of the harmonics of the two dimensions for a plane wave in the horizontal plane:
+    //! \f[g_{l} = \frac{Y^{3d}_{l,l}(0, 0)}{Y^{2d}_{l,l}(0)}\f]
+    //! so a plane wave encoded in the horizontal plane in one dimension is converted to the
+    //! same plane wave in the sectoral harmonics of the other dimension.<br>
+    //! The conversion is precomputed in a table that gathers and scales the inputs for each
+    //! output, the process methods don't allocate memory. The mixed orders of the 3D
+    //! harmonics are supported.
+    template <Dimension From, Dimension To, typename T>
+    class Converter
+    {
+    public:
+
+        //! @brief Constructor.
+        //! @param inorder The order of the inputs.
+        //! @param outorder The order of the outputs.
+        //! @param vectorsize The vector size of the block processing.
+        Converter(const size_t inorder, const size_t outorder, const size_t vectorsize = 64)
+        : Converter(inorder, inorder, outorder, outorder, vectorsize)
+        {
+            ;
+        }
+
+        //! @brief Constructor for mixed orders.
+        //! @param inorder The order of the inputs.
+        //! @param invertical The vertical order of the inputs (ignored in 2D).
+        //! @param outorder The order of the outputs.
+        //! @param outvertical The vertical order of the outputs (ignored in 2D).
+        //! @param vectorsize The vector size of the block processing.
+        Converter(const size_t inorder, const size_t invertical,
+                  const size_t outorder, const size_t outvertical, const size_t vectorsize = 64)
+        : m_vector_size(vectorsize)
+        {
+            const ProcessorHarmonics<From, T> inputs(inorder, invertical);
+            const ProcessorHarmonics<To, T> outputs(outorder, outvertical);
+            m_number_of_inputs  = inputs.getNumberOfHarmonics();
+            m_number_of_outputs = outputs.getNumberOfHarmonics();
+            for(size_t i = 0; i < m_number_of_outputs; ++i)
+            {
+                const size_t degree = outputs.getHarmonicDegree(i);
+                const long order    = outputs.getHarmonicOrder(i);
+                const size_t index  = (From == To || size_t(std::abs(order)) == degree)
+                ? inputs.getHarmonicIndex(degree, order) : m_number_of_inputs;
+                if(degree <= inorder && index < m_number_of_inputs)
+                {
+                    Entry entry;
+                    entry.input  = index;
+                    entry.output = i;
+                    entry.gain   = (From == To) ? T(1) : getSectoralValue(To, degree, order) / getSectoralValue(From, degree, order);
+                    m_entries.push_back(entry);
+                }
+                else
+                {
+                    m_zeros.push_back(i);
+                }
+            }
+        }
+
+        //! @brief Destructor.
+        ~Converter() = default;
+
+        //! @brief Returns the number of input harmonics.
+        inline size_t getNumberOfInputs() const noexcept { return m_number_of_inputs; }
+
+        //! @brief Returns the number of output harmonics.
+        inline size_t getNumberOfOutputs() const noexcept { return m_number_of_outputs; }
+
+        //! @brief Returns the vector size of the block processing.
+        inline size_t getVectorSize() const noexcept { return m_vector_size; }
+
+        //! @brief Returns the gain of an output harmonic (0 if it isn't fed by an input).
+        T getGain(const size_t index) const noexcept
+        {
+            for(auto const& entry : m_entries)
+            {
+                if(entry.output == index) { return entry.gain; }
+            }
+            return T(0);
+        }
+
+        //! @brief The method converts a sample of the harmonics.
+        //! @details The outputs must not share memory with the inputs.
+        //! @param inputs  The inputs array.
+        //! @param outputs The outputs array.
+        void process(const T* inputs, T* outputs) const noexcept
+        {
+            for(auto const& entry : m_entries)
+            {
+                outputs[entry.output] = inputs[entry.input] * entry.gain;
+            }
+            for(auto index : m_zeros)
+            {
+                outputs[index] = T(0);
+            }
+        }
+
+        //! @brief The method converts a block of the harmonics.
+        //! @details The outputs must not share memory with the inputs.
+        //! @param inputs  The inputs channels.
+        //! @param outputs The outputs channels.
+        void processBlock(const T** inputs, T** outputs) const noexcept
+        {
+            const size_t vsize = m_vector_size;
+            for(auto const& entry : m_entries)
+            {
+                if(entry.gain == T(1))
+                {
+                    Signal<T>::copy(vsize, inputs[entry.input], outputs[entry.output]);
+                }
+                else
+                {
+                    const T* input = inputs[entry.input];
+                    T* output = outputs[entry.output];
+                    const T gain = entry.gain;
+                    for(size_t j = 0; j < vsize; ++j)
+                    {
+                        output[j] = input[j] * gain;
+                    }
+                }
+            }
+            for(auto index : m_zeros)
+            {
+                Signal<T>::clear(vsize, outputs[index]);
+            }
+        }
+
+    private:
+
+        struct Entry
+        {
+            size_t  input;
+            size_t  output;
+            T       gain;
+        };
+
+        //! @brief Returns the value of a sectoral harmonic for a plane wave in the horizontal plane.
+        //! @details The azimuth is chosen so the azimuth part of the harmonic is 1.
+        static T getSectoralValue(const Dimension dimension, const size_t degree, const long order) noexcept
+        {
+            if(dimension == Hoa2d || degree == 0)
+            {
+                return T(1);
+            }
+            const T azimuth = order < 0 ? T(HOA_PI2) / T(degree) : T(0);
+            const T elevation = T(0);
+            std::vector<T> harmonics(Harmonic<Hoa3d, T>::getNumberOfHarmonics(degree));
+            Encoder<Hoa3d, T> encoder(degree);
+            encoder.processDirections(1, &azimuth, &elevation, harmonics.data());
+            return harmonics[size_t(Harmonic<Hoa3d, T>::getIndex(degree, order))];
+        }
+
+        const size_t        m_vector_size;
+        size_t              m_number_of_inputs = 0ul;
+        size_t              m_number_of_outputs = 0ul;
+        std::vector<Entry>  m_entries {};
+        std::vector<size_t> m_zeros {};
+    };
+}
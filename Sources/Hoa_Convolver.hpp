@@ -0,0 +1,763 @@
+/*
+// Copyright (c) 2012-2017 CICM - Universite Paris 8 - Labex Arts H2H.
+// Authors :
+// 2012: Pierre Guillot, Eliott Paris & Julien Colafrancesco.
+// 2012-2015: Pierre Guillot & Eliott Paris.
+// 2015: Pierre Guillot & Eliott Paris & Thomas Le Meur (Light version)
+// 2016-2017: Pierre Guillot.
+// For information on usage and redistribution, and for a DISCLAIMER OF ALL
+// WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+*/
+
+#pragma once
+
+#include "Hoa_Fft.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace hoa
+{
+    // ================================================================================ //
+    // CONVOLVER //
+    // ================================================================================ //
+
+    //! @brief The class convolves several inputs with a matrix of impulse responses.
+    //! @details Each output is the sum of the inputs convolved with their responses:
+    //! \f[y_{o} = \sum_{i} h_{o,i} * x_{i}\f]
+    //! The convolution uses a uniformly partitioned overlap-save scheme: the responses are
+    //! cut in partitions of the size of the vector \f$P\f$ and the spectra of the partitions
+    //! are computed once by the prepare method with a transform of size \f$K \geq 2P\f$.
+    //! For each vector, the last \f$K\f$ samples of each input are transformed once and
+    //! stored in a frequency-domain delay line, then the products of the delayed spectra of
+    //! the inputs and the spectra of the partitions are accumulated in the frequency domain
+    //! so a single inverse transform is performed by output:
+    //! \f[Y_{o} = \sum_{i}\sum_{j} X_{i}^{(b-j)} H_{o,i}^{(j)}\f]
+    //! The \f$P\f$ last samples of the inverse transform are the outputs, the convolution
+    //! has no latency. The cost grows with the logarithm of the size of the vector and
+    //! with the number of partitions instead of the size of the responses.
+    template <typename T>
+    class Convolver
+    {
+    public:
+
+        //! @brief Constructor.
+        //! @param ninputs  The number of inputs.
+        //! @param noutputs The number of outputs.
+        Convolver(const size_t ninputs, const size_t noutputs)
+        : m_number_of_inputs(ninputs)
+        , m_number_of_outputs(noutputs)
+        , m_responses(ninputs * noutputs)
+        {
+            ;
+        }
+
+        //! @brief Destructor.
+        ~Convolver() = default;
+
+        //! @brief Returns the number of inputs.
+        inline size_t getNumberOfInputs() const noexcept { return m_number_of_inputs; }
+
+        //! @brief Returns the number of outputs.
+        inline size_t getNumberOfOutputs() const noexcept { return m_number_of_outputs; }
+
+        //! @brief Returns the vector size.
+        inline size_t getVectorSize() const noexcept { return m_vector_size; }
+
+        //! @brief Returns the size of the transforms.
+        inline size_t getFftSize() const noexcept { return m_fft.getSize(); }
+
+        //! @brief Returns the number of partitions of the responses.
+        inline size_t getNumberOfPartitions() const noexcept { return m_number_of_partitions; }
+
+        //! @brief Returns the size of the longest response.
+        size_t getResponseSize() const noexcept
+        {
+            size_t size = 0ul;
+            for(auto const& response : m_responses) { size = std::max(size, response.size()); }
+            return size;
+        }
+
+        //! @brief Sets the response between an input and an output.
+        //! @details The response is copied, the spectra are computed by the next call to
+        //! the prepare method. A response of size 0 removes the response.
+        //! @param output   The index of the output.
+        //! @param input    The index of the input.
+        //! @param size     The size of the response.
+        //! @param response The response.
+        //! @param stride   The increment between two samples of the response.
+        void setResponse(const size_t output, const size_t input,
+                         const size_t size, const T* response, const size_t stride = 1ul)
+        {
+            assert(output < m_number_of_outputs && input < m_number_of_inputs);
+            std::vector<T>& dest = m_responses[output * m_number_of_inputs + input];
+            dest.resize(size);
+            for(size_t i = 0; i < size; ++i)
+            {
+                dest[i] = response[i * stride];
+            }
+            m_dirty = true;
+        }
+
+        //! @brief Computes the spectra of the responses and clears the delay lines.
+        //! @details The spectra are only computed when the responses or the vector size
+        //! changed since the last call.
+        //! @param vectorsize The vector size.
+        void prepare(const size_t vectorsize)
+        {
+            assert(vectorsize > 0);
+            if(m_dirty || vectorsize != m_vector_size)
+            {
+                const size_t vsize = vectorsize;
+                m_vector_size = vsize;
+                m_fft = Fft<T>(Fft<T>::getPowerOfTwo(vsize * 2));
+                const size_t fsize = m_fft.getSize();
+                const size_t nbins = m_fft.getNumberOfBins();
+                const size_t nparts = std::max((getResponseSize() + vsize - 1) / vsize, size_t(1));
+                m_number_of_partitions = nparts;
+
+                // only the partitions of the responses are stored
+                const size_t nresponses = m_number_of_inputs * m_number_of_outputs;
+                m_offsets.resize(nresponses);
+                size_t nfilters = 0ul;
+                for(size_t r = 0; r < nresponses; ++r)
+                {
+                    m_offsets[r] = nfilters;
+                    nfilters += (m_responses[r].size() + vsize - 1) / vsize;
+                }
+                m_filters_real.assign(nfilters * nbins, T(0));
+                m_filters_imag.assign(nfilters * nbins, T(0));
+                std::vector<T> partition(fsize);
+                for(size_t r = 0; r < nresponses; ++r)
+                {
+                    std::vector<T> const& response = m_responses[r];
+                    for(size_t j = 0; j * vsize < response.size(); ++j)
+                    {
+                        std::fill(partition.begin(), partition.end(), T(0));
+                        const size_t offset = j * vsize;
+                        std::copy(response.begin() + offset,
+                                  response.begin() + std::min(offset + vsize, response.size()),
+                                  partition.begin());
+                        const size_t index = (m_offsets[r] + j) * nbins;
+                        m_fft.forward(partition.data(), m_filters_real.data() + index, m_filters_imag.data() + index);
+                    }
+                }
+
+                m_windows.resize(m_number_of_inputs * fsize);
+                m_spectra_real.resize(m_number_of_inputs * nparts * nbins);
+                m_spectra_imag.resize(m_number_of_inputs * nparts * nbins);
+                m_accumulator_real.resize(nbins);
+                m_accumulator_imag.resize(nbins);
+                m_output.resize(fsize);
+                m_dirty = false;
+            }
+            clear();
+        }
+
+        //! @brief Clears the delay lines.
+        void clear() noexcept
+        {
+            std::fill(m_windows.begin(), m_windows.end(), T(0));
+            std::fill(m_spectra_real.begin(), m_spectra_real.end(), T(0));
+            std::fill(m_spectra_imag.begin(), m_spectra_imag.end(), T(0));
+            m_position = 0ul;
+        }
+
+        //! @brief Convolves a vector of the inputs.
+        //! @details The inputs are read before the outputs are written, so the outputs can
+        //! share memory with the inputs.
+        //! @param inputs  The inputs channels.
+        //! @param outputs The outputs channels.
+        void process(const T** inputs, T** outputs) noexcept
+        {
+            const size_t vsize = m_vector_size;
+            if(!vsize) { return; }
+            const size_t fsize = m_fft.getSize();
+            const size_t nbins = m_fft.getNumberOfBins();
+            const size_t nparts = m_number_of_partitions;
+            const size_t nins = m_number_of_inputs;
+
+            for(size_t i = 0; i < nins; ++i)
+            {
+                T* window = m_windows.data() + i * fsize;
+                std::copy(window + vsize, window + fsize, window);
+                Signal<T>::copy(vsize, inputs[i], window + fsize - vsize);
+                const size_t index = (i * nparts + m_position) * nbins;
+                m_fft.forward(window, m_spectra_real.data() + index, m_spectra_imag.data() + index);
+            }
+
+            T* accr = m_accumulator_real.data();
+            T* acci = m_accumulator_imag.data();
+            for(size_t o = 0; o < m_number_of_outputs; ++o)
+            {
+                Signal<T>::clear(nbins, accr);
+                Signal<T>::clear(nbins, acci);
+                for(size_t i = 0; i < nins; ++i)
+                {
+                    const size_t r = o * nins + i;
+                    const size_t rsize = m_responses[r].size();
+                    for(size_t j = 0; j * vsize < rsize; ++j)
+                    {
+                        const size_t slot = (m_position + nparts - j) % nparts;
+                        const T* xr = m_spectra_real.data() + (i * nparts + slot) * nbins;
+                        const T* xi = m_spectra_imag.data() + (i * nparts + slot) * nbins;
+                        const T* hr = m_filters_real.data() + (m_offsets[r] + j) * nbins;
+                        const T* hi = m_filters_imag.data() + (m_offsets[r] + j) * nbins;
+                        for(size_t k = 0; k < nbins; ++k)
+                        {
+                            accr[k] += xr[k] * hr[k] - xi[k] * hi[k];
+                            acci[k] += xr[k] * hi[k] + xi[k] * hr[k];
+                        }
+                    }
+                }
+                m_fft.inverse(accr, acci, m_output.data());
+                Signal<T>::copy(vsize, m_output.data() + fsize - vsize, outputs[o]);
+            }
+
+            m_position = (m_position + 1) % nparts;
+        }
+
+    private:
+
+        const size_t    m_number_of_inputs;
+        const size_t    m_number_of_outputs;
+        size_t          m_vector_size = 0ul;
+        size_t          m_number_of_partitions = 0ul;
+        size_t          m_position = 0ul;
+        bool            m_dirty = true;
+        Fft<T>          m_fft {};
+        std::vector<std::vector<T>> m_responses {};
+        std::vector<size_t> m_offsets {};
+        std::vector<T>  m_filters_real {};
+        std::vector<T>  m_filters_imag {};
+        std::vector<T>  m_windows {};
+        std::vector<T>  m_spectra_real {};
+        std::vector<T>  m_spectra_imag {};
+        std::vector<T>  m_accumulator_real {};
+        std::vector<T>  m_accumulator_imag {};
+        std::vector<T>  m_output {};
+    };
+
+    // ================================================================================ //
+    // CONVOLVER DIRECT //
+    // ================================================================================ //
+
+    //! @brief The class convolves several inputs with a matrix of short impulse responses
+    //! in the time domain.
+    //! @details For short responses (a few dozen of samples), the transforms cost more than
+    //! the direct convolution. The responses are stored reversed so an output sample is the
+    //! dot product of a response and a contiguous segment of the history of an input:
+    //! \f[y_{o}[n] = \sum_{i}\sum_{k} \overleftarrow{h}_{o,i}[k]x_{i}[n-L+1+k]\f]
+    //! The outputs are computed by groups of 32 samples (then 8 samples): the accumulators
+    //! of a group stay in the registers while the taps of all the inputs are applied and
+    //! each tap multiplies contiguous samples of the history, so the inner loop is
+    //! vectorized by the compiler. The history of an input keeps the \f$L-1\f$ last samples
+    //! before the current vector, the convolution has no latency.
+    template <typename T>
+    class ConvolverDirect
+    {
+    public:
+
+        //! @brief Constructor.
+        //! @param ninputs  The number of inputs.
+        //! @param noutputs The number of outputs.
+        ConvolverDirect(const size_t ninputs, const size_t noutputs)
+        : m_number_of_inputs(ninputs)
+        , m_number_of_outputs(noutputs)
+        , m_taps(ninputs * noutputs)
+        {
+            ;
+        }
+
+        //! @brief Destructor.
+        ~ConvolverDirect() = default;
+
+        //! @brief Returns the number of inputs.
+        inline size_t getNumberOfInputs() const noexcept { return m_number_of_inputs; }
+
+        //! @brief Returns the number of outputs.
+        inline size_t getNumberOfOutputs() const noexcept { return m_number_of_outputs; }
+
+        //! @brief Returns the vector size.
+        inline size_t getVectorSize() const noexcept { return m_vector_size; }
+
+        //! @brief Returns the size of the longest response.
+        size_t getResponseSize() const noexcept
+        {
+            size_t size = 0ul;
+            for(auto const& taps : m_taps) { size = std::max(size, taps.size()); }
+            return size;
+        }
+
+        //! @brief Returns if the direct convolution is faster than the partitioned convolution.
+        //! @details The thresholds are measured with the binaural responses: the groups of
+        //! 32 samples are faster up to 80 taps, the groups of 8 samples up to 24 taps.
+        //! @param size       The size of the responses.
+        //! @param vectorsize The vector size.
+        static inline bool isEfficient(const size_t size, const size_t vectorsize) noexcept
+        {
+            return size <= (vectorsize >= 32 ? 80ul : 24ul);
+        }
+
+        //! @brief Sets the response between an input and an output.
+        //! @details The response is copied reversed. A response of size 0 removes the response.
+        //! @param output   The index of the output.
+        //! @param input    The index of the input.
+        //! @param size     The size of the response.
+        //! @param response The response.
+        //! @param stride   The increment between two samples of the response.
+        void setResponse(const size_t output, const size_t input,
+                         const size_t size, const T* response, const size_t stride = 1ul)
+        {
+            assert(output < m_number_of_outputs && input < m_number_of_inputs);
+            std::vector<T>& taps = m_taps[output * m_number_of_inputs + input];
+            taps.resize(size);
+            for(size_t i = 0; i < size; ++i)
+            {
+                taps[size - 1 - i] = response[i * stride];
+            }
+        }
+
+        //! @brief Allocates the histories of the inputs and clears them.
+        //! @param vectorsize The vector size.
+        void prepare(const size_t vectorsize)
+        {
+            m_vector_size = vectorsize;
+            m_history_size = std::max(getResponseSize(), size_t(1)) - 1;
+            m_histories.resize(m_number_of_inputs * (m_history_size + vectorsize));
+            clear();
+        }
+
+        //! @brief Clears the histories of the inputs.
+        void clear() noexcept
+        {
+            std::fill(m_histories.begin(), m_histories.end(), T(0));
+        }
+
+        //! @brief Convolves a vector of the inputs.
+        //! @details The inputs are read before the outputs are written, so the outputs can
+        //! share memory with the inputs.
+        //! @param inputs  The inputs channels.
+        //! @param outputs The outputs channels.
+        void process(const T** inputs, T** outputs) noexcept
+        {
+            const size_t vsize = m_vector_size;
+            const size_t hsize = m_history_size;
+            const size_t stride = hsize + vsize;
+            const size_t nins = m_number_of_inputs;
+            if(!vsize) { return; }
+
+            for(size_t i = 0; i < nins; ++i)
+            {
+                Signal<T>::copy(vsize, inputs[i], m_histories.data() + i * stride + hsize);
+            }
+
+            for(size_t o = 0; o < m_number_of_outputs; ++o)
+            {
+                // the groups of 32 samples, then of 8 samples, then the last samples
+                size_t n = convolve<32>(o, 0ul, outputs[o]);
+                n = convolve<8>(o, n, outputs[o]);
+                convolve<1>(o, n, outputs[o]);
+            }
+
+            for(size_t i = 0; i < nins; ++i)
+            {
+                T* history = m_histories.data() + i * stride;
+                std::copy(history + vsize, history + stride, history);
+            }
+        }
+
+    private:
+
+        //! @brief Computes the groups of G samples of an output from a sample.
+        //! @return The index of the first sample that isn't computed.
+        template <size_t G>
+        size_t convolve(const size_t output, size_t n, T* result) const noexcept
+        {
+            const size_t vsize = m_vector_size;
+            const size_t hsize = m_history_size;
+            const size_t stride = hsize + vsize;
+            const size_t nins = m_number_of_inputs;
+            for(; n + G <= vsize; n += G)
+            {
+                T acc[G] = {};
+                for(size_t i = 0; i < nins; ++i)
+                {
+                    std::vector<T> const& taps = m_taps[output * nins + i];
+                    const size_t size = taps.size();
+                    const T* h = taps.data();
+                    const T* x = m_histories.data() + i * stride + (hsize + 1 - size) + n;
+                    for(size_t k = 0; k < size; ++k)
+                    {
+                        const T g = h[k];
+                        for(size_t j = 0; j < G; ++j)
+                        {
+                            acc[j] += g * x[k + j];
+                        }
+                    }
+                }
+                for(size_t j = 0; j < G; ++j)
+                {
+                    result[n + j] = acc[j];
+                }
+            }
+            return n;
+        }
+
+        const size_t                m_number_of_inputs;
+        const size_t                m_number_of_outputs;
+        size_t                      m_vector_size = 0ul;
+        size_t                      m_history_size = 0ul;
+        std::vector<std::vector<T>> m_taps {};
+        std::vector<T>              m_histories {};
+    };
+
+    // ================================================================================ //
+    // CONVOLVER NON UNIFORM //
+    // ================================================================================ //
+
+    //! @brief The class convolves several inputs with a matrix of impulse responses with
+    //! partitions of increasing sizes.
+    //! @details With small vectors, the uniform partitions are inefficient because the
+    //! number of partitions grows with the size of the responses. The responses are cut in
+    //! levels, each level is convolved by a Convolver with its own partition size:
+    //! - The head level has partitions of the size of the vector \f$P\f$ and covers the
+    //! samples \f$[0, 2B_{1}[\f$ of the responses.
+    //! - The level \f$l\f$ has partitions of size \f$B_{l} = 4^{l}P\f$ and covers the
+    //! samples \f$[2B_{l}, 2B_{l+1}[\f$ of the responses (until the end for the last one).
+    //!
+    //! The inputs of a level are gathered in blocks of \f$B_{l}\f$ samples, when a block
+    //! is complete it is handed to a background thread. The outputs of the block start at
+    //! the offset \f$2B_{l}\f$ of the level so they are only needed \f$B_{l}\f$ samples
+    //! later: this is the deadline of the background thread. If the block isn't convolved
+    //! at the deadline, the audio thread waits for it, so the outputs are always complete
+    //! and the convolution has no latency beyond the vector. The inputs and the outputs of
+    //! the levels are double-buffered so the audio thread and the background thread never
+    //! share a buffer.<br>
+    //! With the uniform partitioning, there is a single level and no background thread.
+    template <typename T>
+    class ConvolverNonUniform
+    {
+    public:
+
+        //! @brief The partitioning of the responses.
+        enum Partitioning
+        {
+            Uniform = 0,    //!< The partitions have the size of the vector.
+            NonUniform = 1  //!< The partitions grow with the offset in the responses.
+        };
+
+        //! @brief Constructor.
+        //! @param ninputs  The number of inputs.
+        //! @param noutputs The number of outputs.
+        ConvolverNonUniform(const size_t ninputs, const size_t noutputs)
+        : m_number_of_inputs(ninputs)
+        , m_number_of_outputs(noutputs)
+        , m_responses(ninputs * noutputs)
+        {
+            ;
+        }
+
+        //! @brief Destructor.
+        ~ConvolverNonUniform()
+        {
+            stop();
+        }
+
+        //! @brief Returns the number of inputs.
+        inline size_t getNumberOfInputs() const noexcept { return m_number_of_inputs; }
+
+        //! @brief Returns the number of outputs.
+        inline size_t getNumberOfOutputs() const noexcept { return m_number_of_outputs; }
+
+        //! @brief Returns the vector size.
+        inline size_t getVectorSize() const noexcept { return m_vector_size; }
+
+        //! @brief Returns the latency of the convolution beyond the vector (always 0).
+        inline size_t getLatency() const noexcept { return 0ul; }
+
+        //! @brief Sets the partitioning of the responses.
+        //! @details The partitioning is applied by the next call to the prepare method.
+        inline void setPartitioning(const Partitioning partitioning) noexcept
+        {
+            m_partitioning = partitioning;
+        }
+
+        //! @brief Returns the partitioning of the responses.
+        inline Partitioning getPartitioning() const noexcept { return m_partitioning; }
+
+        //! @brief Returns the number of levels of partitions.
+        inline size_t getNumberOfLevels() const noexcept { return m_levels.size(); }
+
+        //! @brief Returns the partition size of a level.
+        inline size_t getPartitionSize(const size_t level) const noexcept
+        {
+            return m_levels[level]->size;
+        }
+
+        //! @brief Returns the offset of a level in the responses.
+        inline size_t getPartitionOffset(const size_t level) const noexcept
+        {
+            return m_levels[level]->offset;
+        }
+
+        //! @brief Returns the size of the longest response.
+        size_t getResponseSize() const noexcept
+        {
+            size_t size = 0ul;
+            for(auto const& response : m_responses) { size = std::max(size, response.size()); }
+            return size;
+        }
+
+        //! @brief Sets the response between an input and an output.
+        //! @details The response is copied, the levels are computed by the next call to
+        //! the prepare method. A response of size 0 removes the response.
+        //! @param output   The index of the output.
+        //! @param input    The index of the input.
+        //! @param size     The size of the response.
+        //! @param response The response.
+        //! @param stride   The increment between two samples of the response.
+        void setResponse(const size_t output, const size_t input,
+                         const size_t size, const T* response, const size_t stride = 1ul)
+        {
+            assert(output < m_number_of_outputs && input < m_number_of_inputs);
+            std::vector<T>& dest = m_responses[output * m_number_of_inputs + input];
+            dest.resize(size);
+            for(size_t i = 0; i < size; ++i)
+            {
+                dest[i] = response[i * stride];
+            }
+        }
+
+        //! @brief Computes the levels and the spectra of the responses and clears the delay lines.
+        //! @details The method must not be called while processing.
+        //! @param vectorsize The vector size.
+        void prepare(const size_t vectorsize)
+        {
+            assert(vectorsize > 0);
+            stop();
+            m_vector_size = vectorsize;
+
+            // the sizes and the offsets of the levels
+            const size_t total = getResponseSize();
+            std::vector<std::pair<size_t, size_t>> layout = {{vectorsize, 0ul}};
+            if(m_partitioning == NonUniform)
+            {
+                for(size_t size = vectorsize * ratio(); size * 2 < total; size *= ratio())
+                {
+                    layout.push_back({size, size * 2});
+                }
+            }
+
+            m_levels.clear();
+            for(size_t l = 0; l < layout.size(); ++l)
+            {
+                const size_t size = layout[l].first;
+                const size_t offset = layout[l].second;
+                const size_t end = (l + 1 < layout.size()) ? layout[l + 1].second : total;
+                m_levels.emplace_back(new Level(m_number_of_inputs, m_number_of_outputs, size, offset));
+                Level& level = *m_levels.back();
+                for(size_t o = 0; o < m_number_of_outputs; ++o)
+                {
+                    for(size_t i = 0; i < m_number_of_inputs; ++i)
+                    {
+                        std::vector<T> const& response = m_responses[o * m_number_of_inputs + i];
+                        const size_t rsize = std::min(response.size(), end);
+                        level.convolver.setResponse(o, i, (rsize > offset) ? rsize - offset : 0ul,
+                                                    response.data() + std::min(offset, response.size()));
+                    }
+                }
+                level.convolver.prepare(size);
+            }
+
+            if(m_levels.size() > 1)
+            {
+                m_running = true;
+                m_thread = std::thread(&ConvolverNonUniform::run, this);
+            }
+        }
+
+        //! @brief Clears the delay lines.
+        //! @details The method must not be called while processing.
+        void clear()
+        {
+            for(auto& level : m_levels)
+            {
+                wait(*level);
+                level->convolver.clear();
+                std::fill(level->inputs.begin(), level->inputs.end(), T(0));
+                std::fill(level->outputs.begin(), level->outputs.end(), T(0));
+                level->position = 0ul;
+                level->chunk = 0ul;
+                level->requested = 0ul;
+                level->completed = 0ul;
+            }
+        }
+
+        //! @brief Convolves a vector of the inputs.
+        //! @details The inputs are read before the outputs are written, so the outputs can
+        //! share memory with the inputs.
+        //! @param inputs  The inputs channels.
+        //! @param outputs The outputs channels.
+        void process(const T** inputs, T** outputs) noexcept
+        {
+            const size_t vsize = m_vector_size;
+            if(m_levels.empty()) { return; }
+            const size_t nlevels = m_levels.size();
+
+            // the inputs of the tail levels are gathered before the outputs are written
+            for(size_t l = 1; l < nlevels; ++l)
+            {
+                Level& level = *m_levels[l];
+                const size_t index = level.chunk % 2;
+                for(size_t i = 0; i < m_number_of_inputs; ++i)
+                {
+                    T* input = level.inputs.data() + (index * m_number_of_inputs + i) * level.size;
+                    Signal<T>::copy(vsize, inputs[i], input + level.position);
+                }
+            }
+
+            m_levels[0]->convolver.process(inputs, outputs);
+
+            for(size_t l = 1; l < nlevels; ++l)
+            {
+                Level& level = *m_levels[l];
+                const size_t index = level.chunk % 2;
+                for(size_t o = 0; o < m_number_of_outputs; ++o)
+                {
+                    Signal<T>::add(vsize, level.output_channels[index][o] + level.position, outputs[o]);
+                }
+                level.position += vsize;
+                if(level.position == level.size)
+                {
+                    // the previous block is needed by the next vector
+                    wait(level);
+                    level.position = 0ul;
+                    level.requested.store(++level.chunk, std::memory_order_release);
+                    {
+                        std::lock_guard<std::mutex> guard(m_mutex);
+                    }
+                    m_condition.notify_one();
+                }
+            }
+        }
+
+    private:
+
+        //! @brief The ratio between the partition sizes of two levels.
+        static constexpr size_t ratio() noexcept { return 4ul; }
+
+        struct Level
+        {
+            Level(const size_t ninputs, const size_t noutputs, const size_t _size, const size_t _offset)
+            : convolver(ninputs, noutputs)
+            , size(_size)
+            , offset(_offset)
+            , inputs(ninputs * _size * 2, T(0))
+            , outputs(noutputs * _size * 2, T(0))
+            {
+                for(size_t k = 0; k < 2; ++k)
+                {
+                    for(size_t i = 0; i < ninputs; ++i)
+                    {
+                        input_channels[k].push_back(inputs.data() + (k * ninputs + i) * _size);
+                    }
+                    for(size_t o = 0; o < noutputs; ++o)
+                    {
+                        output_channels[k].push_back(outputs.data() + (k * noutputs + o) * _size);
+                    }
+                }
+            }
+
+            Convolver<T>            convolver;
+            const size_t            size;
+            const size_t            offset;
+            std::vector<T>          inputs;
+            std::vector<T>          outputs;
+            std::vector<const T*>   input_channels[2];
+            std::vector<T*>         output_channels[2];
+            size_t                  position = 0ul;
+            size_t                  chunk = 0ul;
+            std::atomic<size_t>     requested {0ul};
+            std::atomic<size_t>     completed {0ul};
+        };
+
+        //! @brief Waits for the blocks handed to the background thread.
+        static void wait(Level& level) noexcept
+        {
+            while(level.completed.load(std::memory_order_acquire) < level.requested.load(std::memory_order_relaxed))
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        //! @brief Returns true if a level has a block to convolve.
+        bool isPending() const noexcept
+        {
+            for(size_t l = 1; l < m_levels.size(); ++l)
+            {
+                if(m_levels[l]->completed.load(std::memory_order_relaxed) < m_levels[l]->requested.load(std::memory_order_acquire))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        //! @brief The loop of the background thread.
+        //! @details The levels with the smallest partitions have the nearest deadlines so
+        //! they are convolved first.
+        void run()
+        {
+            while(true)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_condition.wait(lock, [this]() { return !m_running || isPending(); });
+                    if(!m_running) { return; }
+                }
+                for(size_t l = 1; l < m_levels.size(); ++l)
+                {
+                    Level& level = *m_levels[l];
+                    const size_t job = level.completed.load(std::memory_order_relaxed);
+                    if(job < level.requested.load(std::memory_order_acquire))
+                    {
+                        // the block job is in the buffers job % 2
+                        T** outs = level.output_channels[job % 2].data();
+                        level.convolver.process(level.input_channels[job % 2].data(), outs);
+                        level.completed.store(job + 1, std::memory_order_release);
+                        break;
+                    }
+                }
+            }
+        }
+
+        //! @brief Stops the background thread.
+        void stop()
+        {
+            if(m_thread.joinable())
+            {
+                {
+                    std::lock_guard<std::mutex> guard(m_mutex);
+                    m_running = false;
+                }
+                m_condition.notify_one();
+                m_thread.join();
+            }
+        }
+
+        const size_t                        m_number_of_inputs;
+        const size_t                        m_number_of_outputs;
+        size_t                              m_vector_size = 0ul;
+        Partitioning                        m_partitioning = Uniform;
+        std::vector<std::vector<T>>         m_responses {};
+        std::vector<std::unique_ptr<Level>> m_levels {};
+        std::thread                         m_thread {};
+        std::mutex                          m_mutex {};
+        std::condition_variable             m_condition {};
+        bool                                m_running = false;
+    };
+}
@@ -13,6 +13,11 @@
 
 #include "Hoa_Encoder.hpp"
 #include "Hoa_Hrir.hpp"
+#include "Hoa_Convolver.hpp"
+#include "Hoa_Panner.hpp"
+#include "Hoa_Rotate.hpp"
+
+#include <thread>
 
 #include <Eigen/Dense>
 
@@ -32,17 +37,27 @@ namespace hoa
     public:
         
         //! @brief Decoding mode :
-        //! @details There are three types of decoders :
+        //! @details There are five types of decoders :
         //! - Regular is for a perfect circle or sphere of loudspeakers.
         //! - Irregular is suitable when the loudspeakers are not equally distibuted on the circle or the sphere.
         //! - Binaural is for headphone restitution.
-        enum Mode { RegularMode = 0, IrregularMode, BinauralMode };
+        //! - ModeMatching inverts the harmonics of the loudspeakers.
+        //! - EnergyPreserving is an energy preserving inversion of the harmonics of the loudspeakers.
+        enum Mode { RegularMode = 0, IrregularMode, BinauralMode, ModeMatchingMode, EnergyPreservingMode };
         
         //! @brief The decoder constructor.
         //! @details Allocates and initialize the base classes.
         //! @param order                   The order
         //! @param numberOfPlanewaves      The number of channels.
         Decoder(const size_t order, const size_t numberOfPlanewaves) noexcept;
+
+        //! @brief The decoder constructor for a mixed order.
+        //! @details Only the mode matching and the energy preserving decoders support the
+        //! mixed orders.
+        //! @param order                   The horizontal order
+        //! @param numberOfPlanewaves      The number of channels.
+        //! @param vertical                The vertical order.
+        Decoder(const size_t order, const size_t numberOfPlanewaves, const size_t vertical) noexcept;
         
         //! @brief The destructor.
         virtual ~Decoder() = 0;
@@ -62,6 +77,50 @@ namespace hoa
         virtual void prepare(const size_t vectorsize = 64);
     };
     
+    //! @cond
+    
+    //! @brief Computes a decoding matrix from the singular values of the harmonics of the plane waves.
+    //! @details The harmonics are weighted to be orthonormal over the circle or the sphere,
+    //! the transposed matrix of the harmonics of the plane waves is decomposed in
+    //! \f$U \Sigma V^{T}\f$ and the decoding matrix is \f$V f(\Sigma) U^{T}\f$ with the weights
+    //! of the harmonics applied back to the columns.
+    template <Dimension D, typename T>
+    struct decoder_inversion
+    {
+        template <typename Function>
+        static void compute(Decoder<D, T> const& decoder, T* matrix, Function function)
+        {
+            const size_t nharm = decoder.getNumberOfHarmonics();
+            const size_t nplws = decoder.getNumberOfPlanewaves();
+            
+            std::vector<T> azimuths(nplws), elevations(nplws), harmonics(nplws * nharm);
+            for(size_t i = 0; i < nplws; i++)
+            {
+                azimuths[i]   = decoder.getPlanewaveAzimuth(i);
+                elevations[i] = decoder.getPlanewaveElevation(i);
+            }
+            Encoder<D, T> encoder(decoder.getDecompositionOrder(), decoder.getVerticalOrder());
+            encoder.processDirections(nplws, azimuths.data(), elevations.data(), harmonics.data());
+            
+            Eigen::VectorXd weights(nharm);
+            for(size_t j = 0; j < nharm; j++)
+            {
+                const size_t degree = decoder.getHarmonicDegree(j);
+                weights(long(j)) = (D == Hoa2d) ? (degree ? std::sqrt(2.) : 1.) : std::sqrt(2. * double(degree) + 1.);
+            }
+            
+            const Eigen::Map<const Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>> y(harmonics.data(), long(nplws), long(nharm));
+            const Eigen::MatrixXd yt = weights.asDiagonal() * y.transpose().template cast<double>();
+            const Eigen::BDCSVD<Eigen::MatrixXd> svd(yt, Eigen::ComputeThinU | Eigen::ComputeThinV);
+            const Eigen::VectorXd values = function(svd.singularValues());
+            const Eigen::MatrixXd result = svd.matrixV() * values.asDiagonal() * svd.matrixU().transpose() * weights.asDiagonal();
+            
+            Eigen::Map<Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>(matrix, long(nplws), long(nharm)) = result.template cast<T>();
+        }
+    };
+    
+    //! @endcond
+    
     // ================================================================================ //
     // DECODER REGULAR //
     // ================================================================================ //
@@ -93,6 +152,8 @@ namespace hoa
         : Decoder<D, T>(order, nplws)
         , m_matrix(Decoder<D, T>::getNumberOfPlanewaves()
                    * Decoder<D, T>::getNumberOfHarmonics())
+        , m_packed(Signal<T>::packsize(Decoder<D, T>::getNumberOfHarmonics(),
+                                       Decoder<D, T>::getNumberOfPlanewaves()))
         {
             prepare();
         }
@@ -112,6 +173,12 @@ namespace hoa
             const size_t nplws = Decoder<D, T>::getNumberOfPlanewaves();
             const T* matrix = m_matrix.data();
             
+            if(m_transposed)
+            {
+                Signal<T>::mulTransposed(nharm, nplws, inputs, m_transposed_matrix.data(), outputs);
+                return;
+            }
+            
             for(size_t i = 0ul; i < nplws; i++)
             {
                 T result = 0;
@@ -133,10 +200,48 @@ namespace hoa
             }
         }
         
+        //! @brief The method performs the decoding of a block of harmonics signals.
+        //! @details The inputs array contains the channels of the harmonics and the outputs
+        //! array contains the channels of the plane waves, each channel has the vector size
+        //! defined with the prepare method. The block is decoded with a single matrix product
+        //! so the decoding matrix is loaded once per block instead of once per sample. The
+        //! outputs must not share memory with the inputs.
+        //! @param inputs  The inputs channels.
+        //! @param outputs The outputs channels.
+        void processBlock(const T** inputs, T** outputs) noexcept
+        {
+            Signal<T>::mul(Decoder<D, T>::getNumberOfHarmonics(),
+                           Decoder<D, T>::getNumberOfPlanewaves(),
+                           m_vector_size, m_packed.data(), inputs, outputs);
+        }
+        
+        //! @brief Sets the storage of the matrix used by the process method.
+        //! @details With the transposed storage, the sample by sample decoding runs across
+        //! the plane waves instead of the harmonics, this is faster when the number of plane
+        //! waves is large compared to the number of harmonics.
+        //! @param state The transposed state.
+        void setTransposed(const bool state)
+        {
+            m_transposed = state;
+            prepare(m_vector_size);
+        }
+        
+        //! @brief Returns the storage of the matrix used by the process method.
+        inline bool getTransposed() const noexcept { return m_transposed; }
+        
+        //! @brief Returns the vector size used by the processBlock method.
+        inline size_t getVectorSize() const noexcept { return m_vector_size; }
+        
+        //! @brief Returns the decoding matrix.
+        //! @details The matrix is stored row by row with a row for each plane wave and a
+        //! column for each harmonic.
+        inline const T* getMatrix() const noexcept { return m_matrix.data(); }
+        
         //! @brief Prepare the decoder for processing.
+        //! @param vectorsize The vector size for the block decoding.
         void prepare(const size_t vectorsize = 64) override
         {
-            hoa_unused(vectorsize);
+            m_vector_size = vectorsize;
             
             const size_t order = Decoder<D, T>::getDecompositionOrder();
             const size_t nharm = Decoder<D, T>::getNumberOfHarmonics();
@@ -162,6 +267,20 @@ namespace hoa
                     }
                 }
             }
+            
+            finalize();
+        }
+        
+        //! @brief Sets a decoding matrix computed before instead of preparing the decoder.
+        //! @details The matrix is copied, it must be stored like the one returned by
+        //! getMatrix(). The matrix is replaced by the next call to the prepare method.
+        //! @param matrix The decoding matrix.
+        //! @param vectorsize The vector size for the block decoding.
+        void setMatrix(const T* matrix, const size_t vectorsize = 64)
+        {
+            m_vector_size = vectorsize;
+            Signal<T>::copy(m_matrix.size(), matrix, m_matrix.data());
+            finalize();
         }
         
         //! @brief Returns the type of the decoder.
@@ -170,9 +289,274 @@ namespace hoa
             return Decoder<D, T>::RegularMode;
         }
         
+    private:
+        
+        //! @brief Packs the matrix for the block decoding and transposes it if needed.
+        void finalize()
+        {
+            const size_t nharm = Decoder<D, T>::getNumberOfHarmonics();
+            const size_t nplws = Decoder<D, T>::getNumberOfPlanewaves();
+            Signal<T>::pack(nharm, nplws, m_matrix.data(), m_packed.data());
+            if(m_transposed)
+            {
+                m_transposed_matrix.resize(nplws * nharm);
+                for(size_t i = 0; i < nplws; i++)
+                {
+                    Signal<T>::copy(nharm, m_matrix.data() + i * nharm, 1ul, m_transposed_matrix.data() + i, nplws);
+                }
+            }
+        }
+        
+        std::vector<T> m_matrix;
+        std::vector<T> m_packed;
+        std::vector<T> m_transposed_matrix {};
+        size_t         m_vector_size = 64ul;
+        bool           m_transposed = false;
+    };
+    
+    // ================================================================================ //
+    // DECODER MODE MATCHING //
+    // ================================================================================ //
+    
+    //! @brief The class decodes a sound field by inverting the harmonics of the plane waves.
+    //! @details The mode matching decoder computes the matrix that best recreates the
+    //! harmonics of the sound field when the signals of the plane waves are encoded again.
+    //! The matrix is the regularized pseudo-inverse of the matrix \f$Y\f$ of the harmonics of
+    //! the plane waves:
+    //! \f[D = Y(Y^{T}Y + \lambda I)^{-1}\f]
+    //! with \f$\lambda\f$ the regularization, relative to the largest squared singular value
+    //! of \f$Y\f$. The pseudo-inverse is computed with a singular value decomposition in
+    //! double precision. The plane waves can be irregularly distributed but the decoder
+    //! amplifies the harmonics that are poorly sampled by the plane waves if the
+    //! regularization is too small.
+    template <Dimension D, typename T>
+    class DecoderModeMatching
+    : public Decoder<D, T>
+    {
+    public:
+        
+        //! @brief The constructor.
+        //! @param order The order
+        //! @param nplws The number of channels.
+        DecoderModeMatching(size_t order, size_t nplws)
+        : Decoder<D, T>(order, nplws)
+        , m_matrix(Decoder<D, T>::getNumberOfPlanewaves() * Decoder<D, T>::getNumberOfHarmonics())
+        , m_packed(Signal<T>::packsize(Decoder<D, T>::getNumberOfHarmonics(),
+                                       Decoder<D, T>::getNumberOfPlanewaves()))
+        {
+            prepare();
+        }
+
+        //! @brief The constructor for a mixed order.
+        //! @details The harmonics of the plane waves are computed for the mixed order.
+        //! @param order The horizontal order
+        //! @param nplws The number of channels.
+        //! @param vertical The vertical order.
+        DecoderModeMatching(size_t order, size_t nplws, size_t vertical)
+        : Decoder<D, T>(order, nplws, vertical)
+        , m_matrix(Decoder<D, T>::getNumberOfPlanewaves() * Decoder<D, T>::getNumberOfHarmonics())
+        , m_packed(Signal<T>::packsize(Decoder<D, T>::getNumberOfHarmonics(),
+                                       Decoder<D, T>::getNumberOfPlanewaves()))
+        {
+            prepare();
+        }
+        
+        //! @brief The destructor.
+        ~DecoderModeMatching() = default;
+        
+        //! @brief The method performs the decoding of the harmonics signal.
+        //! @param inputs  The inputs array.
+        //! @param outputs The outputs array.
+        void process(const T* inputs, T* outputs) noexcept override
+        {
+            Signal<T>::mul(Decoder<D, T>::getNumberOfHarmonics(),
+                           Decoder<D, T>::getNumberOfPlanewaves(),
+                           inputs, m_matrix.data(), outputs);
+        }
+        
+        //! @brief The method performs the decoding of a block of harmonics signals.
+        //! @details The outputs must not share memory with the inputs.
+        //! @param inputs  The inputs channels.
+        //! @param outputs The outputs channels.
+        void processBlock(const T** inputs, T** outputs) noexcept
+        {
+            Signal<T>::mul(Decoder<D, T>::getNumberOfHarmonics(),
+                           Decoder<D, T>::getNumberOfPlanewaves(),
+                           m_vector_size, m_packed.data(), inputs, outputs);
+        }
+        
+        //! @brief Sets the regularization of the pseudo-inverse.
+        //! @details The regularization is relative to the largest squared singular value, you
+        //! should call the prepare method after.
+        //! @param regularization The regularization (default is 0.001).
+        inline void setRegularization(const T regularization) noexcept
+        {
+            m_regularization = std::max(regularization, T(0));
+        }
+        
+        //! @brief Returns the regularization of the pseudo-inverse.
+        inline T getRegularization() const noexcept { return m_regularization; }
+        
+        //! @brief Returns the decoding matrix.
+        //! @details The matrix is stored row by row with a row for each plane wave and a
+        //! column for each harmonic.
+        inline const T* getMatrix() const noexcept { return m_matrix.data(); }
+        
+        //! @brief Prepare the decoder for processing.
+        //! @param vectorsize The vector size for the block decoding.
+        void prepare(const size_t vectorsize = 64) override
+        {
+            m_vector_size = vectorsize;
+            const T regularization = m_regularization;
+            decoder_inversion<D, T>::compute(*this, m_matrix.data(), [regularization](Eigen::VectorXd const& values)
+            {
+                const double lambda = double(regularization) * values(0) * values(0);
+                const Eigen::ArrayXd denominator = values.array().square() + lambda;
+                return Eigen::VectorXd((denominator > 0.).select(values.array() / denominator, 0.));
+            });
+            Signal<T>::pack(Decoder<D, T>::getNumberOfHarmonics(), Decoder<D, T>::getNumberOfPlanewaves(),
+                            m_matrix.data(), m_packed.data());
+        }
+        
+        //! @brief Sets a decoding matrix computed before instead of preparing the decoder.
+        //! @details The matrix is copied, it must be stored like the one returned by
+        //! getMatrix(). The matrix is replaced by the next call to the prepare method.
+        //! @param matrix The decoding matrix.
+        //! @param vectorsize The vector size for the block decoding.
+        void setMatrix(const T* matrix, const size_t vectorsize = 64)
+        {
+            m_vector_size = vectorsize;
+            Signal<T>::copy(m_matrix.size(), matrix, m_matrix.data());
+            Signal<T>::pack(Decoder<D, T>::getNumberOfHarmonics(), Decoder<D, T>::getNumberOfPlanewaves(),
+                            m_matrix.data(), m_packed.data());
+        }
+        
+        //! @brief Returns the type of the decoder.
+        inline typename Decoder<D, T>::Mode getMode() const noexcept override
+        {
+            return Decoder<D, T>::ModeMatchingMode;
+        }
+        
+    private:
+        
+        std::vector<T> m_matrix;
+        std::vector<T> m_packed;
+        T              m_regularization = T(0.001);
+        size_t         m_vector_size = 64ul;
+    };
+    
+    // ================================================================================ //
+    // DECODER ENERGY PRESERVING //
+    // ================================================================================ //
+    
+    //! @brief The class decodes a sound field with an energy preserving matrix.
+    //! @details The energy preserving decoder (EPAD) replaces the singular values of the
+    //! matrix \f$Y\f$ of the harmonics of the plane waves by a constant. With the singular
+    //! value decomposition \f$Y^{T} = U \Sigma V^{T}\f$ the matrix is:
+    //! \f[D = \frac{1}{\sqrt{L}} V U^{T}\f]
+    //! with \f$L\f$ the number of plane waves. The energy of the signals of the plane waves
+    //! doesn't depend on the direction of the sound field as long as there are at least as
+    //! many plane waves as harmonics, and for a regular distribution the decoder is
+    //! equivalent to the mode matching decoder.
+    template <Dimension D, typename T>
+    class DecoderEnergyPreserving
+    : public Decoder<D, T>
+    {
+    public:
+        
+        //! @brief The constructor.
+        //! @param order The order
+        //! @param nplws The number of channels.
+        DecoderEnergyPreserving(size_t order, size_t nplws)
+        : Decoder<D, T>(order, nplws)
+        , m_matrix(Decoder<D, T>::getNumberOfPlanewaves() * Decoder<D, T>::getNumberOfHarmonics())
+        , m_packed(Signal<T>::packsize(Decoder<D, T>::getNumberOfHarmonics(),
+                                       Decoder<D, T>::getNumberOfPlanewaves()))
+        {
+            prepare();
+        }
+
+        //! @brief The constructor for a mixed order.
+        //! @details The harmonics of the plane waves are computed for the mixed order.
+        //! @param order The horizontal order
+        //! @param nplws The number of channels.
+        //! @param vertical The vertical order.
+        DecoderEnergyPreserving(size_t order, size_t nplws, size_t vertical)
+        : Decoder<D, T>(order, nplws, vertical)
+        , m_matrix(Decoder<D, T>::getNumberOfPlanewaves() * Decoder<D, T>::getNumberOfHarmonics())
+        , m_packed(Signal<T>::packsize(Decoder<D, T>::getNumberOfHarmonics(),
+                                       Decoder<D, T>::getNumberOfPlanewaves()))
+        {
+            prepare();
+        }
+        
+        //! @brief The destructor.
+        ~DecoderEnergyPreserving() = default;
+        
+        //! @brief The method performs the decoding of the harmonics signal.
+        //! @param inputs  The inputs array.
+        //! @param outputs The outputs array.
+        void process(const T* inputs, T* outputs) noexcept override
+        {
+            Signal<T>::mul(Decoder<D, T>::getNumberOfHarmonics(),
+                           Decoder<D, T>::getNumberOfPlanewaves(),
+                           inputs, m_matrix.data(), outputs);
+        }
+        
+        //! @brief The method performs the decoding of a block of harmonics signals.
+        //! @details The outputs must not share memory with the inputs.
+        //! @param inputs  The inputs channels.
+        //! @param outputs The outputs channels.
+        void processBlock(const T** inputs, T** outputs) noexcept
+        {
+            Signal<T>::mul(Decoder<D, T>::getNumberOfHarmonics(),
+                           Decoder<D, T>::getNumberOfPlanewaves(),
+                           m_vector_size, m_packed.data(), inputs, outputs);
+        }
+        
+        //! @brief Returns the decoding matrix.
+        //! @details The matrix is stored row by row with a row for each plane wave and a
+        //! column for each harmonic.
+        inline const T* getMatrix() const noexcept { return m_matrix.data(); }
+        
+        //! @brief Prepare the decoder for processing.
+        //! @param vectorsize The vector size for the block decoding.
+        void prepare(const size_t vectorsize = 64) override
+        {
+            m_vector_size = vectorsize;
+            const double factor = 1. / std::sqrt(double(Decoder<D, T>::getNumberOfPlanewaves()));
+            decoder_inversion<D, T>::compute(*this, m_matrix.data(), [factor](Eigen::VectorXd const& values)
+            {
+                return Eigen::VectorXd(Eigen::VectorXd::Constant(values.size(), factor));
+            });
+            Signal<T>::pack(Decoder<D, T>::getNumberOfHarmonics(), Decoder<D, T>::getNumberOfPlanewaves(),
+                            m_matrix.data(), m_packed.data());
+        }
+        
+        //! @brief Sets a decoding matrix computed before instead of preparing the decoder.
+        //! @details The matrix is copied, it must be stored like the one returned by
+        //! getMatrix(). The matrix is replaced by the next call to the prepare method.
+        //! @param matrix The decoding matrix.
+        //! @param vectorsize The vector size for the block decoding.
+        void setMatrix(const T* matrix, const size_t vectorsize = 64)
+        {
+            m_vector_size = vectorsize;
+            Signal<T>::copy(m_matrix.size(), matrix, m_matrix.data());
+            Signal<T>::pack(Decoder<D, T>::getNumberOfHarmonics(), Decoder<D, T>::getNumberOfPlanewaves(),
+                            m_matrix.data(), m_packed.data());
+        }
+        
+        //! @brief Returns the type of the decoder.
+        inline typename Decoder<D, T>::Mode getMode() const noexcept override
+        {
+            return Decoder<D, T>::EnergyPreservingMode;
+        }
+        
     private:
         
         std::vector<T> m_matrix;
+        std::vector<T> m_packed;
+        size_t         m_vector_size = 64ul;
     };
     
     // ================================================================================ //
@@ -213,7 +597,7 @@ namespace hoa
     {
     public:
         
-        enum Mode { RegularMode = 0, IrregularMode, BinauralMode };
+        enum Mode { RegularMode = 0, IrregularMode, BinauralMode, ModeMatchingMode, EnergyPreservingMode };
         
         //! @brief The decoder constructor.
         //! @param order The order
@@ -222,6 +606,15 @@ namespace hoa
         : ProcessorHarmonics<Hoa2d, T>(order)
         , ProcessorPlanewaves<Hoa2d, T>(channels)
         {}
+
+        //! @brief The decoder constructor for a mixed order.
+        //! @param order The horizontal order
+        //! @param channels The number of channels.
+        //! @param vertical The vertical order.
+        Decoder(const size_t order, const size_t channels, const size_t vertical)
+        : ProcessorHarmonics<Hoa2d, T>(order, vertical)
+        , ProcessorPlanewaves<Hoa2d, T>(channels)
+        {}
         
         //! @brief Destructor.
         virtual ~Decoder() = default;
@@ -267,6 +660,7 @@ namespace hoa
         {
             m_matrix = Signal<T>::alloc(Decoder<Hoa2d, T>::getNumberOfPlanewaves()
                                         * Decoder<Hoa2d, T>::getNumberOfHarmonics());
+            m_channels.reserve(Decoder<Hoa2d, T>::getNumberOfPlanewaves());
             prepare();
         }
         
@@ -294,8 +688,28 @@ namespace hoa
                            inputs, m_matrix, outputs);
         }
         
+        //! @brief Returns the decoding matrix.
+        //! @details The matrix is stored row by row with a row for each plane wave and a
+        //! column for each harmonic.
+        inline const T* getMatrix() const noexcept { return m_matrix; }
+        
+        //! @brief Sets a decoding matrix computed before instead of preparing the decoder.
+        //! @details The matrix is copied, it must be stored like the one returned by
+        //! getMatrix(). The matrix is replaced by the next call to the prepare method.
+        //! @param matrix The decoding matrix.
+        //! @param vectorsize The vector size for the block decoding.
+        void setMatrix(const T* matrix, const size_t vectorsize = 64)
+        {
+            hoa_unused(vectorsize);
+            Signal<T>::copy(Decoder<Hoa2d, T>::getNumberOfPlanewaves() * Decoder<Hoa2d, T>::getNumberOfHarmonics(),
+                            matrix, m_matrix);
+        }
+        
         //! @brief This method computes the decoding matrix.
         //! @details You should use this method after changing the position of the loudspeakers.
+        //! The virtual plane waves are swept once along the sorted loudspeakers and their
+        //! harmonics are only computed again when their number changes, the method doesn't
+        //! allocate memory as long as the number of virtual plane waves doesn't grow.
         //! @param vectorsize The vector size for binaural decoding.
         void prepare(const size_t vectorsize = 64)  override
         {
@@ -305,159 +719,119 @@ namespace hoa
             const auto harmonics = Decoder<Hoa2d, T>::getNumberOfHarmonics();
             const auto planewaves = Decoder<Hoa2d, T>::getNumberOfPlanewaves();
             
-            Encoder<Hoa2d, T> encoder(order);
             Signal<T>::clear(planewaves * harmonics, m_matrix);
             
-            T* vector_harmonics = Signal<T>::alloc(harmonics);
-            
             if(planewaves == 1)
             {
                 const size_t nls = size_t(order + 1);
                 const T factor = static_cast<T>(1.) / static_cast<T>(nls);
-                for(size_t i = 0; i <nls; i++)
+                prepareVirtual(nls);
+                for(size_t i = 0; i < nls; i++)
                 {
-                    encoder.setAzimuth(T(i) * HOA_2PI / T(nls));
-                    encoder.process(&factor, vector_harmonics);
-                    vector_harmonics[0] = factor * 0.5;
-                    Signal<T>::add(harmonics, vector_harmonics, m_matrix);
+                    addVirtual(i, factor, 0);
                 }
+                return;
             }
-            else
+            
+            m_channels.clear();
+            for(size_t i = 0; i < planewaves; i++)
+            {
+                m_channels.push_back(Planewave<Hoa2d, T>(i, math<T>::wrap_two_pi(Decoder<Hoa2d, T>::getPlanewaveAzimuth(i)), 0.));
+            }
+            std::sort(m_channels.begin(), m_channels.end(), Planewave<Hoa2d, T>::compare_azimuth);
+            
+            const size_t last = m_channels.size() - 1;
+            const T wrap_portion = (T(HOA_2PI) - m_channels[last].getAzimuth()) + m_channels[0].getAzimuth();
+            T smallest_distance = std::min(static_cast<T>(HOA_2PI), wrap_portion);
+            for(size_t i = 1; i < m_channels.size(); i++)
             {
-                T smallest_distance = static_cast<T>(HOA_2PI);
-                std::vector<Planewave<Hoa2d, T> > channels;
-                for(size_t i = 0; i < planewaves; i++)
+                const T portion = m_channels[i].getAzimuth() - m_channels[i-1].getAzimuth();
+                if(portion > T(0) && smallest_distance > portion)
                 {
-                    T nazimtuh = Decoder<Hoa2d, T>::getPlanewaveAzimuth(i);
-                    while(nazimtuh < T(0.)) {
-                        nazimtuh += T(HOA_2PI);
-                    }
-                    while(nazimtuh >= T(HOA_2PI)) {
-                        nazimtuh -= T(HOA_2PI);
-                    }
-                    channels.push_back(Planewave<Hoa2d, T>(i, nazimtuh, 0.));
+                    smallest_distance = portion;
                 }
-                
-                sort(channels.begin(), channels.end(), Planewave<Hoa2d, T>::compare_azimuth);
-                
+            }
+            if(smallest_distance > HOA_2PI / T(harmonics + 1.))
+            {
+                smallest_distance = HOA_2PI / T(harmonics + 1.);
+            }
+            
+            const size_t nvirtual = static_cast<size_t>(std::ceil(static_cast<T>(HOA_2PI) / smallest_distance));
+            const T factor = static_cast<T>(1) / static_cast<T>(nvirtual);
+            prepareVirtual(nvirtual);
+            
+            // The virtual plane waves and the loudspeakers are sorted, so the pair of
+            // loudspeakers that surrounds a virtual plane wave only moves forward.
+            size_t j = 1;
+            for(size_t i = 0; i < nvirtual; i++)
+            {
+                const T angle = T(i) / T(nvirtual) * HOA_2PI;
+                if(angle < m_channels[0].getAzimuth())
                 {
-                    const T current_angle   = channels[0].getAzimuth();
-                    const T previous_angle  = channels[channels.size() - 1].getAzimuth();
-                    const T previous_portion= (HOA_2PI - previous_angle) + current_angle;
-                    if(smallest_distance > previous_portion)
-                    {
-                        smallest_distance = previous_portion;
-                    }
-                    //post("channel %i : %f", (int)channels[0].getIndex(), (float)(channels[0].getAzimuth() / HOA_2PI * 360.f));
+                    const T ratio = (m_channels[0].getAzimuth() - angle) / wrap_portion;
+                    addVirtual(i, (1. - ratio) * factor, m_channels[0].getIndex());
+                    addVirtual(i, ratio * factor, m_channels[last].getIndex());
                 }
-                for(size_t i = 1; i < channels.size(); i++)
+                else if(angle >= m_channels[last].getAzimuth())
                 {
-                    const T current_angle   = channels[i].getAzimuth();
-                    const T previous_angle  = channels[i-1].getAzimuth();
-                    const T previous_portion= current_angle - previous_angle;
-                    if(smallest_distance > previous_portion)
+                    const T ratio = (angle - m_channels[last].getAzimuth()) / wrap_portion;
+                    addVirtual(i, (1. - ratio) * factor, m_channels[last].getIndex());
+                    addVirtual(i, ratio * factor, m_channels[0].getIndex());
+                }
+                else
+                {
+                    while(m_channels[j].getAzimuth() <= angle)
                     {
-                        smallest_distance = previous_portion;
+                        ++j;
                     }
-                    //post("channel %i : %f", (int)channels[i].getIndex(), (float)(channels[i].getAzimuth() / HOA_2PI * 360.f));
+                    const T portion = (m_channels[j].getAzimuth() - m_channels[j-1].getAzimuth());
+                    const T ratio = (m_channels[j].getAzimuth() - angle) / portion;
+                    addVirtual(i, (1. - ratio) * factor, m_channels[j].getIndex());
+                    addVirtual(i, ratio * factor, m_channels[j-1].getIndex());
                 }
-                //post("");
-                
-                if(smallest_distance > HOA_2PI / T(harmonics + 1.))
+            }
+        }
+        
+    private:
+        
+        //! @brief Computes the harmonics of the equally spaced virtual plane waves.
+        void prepareVirtual(const size_t nvirtual)
+        {
+            if(nvirtual != m_nvirtual)
+            {
+                const size_t harmonics = Decoder<Hoa2d, T>::getNumberOfHarmonics();
+                m_virtual_azimuths.resize(nvirtual);
+                m_virtual_harmonics.resize(nvirtual * harmonics);
+                for(size_t i = 0; i < nvirtual; i++)
                 {
-                    smallest_distance = HOA_2PI / T(harmonics + 1.);
+                    m_virtual_azimuths[i] = T(i) / T(nvirtual) * HOA_2PI;
                 }
-                const size_t nvirtual = static_cast<size_t>(std::ceil(static_cast<T>(HOA_2PI) / smallest_distance));
-                const T factor = static_cast<T>(1) / static_cast<T>(nvirtual);
-                
-                //post("number of virtual %i", nvirtual);
+                Encoder<Hoa2d, T> encoder(Decoder<Hoa2d, T>::getDecompositionOrder());
+                encoder.processDirections(nvirtual, m_virtual_azimuths.data(), nullptr, m_virtual_harmonics.data());
                 for(size_t i = 0; i < nvirtual; i++)
                 {
-                    const T angle = T(i) / T(nvirtual) * HOA_2PI;
-                    //post("virtual %i :  %f", (int)i , (float)(angle / HOA_2PI * 360.f));
-                    if(angle < channels[0].getAzimuth())
-                    {
-                        const T portion = (HOA_2PI - channels[channels.size()-1].getAzimuth()) + channels[0].getAzimuth();
-                        
-                        const T factor1 = (1. - ((channels[0].getAzimuth() - angle) / portion)) * factor;
-                        encoder.setAzimuth(angle);
-                        encoder.process(&factor1, vector_harmonics);
-                        vector_harmonics[0] = factor1 * 0.5;
-                        Signal<T>::add(harmonics, vector_harmonics, m_matrix + channels[0].getIndex() * harmonics);
-                        
-                        const T factor2 = ((channels[0].getAzimuth() - angle) / portion) * factor;
-                        encoder.process(&factor2, vector_harmonics);
-                        vector_harmonics[0] = factor2 * 0.5;
-                        Signal<T>::add(harmonics, vector_harmonics, m_matrix + channels[channels.size() - 1].getIndex() * harmonics);
-                        
-                        //post("portion : %f", (float)portion / HOA_2PI * 360.f);
-                        //post("channel %i (%f) : %f", (int)channels[channels.size()-1].getIndex(),
-                        //     (float)(channels[channels.size()-1].getAzimuth() / HOA_2PI * 360.f),
-                        //     (float)(factor2 / factor) * 100.f);
-                        //post("channel %i (%f) : %f", (int)channels[0].getIndex(),
-                        //     (float)(channels[0].getAzimuth() / HOA_2PI * 360.f),
-                        //     (float)(factor1 / factor) * 100.f);
-                    }
-                    else if(angle >= channels[channels.size() - 1].getAzimuth())
-                    {
-                        const T portion = (HOA_2PI - channels[channels.size()-1].getAzimuth()) + channels[0].getAzimuth();
-                        
-                        const T factor1 = (1. - ((angle - channels[channels.size()-1].getAzimuth()) / portion)) * factor;
-                        encoder.setAzimuth(angle);
-                        encoder.process(&factor1, vector_harmonics);
-                        vector_harmonics[0] = factor1 * 0.5;
-                        Signal<T>::add(harmonics, vector_harmonics, m_matrix + channels[channels.size()-1].getIndex() * harmonics);
-                        
-                        const T factor2 = ((angle - channels[channels.size()-1].getAzimuth()) / portion) * factor;
-                        encoder.process(&factor2, vector_harmonics);
-                        vector_harmonics[0] = factor2 * 0.5;
-                        Signal<T>::add(harmonics, vector_harmonics, m_matrix + channels[0].getIndex() * harmonics);
-                        
-                        //post("portion : %f", (float)portion / HOA_2PI * 360.f);
-                        //post("channel %i (%f) : %f", (int)channels[channels.size()-1].getIndex(),
-                        //     (float)(channels[channels.size()-1].getAzimuth() / HOA_2PI * 360.f),
-                        //     (float)(factor1 / factor) * 100.f);
-                        //post("channel %i (%f) : %f", (int)channels[0].getIndex(),
-                        //     (float)(channels[0].getAzimuth() / HOA_2PI * 360.f),
-                        //     (float)(factor2 / factor) * 100.f);
-                    }
-                    else
-                    {
-                        for(size_t j = 1; j < channels.size(); j++)
-                        {
-                            if(angle < channels[j].getAzimuth() && angle >= channels[j-1].getAzimuth())
-                            {
-                                const T portion = (channels[j].getAzimuth() - channels[j-1].getAzimuth());
-                                
-                                const T factor1 = (1. - ((channels[j].getAzimuth() - angle) / portion)) * factor;
-                                encoder.setAzimuth(angle);
-                                encoder.process(&factor1, vector_harmonics);
-                                vector_harmonics[0] = factor1 * 0.5;
-                                Signal<T>::add(harmonics, vector_harmonics, m_matrix + channels[j].getIndex() * harmonics);
-                                
-                                const T factor2 = ((channels[j].getAzimuth() - angle) / portion) * factor;
-                                encoder.process(&factor2, vector_harmonics);
-                                vector_harmonics[0] = factor2 * 0.5;
-                                Signal<T>::add(harmonics, vector_harmonics, m_matrix + channels[j-1].getIndex() * harmonics);
-                                
-                                //post("portion : %f", (float)portion / HOA_2PI * 360.f);
-                                //post("channel %i (%f) : %f", (int)channels[j-1].getIndex(),
-                                //     (float)(channels[j-1].getAzimuth() / HOA_2PI * 360.f),
-                                //     (float)(factor2 / factor) * 100.f);
-                                //post("channel %i (%f) : %f", (int)channels[j].getIndex(),
-                                //     (float)(channels[j].getAzimuth() / HOA_2PI * 360.f),
-                                //     (float)(factor1 / factor) * 100.f);
-                                
-                                break;
-                            }
-                        }
-                    }
-                    //post("");
+                    m_virtual_harmonics[i * harmonics] = T(0.5);
                 }
-                channels.clear();
+                m_nvirtual = nvirtual;
+            }
+        }
+        
+        //! @brief Adds the scaled harmonics of a virtual plane wave to the row of a loudspeaker.
+        inline void addVirtual(const size_t index, const T factor, const size_t channel) noexcept
+        {
+            const size_t harmonics = Decoder<Hoa2d, T>::getNumberOfHarmonics();
+            const T* in = m_virtual_harmonics.data() + index * harmonics;
+            T* out = m_matrix + channel * harmonics;
+            for(size_t i = 0; i < harmonics; i++)
+            {
+                out[i] += in[i] * factor;
             }
-            Signal<T>::free(vector_harmonics);
         }
+        
+        std::vector<Planewave<Hoa2d, T>>    m_channels {};
+        std::vector<T>                      m_virtual_azimuths {};
+        std::vector<T>                      m_virtual_harmonics {};
+        size_t                              m_nvirtual = 0ul;
     };
     
     // ================================================================================ //
@@ -466,6 +840,10 @@ namespace hoa
     
     //! @brief The ambisonic binaural decoder.
     //! @details The binaural decoder should be used to decode an ambisonic sound field for headphones.
+    //! The harmonics are convolved with the responses of the harmonics for each ear in the
+    //! frequency domain (see the Convolver class), the spectra of the responses are computed
+    //! by the prepare method. For small vectors, the responses can be cut in partitions of
+    //! increasing sizes (see the ConvolverNonUniform class).
     template <typename T, typename HrirType>
     class DecoderBinaural<Hoa2d, T, HrirType>
     : public Decoder<Hoa2d, T>
@@ -480,6 +858,8 @@ namespace hoa
         //! @param order The order
         DecoderBinaural(const size_t order)
         : Decoder<Hoa2d, T>(order, 2)
+        , m_convolver(std::min(Decoder<Hoa2d, T>::getNumberOfHarmonics(), hrir_t::getNumberOfColumns()), 2)
+        , m_direct(m_convolver.getNumberOfInputs(), 2)
         {
             Decoder<Hoa2d, T>::setPlanewaveAzimuth(0, static_cast<T>(HOA_PI2*3.));
             Decoder<Hoa2d, T>::setPlanewaveAzimuth(1, static_cast<T>(HOA_PI2));
@@ -487,10 +867,7 @@ namespace hoa
         }
         
         //! @brief Destructor.
-        ~DecoderBinaural() noexcept
-        {
-            clear();
-        }
+        ~DecoderBinaural() noexcept = default;
         
         //! @brief This method retrieves the mode of the decoder.
         //! @return The mode of the decoder.
@@ -500,11 +877,38 @@ namespace hoa
         }
         
         //! @brief This method sets the crop size of the responses.
+        //! @details If the decoder has been prepared, the spectra of the responses are
+        //! computed again. The short responses are convolved in the time domain when it's
+        //! faster than the partitioned convolution (see isDirectConvolution()).
         //! @param size The crop size.
-        inline void setCropSize(const size_t size) noexcept
+        inline void setCropSize(const size_t size)
         {
             const auto num_rows = hrir_t::getNumberOfRows();
+            const auto num_cols = hrir_t::getNumberOfColumns();
             m_crop_size = (size == 0ul || size > num_rows) ? num_rows : size;
+            for(size_t i = 0; i < m_convolver.getNumberOfInputs(); ++i)
+            {
+                if(m_symmetric)
+                {
+                    // the even harmonics feed the first output, the odd harmonics the second
+                    const size_t output = (hrir_t::getSymmetrySign(i) > 0) ? 0ul : 1ul;
+                    m_convolver.setResponse(output, i, m_crop_size, hrir_t::template getLeftMatrix<T>() + i, num_cols);
+                    m_convolver.setResponse(1ul - output, i, 0ul, nullptr);
+                    m_direct.setResponse(output, i, m_crop_size, hrir_t::template getLeftMatrix<T>() + i, num_cols);
+                    m_direct.setResponse(1ul - output, i, 0ul, nullptr);
+                }
+                else
+                {
+                    m_convolver.setResponse(0, i, m_crop_size, hrir_t::template getLeftMatrix<T>() + i, num_cols);
+                    m_convolver.setResponse(1, i, m_crop_size, hrir_t::template getRightMatrix<T>() + i, num_cols);
+                    m_direct.setResponse(0, i, m_crop_size, hrir_t::template getLeftMatrix<T>() + i, num_cols);
+                    m_direct.setResponse(1, i, m_crop_size, hrir_t::template getRightMatrix<T>() + i, num_cols);
+                }
+            }
+            if(m_vector_size)
+            {
+                prepare(m_vector_size);
+            }
         }
         
         //! @brief This method gets the crop size of the responses.
@@ -515,31 +919,89 @@ namespace hoa
             return (m_crop_size == num_rows) ? 0ul : m_crop_size;
         }
         
-        //! @brief This method computes the decoding matrix.
+        //! @brief This method sets the partitioning of the responses.
+        //! @details The non-uniform partitioning should be used with small vectors (32
+        //! samples or less), the convolution has no latency in both modes. If the decoder
+        //! has been prepared, the responses are partitioned again.
+        //! @param partitioning The partitioning.
+        void setPartitioning(const typename ConvolverNonUniform<T>::Partitioning partitioning)
+        {
+            m_convolver.setPartitioning(partitioning);
+            if(m_vector_size)
+            {
+                prepare(m_vector_size);
+            }
+        }
+        
+        //! @brief This method gets the partitioning of the responses.
+        //! @return The partitioning.
+        inline typename ConvolverNonUniform<T>::Partitioning getPartitioning() const noexcept
+        {
+            return m_convolver.getPartitioning();
+        }
+        
+        //! @brief This method gets the latency of the convolution beyond the vector.
+        //! @return The latency in samples (always 0).
+        inline size_t getLatency() const noexcept
+        {
+            return m_convolver.getLatency();
+        }
+        
+        //! @brief This method gets if the responses are symmetric.
+        //! @details If the responses of the right ear are the responses of the left ear
+        //! multiplied by the signs of the symmetry of the harmonics (see Hrir::isSymmetric()),
+        //! the harmonics are convolved once with the responses of the left ear, in an even
+        //! sum and an odd sum, and the ears are the sum and the difference of the two sums.
+        //! @return true if the responses are symmetric.
+        inline bool isSymmetric() const noexcept
+        {
+            return m_symmetric;
+        }
+        
+        //! @brief This method gets if the responses are convolved in the time domain.
+        //! @details The direct convolution is used when the crop size is short enough
+        //! for the vector size, the partitioning is ignored in this case.
+        //! @return true if the convolution is direct, false if it is partitioned.
+        inline bool isDirectConvolution() const noexcept
+        {
+            return m_direct_mode;
+        }
+        
+        //! @brief This method computes the spectra of the responses.
+        //! @details The method selects the direct or the partitioned convolution.
         //! @param vectorsize The vector size for binaural decoding.
         void prepare(const size_t vectorsize = 64) override
         {
-            clear();
-            m_vector_size  = vectorsize;
-            m_input  = Signal<T>::alloc(hrir_t::getNumberOfColumns() * m_vector_size);
-            m_result = Signal<T>::alloc(hrir_t::getNumberOfRows() * m_vector_size);
-            m_left   = Signal<T>::alloc(hrir_t::getNumberOfRows() + m_vector_size);
-            m_right  = Signal<T>::alloc(hrir_t::getNumberOfRows() + m_vector_size);
+            m_vector_size = vectorsize;
+            m_direct_mode = ConvolverDirect<T>::isEfficient(m_crop_size, m_vector_size);
+            if(m_direct_mode)
+            {
+                m_direct.prepare(m_vector_size);
+            }
+            else
+            {
+                m_convolver.prepare(m_vector_size);
+            }
         }
         
     public:
         
         //! @brief This method performs the binaural decoding and the convolution.
+        //! @details The outputs can share memory with the inputs.
         inline void processBlock(const T** inputs, T** outputs) noexcept
         {
-            T* input = m_input;
-            for(size_t i = 0; i < hrir_t::getNumberOfColumns() && i < Decoder<Hoa2d, T>::getNumberOfHarmonics(); i++)
+            if(m_direct_mode)
+            {
+                m_direct.process(inputs, outputs);
+            }
+            else
+            {
+                m_convolver.process(inputs, outputs);
+            }
+            if(m_symmetric)
             {
-                Signal<T>::copy(m_vector_size, inputs[i], input);
-                input += m_vector_size;
+                Signal<T>::butterfly(m_vector_size, outputs[0], outputs[1]);
             }
-            processChannel(m_input, hrir_t::template getLeftMatrix<T>(), m_left, outputs[0]);
-            processChannel(m_input, hrir_t::template getRightMatrix<T>(), m_right, outputs[1]);
         }
         
         inline void process(const T* inputs, T* outputs) noexcept override
@@ -550,38 +1012,13 @@ namespace hoa
             assert(true && "use the processBlock method instead");
         }
         
-    private:
-        
-        inline void processChannel(const T* harmonics, const T* response, T* vector, T* output) noexcept
-        {
-            const size_t l = hrir_t::getNumberOfColumns();   // Harmonics size aka 11
-            const size_t m = m_crop_size;      // Impulses size
-            const size_t n = m_vector_size;    // Vector size
-            Signal<T>::mul(m, n, l, response, harmonics, m_result);
-            for(size_t i = 0; i < n; i ++)
-            {
-                Signal<T>::add(m, m_result + i, n, vector + i, 1ul);
-            }
-            Signal<T>::copy(m_vector_size, vector, output);
-            Signal<T>::copy(m, vector + m_vector_size, vector);
-            Signal<T>::clear(m_vector_size, vector + m);
-        }
-        
-        void clear()
-        {
-            m_input  = Signal<T>::free(m_input);
-            m_result = Signal<T>::free(m_result);
-            m_left   = Signal<T>::free(m_left);
-            m_right  = Signal<T>::free(m_right);
-        }
-        
     private:
         size_t m_vector_size = 0ul;
         size_t m_crop_size = 0ul;
-        T* m_input = nullptr;
-        T* m_result = nullptr;
-        T* m_left = nullptr;
-        T* m_right = nullptr;
+        bool   m_direct_mode = false;
+        const bool m_symmetric = hrir_t::isSymmetric();
+        ConvolverNonUniform<T> m_convolver;
+        ConvolverDirect<T>     m_direct;
     };
     
     // ================================================================================ //
@@ -591,8 +1028,9 @@ namespace hoa
     //! @brief The decoder 3D decodes a sound field in the harmonics domain through the planewaves domain.
     //! @details The decoder should be used to decode a set of harmonics
     //! to a set of planewaves for loudspeakers.
-    //! There are two types of decoders.
+    //! There are three types of decoders.
     //! - Regular for a perfect circle or sphere of loudspeakers.
+    //! - Irregular when the loudspeakers are not equally distributed on the sphere.
     //! - Binaural for headphone restitution.
     template <typename T>
     class Decoder<Hoa3d, T>
@@ -601,7 +1039,7 @@ namespace hoa
     {
     public:
         
-        enum Mode { RegularMode = 0, BinauralMode = 2 };
+        enum Mode { RegularMode = 0, IrregularMode = 1, BinauralMode = 2, ModeMatchingMode = 3, EnergyPreservingMode = 4 };
         
         //! @brief Constructor.
         //! @param order The order
@@ -610,6 +1048,15 @@ namespace hoa
         : ProcessorHarmonics<Hoa3d, T>(order)
         , ProcessorPlanewaves<Hoa3d, T>(channels)
         {}
+
+        //! @brief The decoder constructor for a mixed order.
+        //! @param order The horizontal order
+        //! @param channels The number of channels.
+        //! @param vertical The vertical order.
+        Decoder(const size_t order, const size_t channels, const size_t vertical)
+        : ProcessorHarmonics<Hoa3d, T>(order, vertical)
+        , ProcessorPlanewaves<Hoa3d, T>(channels)
+        {}
         
         //! @brief Destructor.
         virtual ~Decoder() {}
@@ -630,12 +1077,233 @@ namespace hoa
         virtual void prepare(const size_t vectorsize = 64) = 0;
     };
     
+    // ================================================================================ //
+    // DECODER 3D IRREGULAR //
+    // ================================================================================ //
+    
+    //! @brief The ambisonic irregular decoder for the sphere.
+    //! @details The irregular decoder should be used to decode an ambisonic sound field
+    //! when the loudspeakers are not equally distributed on the sphere (domes, hemispheres,
+    //! etc.). The decoder uses the all-round ambisonic decoding approach (AllRAD): the sound
+    //! field is decoded to a dense and nearly uniform layout of virtual plane waves and each
+    //! virtual plane wave is panned to the loudspeakers with the vector base amplitude
+    //! panning (VBAP) over a triangulation of the sphere. If there is no loudspeaker below
+    //! or above the horizontal plane, an imaginary loudspeaker is added at the bottom or at
+    //! the top of the sphere and its signal is discarded.<br>
+    //! The computation of the matrix is distributed over several threads.
+    template <typename T>
+    class DecoderIrregular<Hoa3d, T>
+    : public Decoder<Hoa3d, T>
+    {
+    public:
+        
+        //! @brief Constructor.
+        //! @param order The order
+        //! @param channels The number of channels.
+        DecoderIrregular(const size_t order, const size_t channels)
+        : Decoder<Hoa3d, T>(order, channels)
+        , m_matrix(Decoder<Hoa3d, T>::getNumberOfPlanewaves()
+                   * Decoder<Hoa3d, T>::getNumberOfHarmonics())
+        , m_packed(Signal<T>::packsize(Decoder<Hoa3d, T>::getNumberOfHarmonics(),
+                                       Decoder<Hoa3d, T>::getNumberOfPlanewaves()))
+        {
+            prepare();
+        }
+        
+        //! @brief Destructor.
+        ~DecoderIrregular() = default;
+        
+        //! @brief Returns the mode of the decoder.
+        //! @return The mode of the decoder.
+        inline typename Decoder<Hoa3d, T>::Mode getMode() const noexcept override
+        {
+            return Decoder<Hoa3d, T>::IrregularMode;
+        }
+        
+        //! @brief This method performs the decoding.
+        //! @details You should use this method for in-place or not-in-place processing and sample by sample.
+        //! @param inputs The input array that contains the samples of the harmonics.
+        //! @param outputs The output array that contains samples destinated to the channels.
+        inline void process(const T* inputs, T* outputs) noexcept override
+        {
+            Signal<T>::mul(Decoder<Hoa3d, T>::getNumberOfHarmonics(),
+                           Decoder<Hoa3d, T>::getNumberOfPlanewaves(),
+                           inputs, m_matrix.data(), outputs);
+        }
+        
+        //! @brief The method performs the decoding of a block of harmonics signals.
+        //! @details The inputs array contains the channels of the harmonics and the outputs
+        //! array contains the channels of the plane waves, each channel has the vector size
+        //! defined with the prepare method. The outputs must not share memory with the inputs.
+        //! @param inputs  The inputs channels.
+        //! @param outputs The outputs channels.
+        void processBlock(const T** inputs, T** outputs) noexcept
+        {
+            Signal<T>::mul(Decoder<Hoa3d, T>::getNumberOfHarmonics(),
+                           Decoder<Hoa3d, T>::getNumberOfPlanewaves(),
+                           m_vector_size, m_packed.data(), inputs, outputs);
+        }
+        
+        //! @brief Returns the decoding matrix.
+        //! @details The matrix is stored row by row with a row for each plane wave and a
+        //! column for each harmonic.
+        inline const T* getMatrix() const noexcept { return m_matrix.data(); }
+        
+        //! @brief Returns the number of virtual plane waves used to compute the matrix.
+        inline size_t getNumberOfVirtualPlanewaves() const noexcept
+        {
+            const size_t order = Decoder<Hoa3d, T>::getDecompositionOrder();
+            return std::max(size_t(240), 6 * (order + 1) * (order + 1));
+        }
+        
+        //! @brief This method computes the decoding matrix.
+        //! @details You should use this method after changing the position of the loudspeakers.
+        //! @param vectorsize The vector size for the block decoding.
+        void prepare(const size_t vectorsize = 64) override
+        {
+            m_vector_size = vectorsize;
+            
+            const size_t nharm      = Decoder<Hoa3d, T>::getNumberOfHarmonics();
+            const size_t nplws      = Decoder<Hoa3d, T>::getNumberOfPlanewaves();
+            const size_t nvirtual   = getNumberOfVirtualPlanewaves();
+            
+            // Triangulation of the loudspeakers
+            {
+                std::vector<T> azimuths(nplws);
+                std::vector<T> elevations(nplws);
+                for(size_t i = 0; i < nplws; i++)
+                {
+                    azimuths[i]   = Decoder<Hoa3d, T>::getPlanewaveAzimuth(i);
+                    elevations[i] = Decoder<Hoa3d, T>::getPlanewaveElevation(i);
+                }
+                m_layout.compute(nplws, azimuths.data(), elevations.data());
+            }
+            
+            // Virtual layout on a Fibonacci sphere
+            m_virtual_azimuths.resize(nvirtual);
+            m_virtual_elevations.resize(nvirtual);
+            m_virtual_harmonics.resize(nvirtual * nharm);
+            m_virtual_gains.resize(nvirtual * 3);
+            m_virtual_indices.resize(nvirtual * 3);
+            const double golden = HOA_PI * (3. - std::sqrt(5.));
+            for(size_t i = 0; i < nvirtual; i++)
+            {
+                m_virtual_azimuths[i]   = T(std::fmod(double(i) * golden, HOA_2PI));
+                m_virtual_elevations[i] = T(std::asin(1. - (2. * double(i) + 1.) / double(nvirtual)));
+            }
+            
+            // Harmonics and panning gains of the virtual plane waves
+            const size_t nthreads = std::max(size_t(1), std::min(size_t(std::thread::hardware_concurrency()),
+                                                                 nvirtual / 64));
+            if(nthreads > 1)
+            {
+                std::vector<std::thread> threads;
+                threads.reserve(nthreads);
+                for(size_t i = 0; i < nthreads; i++)
+                {
+                    threads.emplace_back(&DecoderIrregular::prepareVirtual, this,
+                                         (i * nvirtual) / nthreads, ((i + 1) * nvirtual) / nthreads);
+                }
+                for(auto& thread : threads)
+                {
+                    thread.join();
+                }
+            }
+            else
+            {
+                prepareVirtual(0, nvirtual);
+            }
+            
+            // Projection of the virtual plane waves on the loudspeakers
+            std::vector<T> weights(nharm);
+            for(size_t j = 0; j < nharm; j++)
+            {
+                const size_t degree = Decoder<Hoa3d, T>::getHarmonicDegree(j);
+                weights[j] = (T(2) * T(degree) + T(1)) / T(nvirtual);
+            }
+            std::fill(m_matrix.begin(), m_matrix.end(), T(0));
+            for(size_t i = 0; i < nvirtual; i++)
+            {
+                const T* harmonics = m_virtual_harmonics.data() + i * nharm;
+                for(size_t k = 0; k < 3; k++)
+                {
+                    const size_t index = m_virtual_indices[i * 3 + k];
+                    const T gain = m_virtual_gains[i * 3 + k];
+                    if(index < nplws && gain != T(0))
+                    {
+                        T* row = m_matrix.data() + index * nharm;
+                        for(size_t j = 0; j < nharm; j++)
+                        {
+                            row[j] += gain * weights[j] * harmonics[j];
+                        }
+                    }
+                }
+            }
+            
+            Signal<T>::pack(nharm, nplws, m_matrix.data(), m_packed.data());
+        }
+        
+        //! @brief Sets a decoding matrix computed before instead of preparing the decoder.
+        //! @details The matrix is copied, it must be stored like the one returned by
+        //! getMatrix(). The matrix is replaced by the next call to the prepare method.
+        //! @param matrix The decoding matrix.
+        //! @param vectorsize The vector size for the block decoding.
+        void setMatrix(const T* matrix, const size_t vectorsize = 64)
+        {
+            m_vector_size = vectorsize;
+            Signal<T>::copy(m_matrix.size(), matrix, m_matrix.data());
+            Signal<T>::pack(Decoder<Hoa3d, T>::getNumberOfHarmonics(), Decoder<Hoa3d, T>::getNumberOfPlanewaves(),
+                            m_matrix.data(), m_packed.data());
+        }
+        
+    private:
+        
+        //! @brief Computes the harmonics and the panning gains of a range of virtual plane waves.
+        void prepareVirtual(const size_t start, const size_t end)
+        {
+            const size_t nharm = Decoder<Hoa3d, T>::getNumberOfHarmonics();
+            
+            Encoder<Hoa3d, T> encoder(Decoder<Hoa3d, T>::getDecompositionOrder());
+            encoder.processDirections(end - start,
+                                      m_virtual_azimuths.data() + start,
+                                      m_virtual_elevations.data() + start,
+                                      m_virtual_harmonics.data() + start * nharm);
+            
+            for(size_t i = start; i < end; i++)
+            {
+                size_t* indices = m_virtual_indices.data() + i * 3;
+                T* gains = m_virtual_gains.data() + i * 3;
+                m_layout.pan(m_virtual_azimuths[i], m_virtual_elevations[i], indices, gains);
+                const T norm = std::sqrt(gains[0] * gains[0] + gains[1] * gains[1] + gains[2] * gains[2]);
+                if(norm > T(0))
+                {
+                    for(size_t k = 0; k < 3; k++)
+                    {
+                        gains[k] /= norm;
+                    }
+                }
+            }
+        }
+        
+        std::vector<T>                      m_matrix;
+        std::vector<T>                      m_packed;
+        PannerLayout<Hoa3d, T>              m_layout {};
+        std::vector<T>                      m_virtual_azimuths {};
+        std::vector<T>                      m_virtual_elevations {};
+        std::vector<T>                      m_virtual_harmonics {};
+        std::vector<T>                      m_virtual_gains {};
+        std::vector<size_t>                 m_virtual_indices {};
+        size_t                              m_vector_size = 64ul;
+    };
+    
     // ================================================================================ //
     // DECODER 3D BINAURAL //
     // ================================================================================ //
     
     //! @brief The ambisonic binaural decoder.
     //! @details The binaural decoder should be used to decode an ambisonic sound field for headphones.
+    //! The harmonics are convolved with the responses of the harmonics for each ear in the
+    //! frequency domain (see the Convolver and the ConvolverNonUniform classes).
     template <typename T, typename HrirType>
     class DecoderBinaural<Hoa3d, T, HrirType>
     : public Decoder<Hoa3d, T>
@@ -655,9 +1323,12 @@ namespace hoa
         //! @param order The order.
         DecoderBinaural(const size_t order)
         : Decoder<Hoa3d, T>(order, 2)
+        , m_convolver(std::min(Decoder<Hoa3d, T>::getNumberOfHarmonics(), hrir_t::getNumberOfColumns()), 2)
+        , m_rotate(Harmonic<Hoa3d, T>::getDegree(m_convolver.getNumberOfInputs() - 1))
         {
             Decoder<Hoa3d, T>::setPlanewaveAzimuth(0, math<T>::pi_over_two() * 3.);
             Decoder<Hoa3d, T>::setPlanewaveAzimuth(1, math<T>::pi_over_two());
+            setTruncation(T(0));
         }
         
         //! @brief This method retrieves the mode of the decoder.
@@ -670,23 +1341,176 @@ namespace hoa
         //! @brief Destructor.
         ~DecoderBinaural() = default;
         
-        //! @brief This method computes the decoding matrix.
-        //! @param vectorsize The vector size for binaural decoding.
-        void prepare(const size_t vectorsize = 64) override
+        //! @brief This method sets the partitioning of the responses.
+        //! @details The non-uniform partitioning should be used with small vectors (32
+        //! samples or less), the convolution has no latency in both modes. If the decoder
+        //! has been prepared, the responses are partitioned again.
+        //! @param partitioning The partitioning.
+        void setPartitioning(const typename ConvolverNonUniform<T>::Partitioning partitioning)
+        {
+            m_convolver.setPartitioning(partitioning);
+            if(m_vector_size)
+            {
+                m_convolver.prepare(m_vector_size);
+            }
+        }
+        
+        //! @brief This method gets the partitioning of the responses.
+        //! @return The partitioning.
+        inline typename ConvolverNonUniform<T>::Partitioning getPartitioning() const noexcept
+        {
+            return m_convolver.getPartitioning();
+        }
+        
+        //! @brief This method gets the latency of the convolution beyond the vector.
+        //! @return The latency in samples (always 0).
+        inline size_t getLatency() const noexcept
+        {
+            return m_convolver.getLatency();
+        }
+        
+        //! @brief This method sets the energy threshold of the truncation of the responses.
+        //! @details The response of each harmonic (both ears) is truncated after the sample
+        //! where the energy of the remaining samples falls below the threshold relative to
+        //! the energy of the response:
+        //! \f[L_{i} = \min\{L | \sum_{n \geq L} h_{i}[n]^{2} \leq 10^{t/10} \sum_{n} h_{i}[n]^{2}\}\f]
+        //! The responses of the upper degrees decay faster so their convolutions use less
+        //! partitions. If the decoder has been prepared, the spectra of the responses are
+        //! computed again.
+        //! @param threshold The threshold in dB (0 or above disables the truncation).
+        void setTruncation(const T threshold)
         {
-            m_vector_size = vectorsize;
-            
             constexpr auto response_size = hrir_t::getNumberOfRows();
             constexpr auto number_of_harmonics = hrir_t::getNumberOfColumns();
+            const T* left = hrir_t::template getLeftMatrix<T>();
+            const T* right = hrir_t::template getRightMatrix<T>();
+            const T ratio = std::pow(T(10), threshold / T(10));
             
-            // the setZero method resize and set matrice and vector coefficients to 0.
-            
-            m_input.setZero(number_of_harmonics, m_vector_size);
-            m_result.setZero(response_size, m_vector_size);
+            m_truncation = std::min(threshold, T(0));
+            m_response_sizes.resize(m_convolver.getNumberOfInputs());
+            for(size_t i = 0; i < m_convolver.getNumberOfInputs(); ++i)
+            {
+                T total = T(0);
+                for(size_t j = 0; j < response_size; ++j)
+                {
+                    const T l = left[j * number_of_harmonics + i];
+                    const T r = right[j * number_of_harmonics + i];
+                    total += l * l + r * r;
+                }
+                
+                size_t size = response_size;
+                T remaining = T(0);
+                while(size > 0 && threshold < T(0))
+                {
+                    const T l = left[(size - 1) * number_of_harmonics + i];
+                    const T r = right[(size - 1) * number_of_harmonics + i];
+                    if(remaining + l * l + r * r > total * ratio)
+                    {
+                        break;
+                    }
+                    remaining += l * l + r * r;
+                    --size;
+                }
+                
+                m_response_sizes[i] = size;
+                if(m_symmetric)
+                {
+                    // the even harmonics feed the first output, the odd harmonics the second
+                    const size_t output = (hrir_t::getSymmetrySign(i) > 0) ? 0ul : 1ul;
+                    m_convolver.setResponse(output, i, size, left + i, number_of_harmonics);
+                    m_convolver.setResponse(1ul - output, i, 0ul, nullptr);
+                }
+                else
+                {
+                    m_convolver.setResponse(0, i, size, left + i, number_of_harmonics);
+                    m_convolver.setResponse(1, i, size, right + i, number_of_harmonics);
+                }
+            }
+            if(m_vector_size)
+            {
+                prepare(m_vector_size);
+            }
+        }
+        
+        //! @brief This method gets the energy threshold of the truncation of the responses.
+        //! @return The threshold in dB (0 if the responses aren't truncated).
+        inline T getTruncation() const noexcept
+        {
+            return m_truncation;
+        }
+        
+        //! @brief This method gets the size of the truncated response of a harmonic.
+        //! @param index The index of the harmonic.
+        //! @return The number of taps of the response (0 if the harmonic isn't convolved).
+        inline size_t getResponseSize(const size_t index) const noexcept
+        {
+            return index < m_response_sizes.size() ? m_response_sizes[index] : 0ul;
+        }
+        
+        //! @brief This method gets if the responses are symmetric.
+        //! @details If the responses of the right ear are the responses of the left ear
+        //! multiplied by the signs of the symmetry of the harmonics (see Hrir::isSymmetric()),
+        //! the harmonics are convolved once with the responses of the left ear, in an even
+        //! sum and an odd sum, and the ears are the sum and the difference of the two sums.
+        //! @return true if the responses are symmetric.
+        inline bool isSymmetric() const noexcept
+        {
+            return m_symmetric;
+        }
+        
+        //! @brief This method sets the orientation of the head for the head tracking.
+        //! @details The harmonics are rotated by the inverse of the orientation of the head
+        //! before the convolution, the rotation is interpolated over the next block (see
+        //! Rotate<Hoa3d, T>::getMatrix(const T, const T, const T, T*) for the angles).
+        //! @param yaw   The yaw of the head in radian.
+        //! @param pitch The pitch of the head in radian.
+        //! @param roll  The roll of the head in radian.
+        void setHeadOrientation(const T yaw, const T pitch, const T roll) noexcept
+        {
+            T matrix[9];
+            Rotate<Hoa3d, T>::getMatrix(yaw, pitch, roll, matrix);
+            setHeadMatrix(matrix);
+        }
+        
+        //! @brief This method sets the orientation of the head with a unit quaternion.
+        //! @param w The real part of the quaternion.
+        //! @param x The x part of the quaternion.
+        //! @param y The y part of the quaternion.
+        //! @param z The z part of the quaternion.
+        void setHeadOrientation(const T w, const T x, const T y, const T z) noexcept
+        {
+            T matrix[9];
+            Rotate<Hoa3d, T>::getMatrix(w, x, y, z, matrix);
+            setHeadMatrix(matrix);
+        }
+        
+        //! @brief This method gets the motion-to-sound latency of the head tracking.
+        //! @details A new orientation of the head is applied from the first sample of the
+        //! next block and reached at its last sample, the convolution adds its latency.
+        //! @return The latency in samples.
+        inline size_t getHeadTrackingLatency() const noexcept
+        {
+            return m_vector_size + getLatency();
+        }
+        
+        //! @brief This method computes the spectra of the responses.
+        //! @param vectorsize The vector size for binaural decoding.
+        void prepare(const size_t vectorsize = 64) override
+        {
+            m_vector_size = vectorsize;
+            m_convolver.prepare(m_vector_size);
             
-            const auto side_vecsize = response_size + m_vector_size;
-            m_left.setZero(side_vecsize);
-            m_right.setZero(side_vecsize);
+            const auto number_of_inputs = m_convolver.getNumberOfInputs();
+            m_input.setZero(number_of_inputs, m_vector_size);
+            m_output.setZero(2, m_vector_size);
+            m_inputs.resize(number_of_inputs);
+            m_rotated.resize(number_of_inputs);
+            for(size_t i = 0; i < number_of_inputs; ++i)
+            {
+                m_inputs[i] = m_input.row(i).data();
+                m_rotated[i] = m_input.row(i).data();
+            }
+            m_outputs = { m_output.row(0).data(), m_output.row(1).data() };
         }
         
         [[deprecated]] void setCropSize(const size_t size) noexcept {}
@@ -695,21 +1519,19 @@ namespace hoa
     public:
         
         //! @brief This method performs the binaural decoding and the convolution.
+        //! @details The outputs can share memory with the inputs. With the head tracking,
+        //! the rotation reads the inputs and feeds the convolution directly.
         inline void processBlock(const T** inputs, T** outputs) noexcept
         {
-            const auto ins = std::min(Decoder<Hoa3d, T>::getNumberOfHarmonics(),
-                                      hrir_t::getNumberOfColumns());
-            
-            for(auto i = 0; i < ins; ++i)
+            if(m_rotating)
             {
-                m_input.row(i).noalias() = vector_t::Map(inputs[i], m_vector_size);
+                m_rotate.processBlock(m_vector_size, inputs, m_rotated.data());
+                convolve(m_inputs.data(), outputs);
+            }
+            else
+            {
+                convolve(inputs, outputs);
             }
-            
-            processChannel(m_input, m_left_matrix, m_left,
-                           vector_t::Map(outputs[0], m_vector_size));
-            
-            processChannel(m_input, m_right_matrix, m_right,
-                           vector_t::Map(outputs[1], m_vector_size));
         }
         
         //! @brief This method performs the binaural decoding and the convolution.
@@ -718,8 +1540,13 @@ namespace hoa
         {
             assert(inputs.cols() == m_vector_size);
             
-            processChannel(inputs, m_left_matrix, m_left, outputs.row(0));
-            processChannel(inputs, m_right_matrix, m_right, outputs.row(1));
+            m_input = inputs.topRows(m_input.rows());
+            if(m_rotating)
+            {
+                m_rotate.processBlock(m_vector_size, m_inputs.data(), m_rotated.data());
+            }
+            convolve(m_inputs.data(), m_outputs.data());
+            outputs = m_output;
         }
         
         inline void process(const T* inputs, T* outputs) noexcept override
@@ -732,50 +1559,44 @@ namespace hoa
         
     private:
         
-        using vector_t = Eigen::VectorX<T>;
-        using matrix_t = Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>;
-        using hrir_matrix_t = Eigen::Map<const Eigen::Matrix<T, hrir_t::getNumberOfRows(), hrir_t::getNumberOfColumns(), Eigen::RowMajor>>;
-        using output_channel_ref_t = Eigen::Ref<vector_t, 0, Eigen::InnerStride<>>;
+        //! @brief Sets the rotation of the harmonics from the orientation of the head.
+        void setHeadMatrix(const T* head) noexcept
+        {
+            // the inverse of the orientation of the head is its transpose
+            const T matrix[9] =
+            {
+                head[0], head[3], head[6],
+                head[1], head[4], head[7],
+                head[2], head[5], head[8]
+            };
+            m_rotate.setMatrix(matrix);
+            m_rotating = true;
+        }
         
-        void processChannel(matrix_t const& harmonics_matrix,
-                            hrir_matrix_t const& response_matrix,
-                            vector_t& buffer,
-                            output_channel_ref_t output)
+        //! @brief Convolves the harmonics and forms the ears of symmetric responses.
+        inline void convolve(const T** inputs, T** outputs) noexcept
         {
-            constexpr auto rsize = hrir_t::getNumberOfRows();
-            const size_t n = m_vector_size;
-            
-            m_result.noalias() = response_matrix * harmonics_matrix;
-            
-            for(size_t i = 0; i < n; ++i)
+            m_convolver.process(inputs, outputs);
+            if(m_symmetric)
             {
-                buffer.template segment<rsize>(i).noalias() += m_result.col(i);
+                Signal<T>::butterfly(m_vector_size, outputs[0], outputs[1]);
             }
-            
-            output = buffer.head(n);
-            buffer.head(rsize) = buffer.template segment<rsize>(n);
-            buffer.segment(rsize, n).setZero();
         }
         
-    private:
+        using matrix_t = Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
         
         size_t  m_vector_size = 0ul;
+        T       m_truncation = T(0);
+        const bool m_symmetric = hrir_t::isSymmetric();
+        std::vector<size_t> m_response_sizes = {};
+        bool    m_rotating = false;
+        ConvolverNonUniform<T> m_convolver;
+        Rotate<Hoa3d, T> m_rotate;
         matrix_t m_input = {};
-        matrix_t m_result = {};
-        vector_t m_left = {};
-        vector_t m_right = {};
-        
-        const hrir_matrix_t m_left_matrix = {
-            hrir_t::template getLeftMatrix<T>(),
-            hrir_t::getNumberOfRows(),
-            hrir_t::getNumberOfColumns()
-        };
-        
-        const hrir_matrix_t m_right_matrix = {
-            hrir_t::template getRightMatrix<T>(),
-            hrir_t::getNumberOfRows(),
-            hrir_t::getNumberOfColumns()
-        };
+        matrix_t m_output = {};
+        std::vector<const T*> m_inputs = {};
+        std::vector<T*> m_rotated = {};
+        std::vector<T*> m_outputs = {};
     };
     
     // syntactic sugar
@@ -0,0 +1,419 @@
+/*
+// Copyright (c) 2012-2017 CICM - Universite Paris 8 - Labex Arts H2H.
+// Authors :
+// 2012: Pierre Guillot, Eliott Paris & Julien Colafrancesco.
+// 2012-2015: Pierre Guillot & Eliott Paris.
+// 2015: Pierre Guillot & Eliott Paris & Thomas Le Meur (Light version)
+// 2016-2017: Pierre Guillot.
+// For information on usage and redistribution, and for a DISCLAIMER OF ALL
+// WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+*/
+
+#pragma once
+
+#include "Hoa_Decoder.hpp"
+
+#include <cstdint>
+
+namespace hoa
+{
+    // ================================================================================ //
+    // DECODER BINAURAL BATCH //
+    // ================================================================================ //
+
+    //! @brief The class decodes the same harmonics in binaural for several listeners.
+    //! @details Each listener has its own orientation of the head. The rotation and the
+    //! Fourier transform are linear so the rotation of the harmonics is applied to their
+    //! spectra: the spectra of the responses and the forward transforms of the harmonics
+    //! (uniformly partitioned and overlap-save, as Convolver) are computed once for all the
+    //! listeners. The work of a listener is the rotation of the spectra of the block, the
+    //! multiply-accumulate of the partitions in its own frequency-domain delay line and the
+    //! inverse transforms of the two ears.<br>
+    //! The rotation of a listener is applied to the spectra of a whole block, so a new
+    //! orientation is applied at the next block without interpolation (the rotated spectra
+    //! of the previous blocks keep their rotation). The listeners are distributed over the
+    //! calling thread and a pool of worker threads, each listener writes only its own
+    //! buffers and outputs. The convolution has no latency.
+    template <typename T, class HrirType>
+    class DecoderBinauralBatch
+    {
+    public:
+
+        static_assert(HrirType::dimension == Hoa3d, "not a valid 3D response");
+
+        using hrir_t = Hrir<Hoa3d, HrirType>;
+
+        //! @brief Constructor.
+        //! @param order      The order of the harmonics.
+        //! @param nlisteners The number of listeners.
+        //! @param nthreads   The number of threads (the calling thread and nthreads - 1 workers).
+        DecoderBinauralBatch(const size_t order, const size_t nlisteners, const size_t nthreads = 1)
+        : m_number_of_harmonics(Harmonic<Hoa3d, T>::getNumberOfHarmonics(order))
+        , m_number_of_inputs(std::min(m_number_of_harmonics, hrir_t::getNumberOfColumns()))
+        , m_number_of_threads(std::max(nthreads, size_t(1)))
+        {
+            const size_t rotation_order = Harmonic<Hoa3d, T>::getDegree(m_number_of_inputs - 1);
+            for(size_t i = 0; i < nlisteners; ++i)
+            {
+                m_listeners.emplace_back(new Listener(rotation_order));
+            }
+        }
+
+        //! @brief Destructor.
+        ~DecoderBinauralBatch()
+        {
+            stop();
+        }
+
+        //! @brief Returns the number of harmonics of the inputs.
+        inline size_t getNumberOfHarmonics() const noexcept { return m_number_of_harmonics; }
+
+        //! @brief Returns the number of listeners.
+        inline size_t getNumberOfListeners() const noexcept { return m_listeners.size(); }
+
+        //! @brief Returns the number of outputs (two ears by listener).
+        inline size_t getNumberOfOutputs() const noexcept { return m_listeners.size() * 2; }
+
+        //! @brief Returns the number of threads.
+        inline size_t getNumberOfThreads() const noexcept { return m_number_of_threads; }
+
+        //! @brief Returns the vector size.
+        inline size_t getVectorSize() const noexcept { return m_vector_size; }
+
+        //! @brief Returns the latency of the convolution beyond the vector (always 0).
+        inline size_t getLatency() const noexcept { return 0ul; }
+
+        //! @brief This method sets the orientation of the head of a listener.
+        //! @details The harmonics of the listener are rotated by the inverse of the
+        //! orientation (see Rotate<Hoa3d, T>::getMatrix(const T, const T, const T, T*) for
+        //! the angles). The method must not be called while processing.
+        //! @param listener The index of the listener.
+        //! @param yaw      The yaw of the head in radian.
+        //! @param pitch    The pitch of the head in radian.
+        //! @param roll     The roll of the head in radian.
+        void setHeadOrientation(const size_t listener, const T yaw, const T pitch, const T roll) noexcept
+        {
+            T matrix[9];
+            Rotate<Hoa3d, T>::getMatrix(yaw, pitch, roll, matrix);
+            setHeadMatrix(listener, matrix);
+        }
+
+        //! @brief This method sets the orientation of the head of a listener with a unit quaternion.
+        //! @param listener The index of the listener.
+        //! @param w        The real part of the quaternion.
+        //! @param x        The x part of the quaternion.
+        //! @param y        The y part of the quaternion.
+        //! @param z        The z part of the quaternion.
+        void setHeadOrientation(const size_t listener, const T w, const T x, const T y, const T z) noexcept
+        {
+            T matrix[9];
+            Rotate<Hoa3d, T>::getMatrix(w, x, y, z, matrix);
+            setHeadMatrix(listener, matrix);
+        }
+
+        //! @brief This method computes the spectra of the responses and starts the workers.
+        //! @details The method must not be called while processing.
+        //! @param vectorsize The vector size.
+        void prepare(const size_t vectorsize = 64)
+        {
+            assert(vectorsize > 0);
+            stop();
+            m_vector_size = vectorsize;
+            m_fft = Fft<T>(Fft<T>::getPowerOfTwo(vectorsize * 2));
+            const size_t fsize = m_fft.getSize();
+            const size_t nbins = m_fft.getNumberOfBins();
+            const size_t nins  = m_number_of_inputs;
+            const size_t rsize = hrir_t::getNumberOfRows();
+            const size_t ncols = hrir_t::getNumberOfColumns();
+            const size_t nparts = (rsize + vectorsize - 1) / vectorsize;
+            m_number_of_partitions = nparts;
+
+            // the spectra of the responses, shared by the listeners
+            m_filters_real.assign(2 * nins * nparts * nbins, T(0));
+            m_filters_imag.assign(2 * nins * nparts * nbins, T(0));
+            std::vector<T> partition(fsize);
+            for(size_t o = 0; o < 2; ++o)
+            {
+                const T* matrix = (o == 0) ? hrir_t::template getLeftMatrix<T>() : hrir_t::template getRightMatrix<T>();
+                for(size_t i = 0; i < nins; ++i)
+                {
+                    for(size_t j = 0; j < nparts; ++j)
+                    {
+                        std::fill(partition.begin(), partition.end(), T(0));
+                        for(size_t k = j * vectorsize; k < std::min((j + 1) * vectorsize, rsize); ++k)
+                        {
+                            partition[k - j * vectorsize] = matrix[k * ncols + i];
+                        }
+                        const size_t index = ((o * nins + i) * nparts + j) * nbins;
+                        m_fft.forward(partition.data(), m_filters_real.data() + index, m_filters_imag.data() + index);
+                    }
+                }
+            }
+
+            m_windows.assign(nins * fsize, T(0));
+            m_spectra_real.assign(nins * nbins, T(0));
+            m_spectra_imag.assign(nins * nbins, T(0));
+            for(auto& listener : m_listeners)
+            {
+                listener->prepare(fsize, nbins, nins * nparts * nbins);
+            }
+            m_position = 0ul;
+
+            m_running = true;
+            for(size_t i = 1; i < m_number_of_threads; ++i)
+            {
+                m_workers.emplace_back(&DecoderBinauralBatch::run, this);
+            }
+        }
+
+        //! @brief Clears the delay lines.
+        //! @details The method must not be called while processing.
+        void clear() noexcept
+        {
+            std::fill(m_windows.begin(), m_windows.end(), T(0));
+            for(auto& listener : m_listeners)
+            {
+                std::fill(listener->delays_real.begin(), listener->delays_real.end(), T(0));
+                std::fill(listener->delays_imag.begin(), listener->delays_imag.end(), T(0));
+            }
+            m_position = 0ul;
+        }
+
+        //! @brief This method performs the binaural decoding for all the listeners.
+        //! @details The inputs are the harmonics of the scene, the outputs are the left and
+        //! the right ears of each listener (the ears of the listener \f$l\f$ are the outputs
+        //! \f$2l\f$ and \f$2l+1\f$). The inputs are read before the outputs are written, so the
+        //! outputs can share memory with the inputs.
+        //! @param inputs  The inputs channels.
+        //! @param outputs The outputs channels.
+        void processBlock(const T** inputs, T** outputs) noexcept
+        {
+            const size_t vsize = m_vector_size;
+            if(!vsize) { return; }
+            const size_t fsize = m_fft.getSize();
+            const size_t nbins = m_fft.getNumberOfBins();
+
+            // the forward transforms shared by the listeners
+            for(size_t i = 0; i < m_number_of_inputs; ++i)
+            {
+                T* window = m_windows.data() + i * fsize;
+                std::copy(window + vsize, window + fsize, window);
+                Signal<T>::copy(vsize, inputs[i], window + fsize - vsize);
+                m_fft.forward(window, m_spectra_real.data() + i * nbins, m_spectra_imag.data() + i * nbins);
+            }
+
+            // the claims of the block are published after the shared state
+            m_outputs = outputs;
+            m_completed.store(0ul, std::memory_order_relaxed);
+            uint64_t generation;
+            {
+                std::lock_guard<std::mutex> guard(m_mutex);
+                generation = (m_generation + 1) & 0xffffffff;
+                m_next.store(generation << 32, std::memory_order_release);
+                m_generation = generation;
+            }
+            if(m_number_of_threads > 1)
+            {
+                m_condition.notify_all();
+            }
+            work(generation);
+            while(m_completed.load(std::memory_order_acquire) < m_listeners.size())
+            {
+                std::this_thread::yield();
+            }
+            m_position = (m_position + 1) % m_number_of_partitions;
+        }
+
+    private:
+
+        struct Listener
+        {
+            Listener(const size_t order) : rotate(order) {}
+
+            void prepare(const size_t fsize, const size_t nbins, const size_t ndelays)
+            {
+                fft = Fft<T>(fsize);
+                delays_real.assign(ndelays, T(0));
+                delays_imag.assign(ndelays, T(0));
+                accumulator_real.resize(nbins);
+                accumulator_imag.resize(nbins);
+                output.resize(fsize);
+            }
+
+            Rotate<Hoa3d, T>    rotate;
+            bool                rotating = false;
+            Fft<T>              fft {};
+            std::vector<T>      delays_real {};
+            std::vector<T>      delays_imag {};
+            std::vector<T>      accumulator_real {};
+            std::vector<T>      accumulator_imag {};
+            std::vector<T>      output {};
+        };
+
+        //! @brief Sets the rotation of a listener from the orientation of the head.
+        void setHeadMatrix(const size_t listener, const T* head) noexcept
+        {
+            // the inverse of the orientation of the head is its transpose
+            const T matrix[9] =
+            {
+                head[0], head[3], head[6],
+                head[1], head[4], head[7],
+                head[2], head[5], head[8]
+            };
+            m_listeners[listener]->rotate.setMatrix(matrix);
+            m_listeners[listener]->rotating = true;
+        }
+
+        //! @brief Processes the listeners of a block until there is no listener left.
+        //! @details The claims hold the generation of the block in the high bits and the
+        //! index of the listener in the low bits, a thread claims only the listeners of the
+        //! generation it observed so a late thread never processes another block.
+        //! @param generation The generation of the block.
+        void work(const uint64_t generation) noexcept
+        {
+            const uint64_t nlisteners = m_listeners.size();
+            uint64_t claim = m_next.load(std::memory_order_acquire);
+            while((claim >> 32) == generation && (claim & 0xffffffff) < nlisteners)
+            {
+                if(m_next.compare_exchange_weak(claim, claim + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+                {
+                    process(static_cast<size_t>(claim & 0xffffffff));
+                    m_completed.fetch_add(1ul, std::memory_order_release);
+                    claim = m_next.load(std::memory_order_acquire);
+                }
+            }
+        }
+
+        //! @brief Rotates the spectra of a listener, convolves them and writes its ears.
+        void process(const size_t index) noexcept
+        {
+            Listener& listener = *m_listeners[index];
+            const size_t vsize  = m_vector_size;
+            const size_t fsize  = m_fft.getSize();
+            const size_t nbins  = m_fft.getNumberOfBins();
+            const size_t nparts = m_number_of_partitions;
+            const size_t nins   = m_number_of_inputs;
+            const size_t order  = listener.rotate.getDecompositionOrder();
+
+            // the rotated spectra of the block in the delay line of the listener
+            T* delays_real = listener.delays_real.data();
+            T* delays_imag = listener.delays_imag.data();
+            const T* spectra_real = m_spectra_real.data();
+            const T* spectra_imag = m_spectra_imag.data();
+            for(size_t l = 0; l <= order; ++l)
+            {
+                const size_t size = l * 2 + 1;
+                const T* matrix = listener.rotate.getDegreeMatrix(l);
+                for(size_t i = 0; i < size; ++i)
+                {
+                    const size_t offset = ((l * l + i) * nparts + m_position) * nbins;
+                    T* yr = delays_real + offset;
+                    T* yi = delays_imag + offset;
+                    if(!listener.rotating)
+                    {
+                        Signal<T>::copy(nbins, spectra_real + (l * l + i) * nbins, yr);
+                        Signal<T>::copy(nbins, spectra_imag + (l * l + i) * nbins, yi);
+                        continue;
+                    }
+                    Signal<T>::clear(nbins, yr);
+                    Signal<T>::clear(nbins, yi);
+                    for(size_t j = 0; j < size; ++j)
+                    {
+                        const T gain = matrix[i * size + j];
+                        const T* xr = spectra_real + (l * l + j) * nbins;
+                        const T* xi = spectra_imag + (l * l + j) * nbins;
+                        for(size_t k = 0; k < nbins; ++k)
+                        {
+                            yr[k] += gain * xr[k];
+                            yi[k] += gain * xi[k];
+                        }
+                    }
+                }
+            }
+
+            // the multiply-accumulate of the partitions and the inverse transforms
+            T* accr = listener.accumulator_real.data();
+            T* acci = listener.accumulator_imag.data();
+            for(size_t o = 0; o < 2; ++o)
+            {
+                Signal<T>::clear(nbins, accr);
+                Signal<T>::clear(nbins, acci);
+                for(size_t i = 0; i < nins; ++i)
+                {
+                    for(size_t j = 0; j < nparts; ++j)
+                    {
+                        const size_t slot = (m_position + nparts - j) % nparts;
+                        const T* xr = delays_real + (i * nparts + slot) * nbins;
+                        const T* xi = delays_imag + (i * nparts + slot) * nbins;
+                        const T* hr = m_filters_real.data() + ((o * nins + i) * nparts + j) * nbins;
+                        const T* hi = m_filters_imag.data() + ((o * nins + i) * nparts + j) * nbins;
+                        for(size_t k = 0; k < nbins; ++k)
+                        {
+                            accr[k] += xr[k] * hr[k] - xi[k] * hi[k];
+                            acci[k] += xr[k] * hi[k] + xi[k] * hr[k];
+                        }
+                    }
+                }
+                listener.fft.inverse(accr, acci, listener.output.data());
+                Signal<T>::copy(vsize, listener.output.data() + fsize - vsize, m_outputs[index * 2 + o]);
+            }
+        }
+
+        //! @brief The loop of a worker thread.
+        void run()
+        {
+            uint64_t generation;
+            {
+                std::lock_guard<std::mutex> guard(m_mutex);
+                generation = m_generation;
+            }
+            while(true)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_condition.wait(lock, [&]() { return !m_running || m_generation != generation; });
+                    if(!m_running) { return; }
+                    generation = m_generation;
+                }
+                work(generation);
+            }
+        }
+
+        //! @brief Stops the worker threads.
+        void stop()
+        {
+            {
+                std::lock_guard<std::mutex> guard(m_mutex);
+                m_running = false;
+            }
+            m_condition.notify_all();
+            for(auto& worker : m_workers)
+            {
+                worker.join();
+            }
+            m_workers.clear();
+        }
+
+        const size_t                            m_number_of_harmonics;
+        const size_t                            m_number_of_inputs;
+        const size_t                            m_number_of_threads;
+        size_t                                  m_vector_size = 0ul;
+        size_t                                  m_number_of_partitions = 0ul;
+        size_t                                  m_position = 0ul;
+        Fft<T>                                  m_fft {};
+        std::vector<T>                          m_filters_real {};
+        std::vector<T>                          m_filters_imag {};
+        std::vector<T>                          m_windows {};
+        std::vector<T>                          m_spectra_real {};
+        std::vector<T>                          m_spectra_imag {};
+        std::vector<std::unique_ptr<Listener>>  m_listeners {};
+        T**                                     m_outputs = nullptr;
+        std::atomic<uint64_t>                   m_next {0ul};
+        std::atomic<size_t>                     m_completed {0ul};
+        std::vector<std::thread>                m_workers {};
+        std::mutex                              m_mutex {};
+        std::condition_variable                 m_condition {};
+        uint64_t                                m_generation = 0ul;
+        bool                                    m_running = false;
+    };
+}
@@ -0,0 +1,351 @@
+/*
+// Copyright (c) 2012-2017 CICM - Universite Paris 8 - Labex Arts H2H.
+// Authors :
+// 2012: Pierre Guillot, Eliott Paris & Julien Colafrancesco.
+// 2012-2015: Pierre Guillot & Eliott Paris.
+// 2015: Pierre Guillot & Eliott Paris & Thomas Le Meur (Light version)
+// 2016-2017: Pierre Guillot.
+// For information on usage and redistribution, and for a DISCLAIMER OF ALL
+// WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+*/
+
+#pragma once
+
+#include "Hoa_Decoder.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <process.h>
+#endif
+
+namespace hoa
+{
+    // ================================================================================ //
+    // DECODER CACHE //
+    // ================================================================================ //
+
+    //! @brief The class stores the matrices of the decoders in files.
+    //! @details Preparing the irregular or the inversion decoders for a large number of
+    //! loudspeakers can take a long time. The cache stores the matrix of a prepared decoder
+    //! in a file of a directory and loads it back at the next start instead of computing it
+    //! again. The file is named after a key that hashes the revision of the cache, the
+    //! dimension, the type, the mode, the order (and the vertical order of a mixed order),
+    //! the positions of the plane waves (with the rotation), the parameters of the decoder
+    //! that change its matrix (the regularization of the mode matching decoder) and optional
+    //! settings (the optimization applied after the decoder for example).<br>
+    //! The file has a small header with a magic number, the revision, the key, the size of
+    //! the matrix and a checksum of the matrix. The file is memory-mapped (except on Windows
+    //! where it is read) and the matrix is copied directly to the decoder. A file that
+    //! doesn't match is ignored and the decoder is prepared and stored again. The files are
+    //! written to a temporary file unique to the process and the call then renamed, so a
+    //! reader never sees a partial file and concurrent writers don't share a file.
+    template <Dimension D, typename T>
+    class DecoderCache
+    {
+    public:
+
+        //! @brief Constructor.
+        //! @param directory The directory of the files, it must exist.
+        DecoderCache(std::string const& directory)
+        : m_directory(directory)
+        {
+            ;
+        }
+
+        //! @brief Destructor.
+        ~DecoderCache() = default;
+
+        //! @brief Returns the directory of the files.
+        inline std::string const& getDirectory() const noexcept { return m_directory; }
+
+        //! @brief The revision of the cache.
+        //! @details The revision must be incremented when the computation of a decoding
+        //! matrix changes, so the files computed before are ignored.
+        static constexpr uint32_t revision() noexcept { return 1u; }
+
+        //! @brief Computes the key of a decoder.
+        //! @param decoder The decoder.
+        //! @param settings The optional settings that change the matrix.
+        //! @param nsettings The number of settings.
+        template <class Decoder>
+        static uint64_t hash(Decoder const& decoder, const T* settings = nullptr, const size_t nsettings = 0) noexcept
+        {
+            uint64_t key = fnv(offset(), revision());
+            key = fnv(key, uint32_t(D));
+            key = fnv(key, uint32_t(sizeof(T)));
+            key = fnv(key, uint32_t(decoder.getMode()));
+            key = fnv(key, uint64_t(decoder.getDecompositionOrder()));
+            key = fnv(key, uint64_t(decoder.getNumberOfPlanewaves()));
+            if(decoder.isMixedOrder())
+            {
+                key = fnv(key, uint64_t(decoder.getVerticalOrder()));
+            }
+            for(size_t i = 0; i < decoder.getNumberOfPlanewaves(); ++i)
+            {
+                key = fnv(key, decoder.getPlanewaveAzimuth(i));
+                key = fnv(key, decoder.getPlanewaveElevation(i));
+            }
+            key = parameters(key, decoder, 0);
+            for(size_t i = 0; i < nsettings; ++i)
+            {
+                key = fnv(key, settings[i]);
+            }
+            return key;
+        }
+
+        //! @brief Returns the path of the file of a key.
+        std::string getPath(const uint64_t key) const
+        {
+            char name[32];
+            std::snprintf(name, sizeof(name), "%016llx.hoamat", static_cast<unsigned long long>(key));
+            if(m_directory.empty())
+            {
+                return std::string(name);
+            }
+            const char last = m_directory.back();
+            return (last == '/' || last == '\\') ? m_directory + name : m_directory + "/" + name;
+        }
+
+        //! @brief Loads the matrix of a decoder or prepares the decoder and stores its matrix.
+        //! @param decoder The decoder.
+        //! @param vectorsize The vector size for the block decoding.
+        //! @param settings The optional settings that change the matrix.
+        //! @param nsettings The number of settings.
+        //! @return true if the matrix has been loaded, false if the decoder has been prepared.
+        template <class Decoder>
+        bool prepare(Decoder& decoder, const size_t vectorsize = 64, const T* settings = nullptr, const size_t nsettings = 0)
+        {
+            const uint64_t key = hash(decoder, settings, nsettings);
+            if(load(key, decoder, vectorsize))
+            {
+                return true;
+            }
+            decoder.prepare(vectorsize);
+            store(key, decoder.getNumberOfPlanewaves(), decoder.getNumberOfHarmonics(), decoder.getMatrix());
+            return false;
+        }
+
+        //! @brief Loads the matrix of a decoder from the file of a key.
+        //! @param key The key of the decoder.
+        //! @param decoder The decoder.
+        //! @param vectorsize The vector size for the block decoding.
+        //! @return true if the file is valid and the matrix has been loaded.
+        template <class Decoder>
+        bool load(const uint64_t key, Decoder& decoder, const size_t vectorsize = 64) const
+        {
+            const size_t rows = decoder.getNumberOfPlanewaves();
+            const size_t columns = decoder.getNumberOfHarmonics();
+            File file(getPath(key));
+            if(!file.data() || file.size() != sizeof(Header) + rows * columns * sizeof(T))
+            {
+                return false;
+            }
+            Header header;
+            std::memcpy(&header, file.data(), sizeof(Header));
+            const char* payload = file.data() + sizeof(Header);
+            if(std::memcmp(header.magic, magic(), 4) || header.revision != revision()
+               || header.dimension != uint32_t(D) || header.scalar != uint32_t(sizeof(T))
+               || header.key != key || header.rows != rows || header.columns != columns
+               || header.checksum != checksum(payload, rows * columns * sizeof(T)))
+            {
+                return false;
+            }
+            decoder.setMatrix(reinterpret_cast<const T*>(payload), vectorsize);
+            return true;
+        }
+
+        //! @brief Stores a matrix in the file of a key.
+        //! @param key The key of the decoder.
+        //! @param rows The number of plane waves.
+        //! @param columns The number of harmonics.
+        //! @param matrix The decoding matrix.
+        //! @return true if the file has been written.
+        bool store(const uint64_t key, const size_t rows, const size_t columns, const T* matrix) const
+        {
+            const size_t size = rows * columns * sizeof(T);
+            Header header;
+            std::memcpy(header.magic, magic(), 4);
+            header.revision  = revision();
+            header.dimension = uint32_t(D);
+            header.scalar    = uint32_t(sizeof(T));
+            header.key       = key;
+            header.rows      = rows;
+            header.columns   = columns;
+            header.checksum  = checksum(reinterpret_cast<const char*>(matrix), size);
+
+            const std::string path = getPath(key);
+            const std::string temp = path + "." + std::to_string(process()) + "."
+                                   + std::to_string(counter().fetch_add(1ul)) + ".tmp";
+            {
+                std::ofstream stream(temp, std::ios::binary | std::ios::trunc);
+                stream.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+                stream.write(reinterpret_cast<const char*>(matrix), std::streamsize(size));
+                if(!stream.good())
+                {
+                    stream.close();
+                    std::remove(temp.c_str());
+                    return false;
+                }
+            }
+#ifdef _WIN32
+            // rename doesn't replace an existing file on Windows
+            std::remove(path.c_str());
+#endif
+            if(std::rename(temp.c_str(), path.c_str()) != 0)
+            {
+                std::remove(temp.c_str());
+                return false;
+            }
+            return true;
+        }
+
+    private:
+
+        struct Header
+        {
+            char        magic[4];
+            uint32_t    revision;
+            uint32_t    dimension;
+            uint32_t    scalar;
+            uint64_t    key;
+            uint64_t    rows;
+            uint64_t    columns;
+            uint64_t    checksum;
+        };
+
+        //! @brief A read-only view of a file.
+        class File
+        {
+        public:
+#ifndef _WIN32
+            File(std::string const& path)
+            {
+                const int descriptor = ::open(path.c_str(), O_RDONLY);
+                if(descriptor < 0) { return; }
+                struct stat info;
+                if(::fstat(descriptor, &info) == 0 && info.st_size > 0)
+                {
+                    void* data = ::mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+                    if(data != MAP_FAILED)
+                    {
+                        m_data = static_cast<const char*>(data);
+                        m_size = size_t(info.st_size);
+                    }
+                }
+                ::close(descriptor);
+            }
+
+            ~File()
+            {
+                if(m_data) { ::munmap(const_cast<char*>(m_data), m_size); }
+            }
+#else
+            File(std::string const& path)
+            {
+                std::ifstream stream(path, std::ios::binary | std::ios::ate);
+                if(!stream.good()) { return; }
+                m_buffer.resize(size_t(stream.tellg()));
+                stream.seekg(0);
+                if(stream.read(m_buffer.data(), std::streamsize(m_buffer.size())) && !m_buffer.empty())
+                {
+                    m_data = m_buffer.data();
+                    m_size = m_buffer.size();
+                }
+            }
+
+            ~File() = default;
+#endif
+            File(File const&) = delete;
+            File& operator=(File const&) = delete;
+
+            inline const char* data() const noexcept { return m_data; }
+            inline size_t size() const noexcept { return m_size; }
+
+        private:
+            const char*         m_data = nullptr;
+            size_t              m_size = 0ul;
+#ifdef _WIN32
+            std::vector<char>   m_buffer {};
+#endif
+        };
+
+        static inline const char* magic() noexcept { return "HOAM"; }
+
+        //! @brief Hashes the regularization of the decoders that have one.
+        template <class Decoder>
+        static inline auto parameters(const uint64_t key, Decoder const& decoder, int) noexcept
+        -> decltype(decoder.getRegularization(), uint64_t())
+        {
+            return fnv(key, decoder.getRegularization());
+        }
+
+        //! @brief Leaves the key of the decoders without parameters.
+        template <class Decoder>
+        static inline uint64_t parameters(const uint64_t key, Decoder const&, long) noexcept
+        {
+            return key;
+        }
+
+        //! @brief Returns the identifier of the process.
+        static inline long process() noexcept
+        {
+#ifndef _WIN32
+            return long(::getpid());
+#else
+            return long(::_getpid());
+#endif
+        }
+
+        //! @brief Returns the counter of the temporary files of the process.
+        static inline std::atomic<unsigned long>& counter() noexcept
+        {
+            static std::atomic<unsigned long> count(0ul);
+            return count;
+        }
+
+        static constexpr uint64_t offset() noexcept { return 14695981039346656037ull; }
+
+        //! @brief Hashes the bytes of a value with the FNV-1a function.
+        template <typename V>
+        static inline uint64_t fnv(uint64_t key, const V value) noexcept
+        {
+            unsigned char bytes[sizeof(V)];
+            std::memcpy(bytes, &value, sizeof(V));
+            for(auto byte : bytes)
+            {
+                key = (key ^ uint64_t(byte)) * 1099511628211ull;
+            }
+            return key;
+        }
+
+        //! @brief Computes the checksum of the matrix.
+        //! @details The bytes are hashed by words of 64 bits with the FNV-1a function.
+        static uint64_t checksum(const char* data, const size_t size) noexcept
+        {
+            uint64_t key = offset();
+            size_t i = 0;
+            for(; i + 8 <= size; i += 8)
+            {
+                uint64_t word;
+                std::memcpy(&word, data + i, 8);
+                key = (key ^ word) * 1099511628211ull;
+            }
+            for(; i < size; ++i)
+            {
+                key = (key ^ uint64_t(static_cast<unsigned char>(data[i]))) * 1099511628211ull;
+            }
+            return key;
+        }
+
+        std::string m_directory;
+    };
+}
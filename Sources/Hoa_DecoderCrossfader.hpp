@@ -0,0 +1,225 @@
+/*
+// Copyright (c) 2012-2017 CICM - Universite Paris 8 - Labex Arts H2H.
+// Authors :
+// 2012: Pierre Guillot, Eliott Paris & Julien Colafrancesco.
+// 2012-2015: Pierre Guillot & Eliott Paris.
+// 2015: Pierre Guillot & Eliott Paris & Thomas Le Meur (Light version)
+// 2016-2017: Pierre Guillot.
+// For information on usage and redistribution, and for a DISCLAIMER OF ALL
+// WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+*/
+
+#pragma once
+
+#include "Hoa_Decoder.hpp"
+
+#include <atomic>
+
+namespace hoa
+{
+    // ================================================================================ //
+    // DECODER CROSSFADER //
+    // ================================================================================ //
+
+    //! @brief The class decodes with a matrix that can be replaced while processing.
+    //! @details The decoders compute their matrix in place, so changing the loudspeakers
+    //! and calling the prepare method while the audio thread decodes leads to races and to
+    //! discontinuities. The crossfader separates the two: a decoder is edited and prepared
+    //! by a control thread, its matrix is published to the crossfader, and the audio thread
+    //! decodes with the crossfader that fades from the previous matrix to the new one over
+    //! a number of samples.<br>
+    //! The crossfader owns four matrices: two for the audio thread (the current one and the
+    //! one fading out), one for the control thread and one exchanged between the threads
+    //! with an atomic index. The publish method can be called from a single control thread
+    //! and the process methods don't allocate memory nor lock. A matrix published during a
+    //! crossfade is taken at the end of the crossfade and only the last published matrix is
+    //! kept.
+    template <Dimension D, typename T>
+    class DecoderCrossfader
+    : public ProcessorHarmonics<D, T>
+    {
+    public:
+
+        //! @brief Constructor.
+        //! @param order The order.
+        //! @param nplws The number of plane waves.
+        //! @param vectorsize The vector size of the block processing.
+        DecoderCrossfader(const size_t order, const size_t nplws, const size_t vectorsize = 64)
+        : ProcessorHarmonics<D, T>(order)
+        , m_number_of_planewaves(nplws)
+        , m_vector_size(vectorsize)
+        , m_temp(nplws * vectorsize)
+        , m_temp_channels(nplws)
+        {
+            const size_t nharm = ProcessorHarmonics<D, T>::getNumberOfHarmonics();
+            for(auto& slot : m_slots)
+            {
+                slot.matrix.resize(nplws * nharm);
+                slot.packed.resize(Signal<T>::packsize(nharm, nplws));
+            }
+            for(size_t i = 0; i < nplws; ++i)
+            {
+                m_temp_channels[i] = m_temp.data() + i * vectorsize;
+            }
+        }
+
+        //! @brief Destructor.
+        ~DecoderCrossfader() = default;
+
+        //! @brief Returns the number of plane waves.
+        inline size_t getNumberOfPlanewaves() const noexcept { return m_number_of_planewaves; }
+
+        //! @brief Returns the vector size of the block processing.
+        inline size_t getVectorSize() const noexcept { return m_vector_size; }
+
+        //! @brief Sets the number of samples of the crossfades.
+        //! @details The method can be called from the control thread, the length is used by
+        //! the next crossfade.
+        //! @param nsamples The number of samples (0 means no crossfade).
+        inline void setFadeLength(const size_t nsamples) noexcept { m_fade_length.store(nsamples); }
+
+        //! @brief Returns the number of samples of the crossfades.
+        inline size_t getFadeLength() const noexcept { return m_fade_length.load(); }
+
+        //! @brief Returns true if the decoder is fading between two matrices.
+        //! @details The method must be called from the audio thread.
+        inline bool isFading() const noexcept { return m_fade_size != 0; }
+
+        //! @brief Publishes a new decoding matrix.
+        //! @details The matrix is copied, it must be stored row by row with a row for each
+        //! plane wave and a column for each harmonic. The method must be called from the
+        //! control thread. The first matrix is used without crossfade.
+        //! @param matrix The decoding matrix.
+        void publish(const T* matrix) noexcept
+        {
+            const size_t nharm = ProcessorHarmonics<D, T>::getNumberOfHarmonics();
+            Slot& slot = m_slots[m_back];
+            Signal<T>::copy(m_number_of_planewaves * nharm, matrix, slot.matrix.data());
+            Signal<T>::pack(nharm, m_number_of_planewaves, matrix, slot.packed.data());
+            m_back = m_middle.exchange(m_back | fresh(), std::memory_order_acq_rel) & mask();
+        }
+
+        //! @brief Publishes the matrix of a decoder.
+        //! @details The decoder must have the same order and the same number of plane waves
+        //! and must have been prepared.
+        //! @param decoder The decoder.
+        template <class Decoder>
+        inline void publish(Decoder const& decoder) noexcept
+        {
+            assert((decoder.getNumberOfHarmonics() == ProcessorHarmonics<D, T>::getNumberOfHarmonics()));
+            assert(decoder.getNumberOfPlanewaves() == m_number_of_planewaves);
+            publish(decoder.getMatrix());
+        }
+
+        //! @brief The method performs the decoding of the harmonics signal.
+        //! @details The method must be called from the audio thread.
+        //! @param inputs  The inputs array.
+        //! @param outputs The outputs array.
+        void process(const T* inputs, T* outputs) noexcept override
+        {
+            const size_t nharm = ProcessorHarmonics<D, T>::getNumberOfHarmonics();
+            const size_t nplws = m_number_of_planewaves;
+            acquire();
+            Signal<T>::mul(nharm, nplws, inputs, m_slots[m_current].matrix.data(), outputs);
+            if(m_fade_size)
+            {
+                T* temp = m_temp.data();
+                Signal<T>::mul(nharm, nplws, inputs, m_slots[m_previous].matrix.data(), temp);
+                ++m_fade_position;
+                const T gain = T(m_fade_position) / T(m_fade_size);
+                for(size_t i = 0; i < nplws; ++i)
+                {
+                    outputs[i] = temp[i] + (outputs[i] - temp[i]) * gain;
+                }
+                if(m_fade_position >= m_fade_size)
+                {
+                    m_fade_size = 0;
+                }
+            }
+        }
+
+        //! @brief The method performs the decoding of a block of harmonics signals.
+        //! @details The method must be called from the audio thread, the outputs must not
+        //! share memory with the inputs.
+        //! @param inputs  The inputs channels.
+        //! @param outputs The outputs channels.
+        void processBlock(const T** inputs, T** outputs) noexcept
+        {
+            const size_t nharm = ProcessorHarmonics<D, T>::getNumberOfHarmonics();
+            const size_t nplws = m_number_of_planewaves;
+            const size_t vsize = m_vector_size;
+            acquire();
+            Signal<T>::mul(nharm, nplws, vsize, m_slots[m_current].packed.data(), inputs, outputs);
+            if(m_fade_size)
+            {
+                Signal<T>::mul(nharm, nplws, vsize, m_slots[m_previous].packed.data(), inputs, m_temp_channels.data());
+                const T step = T(1) / T(m_fade_size);
+                for(size_t i = 0; i < nplws; ++i)
+                {
+                    const T* temp = m_temp_channels[i];
+                    T* output = outputs[i];
+                    size_t position = m_fade_position;
+                    for(size_t j = 0; j < vsize && position < m_fade_size; ++j)
+                    {
+                        ++position;
+                        output[j] = temp[j] + (output[j] - temp[j]) * (T(position) * step);
+                    }
+                }
+                m_fade_position += vsize;
+                if(m_fade_position >= m_fade_size)
+                {
+                    m_fade_size = 0;
+                }
+            }
+        }
+
+    private:
+
+        struct Slot
+        {
+            std::vector<T> matrix;
+            std::vector<T> packed;
+        };
+
+        //! @brief The flag of the exchanged index that marks a new matrix.
+        static constexpr unsigned fresh() noexcept { return 4u; }
+
+        //! @brief The mask of the exchanged index.
+        static constexpr unsigned mask() noexcept { return 3u; }
+
+        //! @brief Takes the last published matrix if the audio thread isn't fading.
+        inline void acquire() noexcept
+        {
+            if(!m_fade_size && (m_middle.load(std::memory_order_relaxed) & fresh()))
+            {
+                const unsigned previous = m_current;
+                m_current = m_middle.exchange(m_previous, std::memory_order_acq_rel) & mask();
+                m_previous = previous;
+                if(m_started)
+                {
+                    m_fade_size = m_fade_length.load(std::memory_order_relaxed);
+                    m_fade_position = 0;
+                }
+                m_started = true;
+            }
+        }
+
+        const size_t            m_number_of_planewaves;
+        const size_t            m_vector_size;
+        Slot                    m_slots[4] {};
+        std::vector<T>          m_temp;
+        std::vector<T*>         m_temp_channels;
+        std::atomic<size_t>     m_fade_length {0ul};
+        std::atomic<unsigned>   m_middle {2u};
+
+        // Owned by the control thread
+        unsigned                m_back = 3u;
+
+        // Owned by the audio thread
+        unsigned                m_current = 0u;
+        unsigned                m_previous = 1u;
+        size_t                  m_fade_size = 0ul;
+        size_t                  m_fade_position = 0ul;
+        bool                    m_started = false;
+    };
+}
@@ -0,0 +1,187 @@
+/*
+// Copyright (c) 2012-2017 CICM - Universite Paris 8 - Labex Arts H2H.
+// Authors :
+// 2012: Pierre Guillot, Eliott Paris & Julien Colafrancesco.
+// 2012-2015: Pierre Guillot & Eliott Paris.
+// 2015: Pierre Guillot & Eliott Paris & Thomas Le Meur (Light version)
+// 2016-2017: Pierre Guillot.
+// For information on usage and redistribution, and for a DISCLAIMER OF ALL
+// WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+*/
+
+#pragma once
+
+#include "Hoa_DecoderCrossfader.hpp"
+#include "Hoa_Optim.hpp"
+
+#include <numeric>
+
+namespace hoa
+{
+    // ================================================================================ //
+    // DECODER ZONES //
+    // ================================================================================ //
+
+    //! @brief The class decodes the same harmonics for several loudspeaker arrays.
+    //! @details When the same harmonics feed several arrays (the zones), decoding each zone
+    //! separately reads the harmonics once per zone. The class stacks the matrices of all
+    //! the zones in one matrix, each zone weighted by its own optimization, and decodes all
+    //! the zones with one block matrix product. The outputs of the zones are stacked in the
+    //! zone order, getZoneOffset() returns the index of the first output of a zone. A
+    //! binaural monitor can be fed by a zone of virtual loudspeakers.<br>
+    //! The matrices and the optimizations are changed from a control thread, the stacked
+    //! matrix is then published and crossfaded by the audio thread like the
+    //! DecoderCrossfader, the zones that didn't change are not affected by the crossfade.
+    template <Dimension D, typename T>
+    class DecoderZones
+    : public ProcessorHarmonics<D, T>
+    {
+    public:
+
+        //! @brief Constructor.
+        //! @param order The order.
+        //! @param nplws The number of plane waves of each zone.
+        //! @param vectorsize The vector size of the block processing.
+        DecoderZones(const size_t order, std::vector<size_t> const& nplws, const size_t vectorsize = 64)
+        : ProcessorHarmonics<D, T>(order)
+        , m_crossfader(order, std::accumulate(nplws.begin(), nplws.end(), size_t(0)), vectorsize)
+        , m_optim(order)
+        , m_matrices(m_crossfader.getNumberOfPlanewaves() * ProcessorHarmonics<D, T>::getNumberOfHarmonics())
+        , m_stacked(m_matrices.size())
+        {
+            const size_t nharm = ProcessorHarmonics<D, T>::getNumberOfHarmonics();
+            size_t offset = 0;
+            m_zones.reserve(nplws.size());
+            for(auto size : nplws)
+            {
+                Zone zone;
+                zone.offset = offset;
+                zone.size   = size;
+                zone.weights.assign(nharm, T(1));
+                m_zones.push_back(std::move(zone));
+                offset += size;
+            }
+        }
+
+        //! @brief Destructor.
+        ~DecoderZones() = default;
+
+        //! @brief Returns the number of zones.
+        inline size_t getNumberOfZones() const noexcept { return m_zones.size(); }
+
+        //! @brief Returns the number of plane waves of a zone.
+        inline size_t getNumberOfPlanewaves(const size_t zone) const noexcept { return m_zones[zone].size; }
+
+        //! @brief Returns the number of plane waves of all the zones.
+        inline size_t getNumberOfPlanewaves() const noexcept { return m_crossfader.getNumberOfPlanewaves(); }
+
+        //! @brief Returns the index of the first output of a zone.
+        inline size_t getZoneOffset(const size_t zone) const noexcept { return m_zones[zone].offset; }
+
+        //! @brief Returns the vector size of the block processing.
+        inline size_t getVectorSize() const noexcept { return m_crossfader.getVectorSize(); }
+
+        //! @brief Sets the number of samples of the crossfades.
+        //! @param nsamples The number of samples (0 means no crossfade).
+        inline void setFadeLength(const size_t nsamples) noexcept { m_crossfader.setFadeLength(nsamples); }
+
+        //! @brief Returns the number of samples of the crossfades.
+        inline size_t getFadeLength() const noexcept { return m_crossfader.getFadeLength(); }
+
+        //! @brief Sets the decoding matrix of a zone and publishes the stacked matrix.
+        //! @details The matrix is copied, it must be stored row by row with a row for each
+        //! plane wave of the zone and a column for each harmonic. The method must be called
+        //! from the control thread.
+        //! @param zone The index of the zone.
+        //! @param matrix The decoding matrix.
+        void setMatrix(const size_t zone, const T* matrix) noexcept
+        {
+            const size_t nharm = ProcessorHarmonics<D, T>::getNumberOfHarmonics();
+            Zone const& z = m_zones[zone];
+            Signal<T>::copy(z.size * nharm, matrix, m_matrices.data() + z.offset * nharm);
+            publish(zone);
+        }
+
+        //! @brief Sets the matrix of a decoder to a zone and publishes the stacked matrix.
+        //! @details The decoder must have the same order and the same number of plane waves
+        //! as the zone and must have been prepared.
+        //! @param zone The index of the zone.
+        //! @param decoder The decoder.
+        template <class Decoder>
+        inline void setDecoder(const size_t zone, Decoder const& decoder) noexcept
+        {
+            assert((decoder.getNumberOfHarmonics() == ProcessorHarmonics<D, T>::getNumberOfHarmonics()));
+            assert(decoder.getNumberOfPlanewaves() == m_zones[zone].size);
+            setMatrix(zone, decoder.getMatrix());
+        }
+
+        //! @brief Sets the optimization of a zone and publishes the stacked matrix.
+        //! @details The method must be called from the control thread.
+        //! @param zone The index of the zone.
+        //! @param mode The optimization mode (default is basic).
+        void setMode(const size_t zone, typename Optim<D, T>::Mode mode) noexcept
+        {
+            m_optim.setMode(mode);
+            Zone& z = m_zones[zone];
+            Signal<T>::copy(z.weights.size(), m_optim.getWeights(), z.weights.data());
+            z.mode = mode;
+            publish(zone);
+        }
+
+        //! @brief Returns the optimization mode of a zone.
+        inline typename Optim<D, T>::Mode getMode(const size_t zone) const noexcept { return m_zones[zone].mode; }
+
+        //! @brief The method performs the decoding of all the zones.
+        //! @details The method must be called from the audio thread.
+        //! @param inputs  The inputs array.
+        //! @param outputs The outputs array of all the zones.
+        inline void process(const T* inputs, T* outputs) noexcept override
+        {
+            m_crossfader.process(inputs, outputs);
+        }
+
+        //! @brief The method performs the decoding of a block for all the zones.
+        //! @details The method must be called from the audio thread, the outputs must not
+        //! share memory with the inputs.
+        //! @param inputs  The inputs channels.
+        //! @param outputs The outputs channels of all the zones.
+        inline void processBlock(const T** inputs, T** outputs) noexcept
+        {
+            m_crossfader.processBlock(inputs, outputs);
+        }
+
+    private:
+
+        struct Zone
+        {
+            size_t                      offset = 0ul;
+            size_t                      size = 0ul;
+            std::vector<T>              weights {};
+            typename Optim<D, T>::Mode  mode = Optim<D, T>::Basic;
+        };
+
+        //! @brief Weights the rows of a zone and publishes the stacked matrix.
+        void publish(const size_t zone) noexcept
+        {
+            const size_t nharm = ProcessorHarmonics<D, T>::getNumberOfHarmonics();
+            Zone const& z = m_zones[zone];
+            const T* weights = z.weights.data();
+            for(size_t i = z.offset; i < z.offset + z.size; ++i)
+            {
+                const T* row = m_matrices.data() + i * nharm;
+                T* stacked = m_stacked.data() + i * nharm;
+                for(size_t j = 0; j < nharm; ++j)
+                {
+                    stacked[j] = row[j] * weights[j];
+                }
+            }
+            m_crossfader.publish(static_cast<const T*>(m_stacked.data()));
+        }
+
+        DecoderCrossfader<D, T> m_crossfader;
+        Optim<D, T>             m_optim;
+        std::vector<Zone>       m_zones {};
+        std::vector<T>          m_matrices;
+        std::vector<T>          m_stacked;
+    };
+}
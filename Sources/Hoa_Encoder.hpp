@@ -75,7 +75,20 @@ namespace hoa
         //! @brief Constructor.
         //! @param order The order of decomposition.
         Encoder(const size_t order)
-        : ProcessorHarmonics<D, T>(order)
+        : Encoder(order, order)
+        {
+            ;
+        }
+
+        //! @brief Constructor for a mixed order.
+        //! @details The encoder only computes the harmonics of the mixed order: the
+        //! associated Legendre polynomials are computed up to the vertical order and only the
+        //! horizontal polynomials \f$P_{l, l}\f$ are computed above (the vertical order is
+        //! ignored in 2D).
+        //! @param order The horizontal order of decomposition.
+        //! @param vertical The vertical order of decomposition.
+        Encoder(const size_t order, const size_t vertical)
+        : ProcessorHarmonics<D, T>(order, vertical)
         , m_radius_coeffs(order+1)
         , m_azimuth_coeffs(order*2+1+2)
         , m_elevation_coeffs(((order + 1) * (order + 1)) / 2 + (order + 1)+3)
@@ -89,6 +102,20 @@ namespace hoa
             {
                 m_normalization_coeffs[i] = ProcessorHarmonics<D, T>::getHarmonicSemiNormalization(i) * std::pow(static_cast<T>(-1), static_cast<T>(ProcessorHarmonics<D, T>::getHarmonicOrder(i)));
             }
+            if(ProcessorHarmonics<D, T>::isMixedOrder())
+            {
+                for(size_t i = 0; i < ProcessorHarmonics<D, T>::getNumberOfHarmonics(); ++i)
+                {
+                    const size_t degree = ProcessorHarmonics<D, T>::getHarmonicDegree(i);
+                    const long azimuthal = ProcessorHarmonics<D, T>::getHarmonicOrder(i);
+                    Mixed mixed;
+                    mixed.degree    = degree;
+                    mixed.azimuth   = size_t(long(order) + azimuthal);
+                    mixed.elevation = degree * (degree + 1) / 2 + degree - size_t(std::abs(azimuthal));
+                    mixed.odd       = (std::abs(azimuthal) % 2) != 0;
+                    m_mixed.push_back(mixed);
+                }
+            }
         }
 
         //! Destructor.
@@ -192,7 +219,79 @@ namespace hoa
         {
             m_elevation = math<T>::wrap_pi(elevation);
             const size_t order = ProcessorHarmonics<D, T>::getDecompositionOrder();
-            const T _x      = std::sin(elevation);
+            const size_t vertical = ProcessorHarmonics<D, T>::getVerticalOrder();
+            const T _x = std::sin(elevation);
+            computeLegendre(vertical, _x);
+            if(vertical < order)
+            {
+                // P(l+1, l+1)(x) = -(2l+1)sqrt(1-x^2)P(l,l)(x) stored at l(l+1)/2
+                const T _x_sqpm = std::sqrt(static_cast<T>(1) - _x * _x);
+                T* coeffs = m_elevation_coeffs.data();
+                for(size_t l = std::max(vertical + 1, size_t(2)); l <= order; ++l)
+                {
+                    coeffs[l * (l + 1) / 2] = -static_cast<T>(2 * l - 1) * _x_sqpm * coeffs[(l - 1) * l / 2];
+                }
+            }
+        }
+    
+        //! @brief The method performs the encoding of the harmonics signal.
+        //! @details The input pointer must be the sample to encode and the outputs array
+        //! contains the spherical harmonics samples thus the minimum size of the array must
+        //! be the number of harmonics.
+        //! @param input   The input pointer.
+        //! @param outputs The outputs array.
+        void process(const T* input, T* outputs) noexcept override
+        {
+            if(D == Hoa3d && !m_mixed.empty())
+            {
+                processMixed(input, outputs);
+            }
+            else
+            {
+                processFull(input, outputs);
+            }
+        }
+        
+        //! @brief The method computes the harmonics of a set of directions.
+        //! @details For each direction, the method computes the spherical harmonics of a
+        //! unitary signal encoded as a plane wave (the radius is set to 1) and writes them in a
+        //! row of the outputs matrix, thus the minimum size of the matrix must be the number
+        //! of directions by the number of harmonics. The elevations are ignored in 2d and the
+        //! encoder keeps the coordinates of the last direction.
+        //! @param ndirections  The number of directions.
+        //! @param azimuths     The azimuths of the directions.
+        //! @param elevations   The elevations of the directions.
+        //! @param outputs      The outputs matrix.
+        void processDirections(const size_t ndirections, const T* azimuths, const T* elevations, T* outputs) noexcept
+        {
+            const size_t nharmos = ProcessorHarmonics<D, T>::getNumberOfHarmonics();
+            const T unit = static_cast<T>(1);
+            setRadius(unit);
+            for(size_t i = 0; i < ndirections; ++i, outputs += nharmos)
+            {
+                setAzimuth(azimuths[i]);
+                if(D == Hoa3d)
+                {
+                    setElevation(elevations[i]);
+                }
+                process(&unit, outputs);
+            }
+        }
+        
+    private:
+        
+        //! @brief The offsets of the coefficients of an harmonic of a mixed order.
+        struct Mixed
+        {
+            size_t  degree;
+            size_t  azimuth;
+            size_t  elevation;
+            bool    odd;
+        };
+        
+        //! @brief Computes the associated Legendre polynomials up to an order.
+        void computeLegendre(const size_t order, const T _x) noexcept
+        {
             const T _x_pow  = _x * _x;                    // x^2
             const T _x_powm = static_cast<T>(1) - _x_pow; // 1 - x^2
             const T _x_sqpm = std::sqrt(_x_powm);         // sqrt(1 - x^2)
@@ -255,14 +354,26 @@ namespace hoa
             }
         
         }
-    
-        //! @brief The method performs the encoding of the harmonics signal.
-        //! @details The input pointer must be the sample to encode and the outputs array
-        //! contains the spherical harmonics samples thus the minimum size of the array must
-        //! be the number of harmonics.
-        //! @param input   The input pointer.
-        //! @param outputs The outputs array.
-        void process(const T* input, T* outputs) noexcept override
+        
+        //! @brief Encodes the harmonics of a mixed order with the offsets of the coefficients.
+        void processMixed(const T* input, T* outputs) noexcept
+        {
+            const bool flip = !(m_elevation >= static_cast<T>(-HOA_PI2) && m_elevation <= static_cast<T>(HOA_PI2));
+            T const* radius_coeffs      = m_radius_coeffs.data();
+            T const* azimuth_coeffs     = m_azimuth_coeffs.data();
+            T const* elevation_coeffs   = m_elevation_coeffs.data();
+            T const* norm_coeffs        = m_normalization_coeffs.data();
+            for(size_t i = 0; i < m_mixed.size(); ++i)
+            {
+                Mixed const& mixed = m_mixed[i];
+                const T value = (*input) * radius_coeffs[mixed.degree] * azimuth_coeffs[mixed.azimuth]
+                * elevation_coeffs[mixed.elevation] * norm_coeffs[i];
+                outputs[i] = (flip && mixed.odd) ? -value : value;
+            }
+        }
+        
+        //! @brief Encodes all the harmonics.
+        void processFull(const T* input, T* outputs) noexcept
         {
             if(D == Hoa2d)
             {
@@ -314,8 +425,6 @@ namespace hoa
             
         }
         
-    private:
-        
         T m_radius = 0.;
         T m_azimuth = 0.;
         T m_elevation = 0.;
@@ -323,5 +432,6 @@ namespace hoa
         std::vector<T> m_azimuth_coeffs {};
         std::vector<T> m_elevation_coeffs {};
         std::vector<T> m_normalization_coeffs {};
+        std::vector<Mixed> m_mixed {};
     };
 }
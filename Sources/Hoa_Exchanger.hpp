@@ -478,6 +478,18 @@ namespace hoa
             m_harmonics = Signal<T>::alloc(order*2+1);
         }
 
+        //! The exchanger constructor for a mixed order.
+        /**	The exchanger constructor for a mixed order. The channels of a mixed order only support the ACN numbering and the N3D normalization, the other conversions are ignored. The channels can be expanded to the full order and contracted from the full order.
+         @param     order	The horizontal order.
+         @param     vertical	The vertical order.
+         */
+        inline Exchanger(const size_t order, const size_t vertical) noexcept : ProcessorHarmonics<Hoa3d, T>(order, vertical),
+        m_numbering(ACN),
+        m_normalization(SN3D)
+        {
+            m_harmonics = Signal<T>::alloc(order*2+1);
+        }
+
         //! The exchanger destructor.
         /**	The exchanger destructor free the memory.
          */
@@ -565,6 +577,22 @@ namespace hoa
          */
         void process(T const* inputs, T* outputs) noexcept
         {
+            if(ProcessorHarmonics<Hoa3d, T>::isMixedOrder())
+            {
+                if(m_normalization == fromN3D)
+                {
+                    normalizeFromN3D(inputs, outputs);
+                }
+                else if(m_normalization == toN3D)
+                {
+                    normalizeToN3D(inputs, outputs);
+                }
+                else
+                {
+                    Signal<T>::copy(ProcessorHarmonics<Hoa3d, T>::getNumberOfHarmonics(), inputs, outputs);
+                }
+                return;
+            }
             T const* ins = inputs;
             if(m_numbering == fromFurseMalham)
             {
@@ -815,6 +843,15 @@ namespace hoa
          */
         void normalizeFromN3D(T const* inputs, T* outputs) noexcept
         {
+            if(ProcessorHarmonics<Hoa3d, T>::isMixedOrder())
+            {
+                for(size_t i = 0; i < ProcessorHarmonics<Hoa3d, T>::getNumberOfHarmonics(); i++)
+                {
+                    const size_t degree = ProcessorHarmonics<Hoa3d, T>::getHarmonicDegree(i);
+                    outputs[i] = inputs[i] * T(sqrt(2. * T(degree) + 1.));
+                }
+                return;
+            }
             T norm = T(sqrt(3.));
             *(outputs++) = *(inputs++);
             *(outputs++) = *(inputs++) * norm;
@@ -837,6 +874,15 @@ namespace hoa
          */
         void normalizeToN3D(T const* inputs, T* outputs) noexcept
         {
+            if(ProcessorHarmonics<Hoa3d, T>::isMixedOrder())
+            {
+                for(size_t i = 0; i < ProcessorHarmonics<Hoa3d, T>::getNumberOfHarmonics(); i++)
+                {
+                    const size_t degree = ProcessorHarmonics<Hoa3d, T>::getHarmonicDegree(i);
+                    outputs[i] = inputs[i] * T(1. / sqrt(2. * T(degree) + 1.));
+                }
+                return;
+            }
             T norm = T(1. / sqrt(3.));
             *(outputs++) = *(inputs++);
             *(outputs++) = *(inputs++) * norm;
@@ -852,6 +898,33 @@ namespace hoa
             }
         }
         
+        //! This method expands the channels of a mixed order to the channels of the full order.
+        /**	You should use this method for not-in-place processing and sample by sample. The inputs array contains the harmonics of the mixed order and the outputs array contains the harmonics of the full order in ACN, the harmonics that don't belong to the mixed order are set to zero.
+         @param     inputs   The inputs array.
+         @param     outputs  The outputs array.
+         */
+        void expand(T const* inputs, T* outputs) const noexcept
+        {
+            Signal<T>::clear(Harmonic<Hoa3d, T>::getNumberOfHarmonics(ProcessorHarmonics<Hoa3d, T>::getDecompositionOrder()), outputs);
+            for(size_t i = 0; i < ProcessorHarmonics<Hoa3d, T>::getNumberOfHarmonics(); i++)
+            {
+                outputs[ProcessorHarmonics<Hoa3d, T>::getHarmonicAcn(i)] = inputs[i];
+            }
+        }
+
+        //! This method contracts the channels of the full order to the channels of a mixed order.
+        /**	You should use this method for in-place or not-in-place processing and sample by sample. The inputs array contains the harmonics of the full order in ACN and the outputs array contains the harmonics of the mixed order.
+         @param     inputs   The inputs array.
+         @param     outputs  The outputs array.
+         */
+        void contract(T const* inputs, T* outputs) const noexcept
+        {
+            for(size_t i = 0; i < ProcessorHarmonics<Hoa3d, T>::getNumberOfHarmonics(); i++)
+            {
+                outputs[i] = inputs[ProcessorHarmonics<Hoa3d, T>::getHarmonicAcn(i)];
+            }
+        }
+
         //! Retrieve the harmonic order of an input depending on the current numbering configuration.
         /** Retrieve the harmonic order of an input depending on the current numbering configuration.
          @param     index	The index of an harmonic.
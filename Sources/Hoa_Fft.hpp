@@ -0,0 +1,297 @@
+/*
+// Copyright (c) 2012-2017 CICM - Universite Paris 8 - Labex Arts H2H.
+// Authors :
+// 2012: Pierre Guillot, Eliott Paris & Julien Colafrancesco.
+// 2012-2015: Pierre Guillot & Eliott Paris.
+// 2015: Pierre Guillot & Eliott Paris & Thomas Le Meur (Light version)
+// 2016-2017: Pierre Guillot.
+// For information on usage and redistribution, and for a DISCLAIMER OF ALL
+// WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+*/
+
+#pragma once
+
+#include "Hoa_Signal.hpp"
+
+#include <memory>
+#include <mutex>
+
+namespace hoa
+{
+    // ================================================================================ //
+    // FFT //
+    // ================================================================================ //
+
+    //! @brief The class performs the fast Fourier transform of real signals.
+    //! @details The transform of a real signal of size \f$N\f$ (a power of two) is computed
+    //! with a complex transform of size \f$N/2\f$: the even samples are the real parts and
+    //! the odd samples are the imaginary parts, the two halves of the spectrum are separated
+    //! after the transform.<br>
+    //! The complex transform is a decimation in time with radix-4 butterflies (and a
+    //! radix-2 butterfly for the first pass when \f$log_{2}(N/2)\f$ is odd). The real parts
+    //! and the imaginary parts are stored in two arrays and the twiddles of each pass are
+    //! stored contiguously, so the butterflies of a pass are vectorized by the compiler.<br>
+    //! The spectrum has \f$N/2+1\f$ bins from the DC to the Nyquist frequency. The forward
+    //! transform isn't normalized, the inverse transform is scaled by \f$1/N\f$. The tables
+    //! of a size (the plan) are computed once and shared by all the instances of this size,
+    //! the transforms don't allocate memory.
+    template <typename T>
+    class Fft
+    {
+    public:
+
+        //! @brief The precomputed tables of a size.
+        struct Plan
+        {
+            size_t              size;       //!< The size of the real transform.
+            std::vector<size_t> reverse;    //!< The bit reversal of the complex transform.
+            bool                radix2;     //!< If the first pass is a radix-2 pass.
+            std::vector<size_t> passes;     //!< The sub-transform size of each radix-4 pass.
+            std::vector<T>      twiddles;   //!< The twiddles of the radix-4 passes.
+            std::vector<T>      rcos;       //!< The cosines of the separation of the spectrum.
+            std::vector<T>      rsin;       //!< The sines of the separation of the spectrum.
+        };
+
+        //! @brief Constructor.
+        //! @param size The size of the transform (a power of two greater or equal to 4).
+        Fft(const size_t size = 4ul)
+        : m_plan(getPlan(size))
+        , m_real(size / 2)
+        , m_imag(size / 2)
+        {
+            ;
+        }
+
+        //! @brief Destructor.
+        ~Fft() = default;
+
+        //! @brief Returns the size of the transform.
+        inline size_t getSize() const noexcept { return m_plan->size; }
+
+        //! @brief Returns the number of bins of the spectrum.
+        inline size_t getNumberOfBins() const noexcept { return m_plan->size / 2 + 1; }
+
+        //! @brief Returns the lowest power of two greater or equal to a size (at least 4).
+        static inline size_t getPowerOfTwo(const size_t size) noexcept
+        {
+            size_t result = 4ul;
+            while(result < size) { result <<= 1; }
+            return result;
+        }
+
+        //! @brief Returns the shared plan of a size.
+        //! @details The plan is computed by the first call for a size and released when no
+        //! instance uses it anymore. The method is thread-safe but it allocates memory, it
+        //! must not be called by the audio thread.
+        //! @param size The size of the transform (a power of two greater or equal to 4).
+        static std::shared_ptr<const Plan> getPlan(const size_t size)
+        {
+            assert(size >= 4 && (size & (size - 1)) == 0 && "the size must be a power of two");
+            static std::mutex mutex;
+            static std::map<size_t, std::weak_ptr<const Plan>> plans;
+            std::lock_guard<std::mutex> guard(mutex);
+            std::shared_ptr<const Plan> plan = plans[size].lock();
+            if(!plan)
+            {
+                plan = createPlan(size);
+                plans[size] = plan;
+            }
+            return plan;
+        }
+
+        //! @brief Returns the plan used by the instance.
+        inline Plan const& getPlan() const noexcept { return *m_plan; }
+
+        //! @brief Computes the spectrum of a real signal.
+        //! @param input The signal of the size of the transform.
+        //! @param real  The real parts of the spectrum.
+        //! @param imag  The imaginary parts of the spectrum.
+        void forward(const T* input, T* real, T* imag) noexcept
+        {
+            Plan const& plan = *m_plan;
+            const size_t half = plan.size / 2;
+            T* zr = m_real.data();
+            T* zi = m_imag.data();
+            const size_t* reverse = plan.reverse.data();
+            for(size_t i = 0; i < half; ++i)
+            {
+                const size_t r = reverse[i];
+                zr[r] = input[i * 2];
+                zi[r] = input[i * 2 + 1];
+            }
+            transform(zr, zi, false);
+
+            const T* rcos = plan.rcos.data();
+            const T* rsin = plan.rsin.data();
+            for(size_t k = 0; k <= half; ++k)
+            {
+                const size_t k1 = (k == half) ? 0 : k;
+                const size_t k2 = (k == 0) ? 0 : half - k;
+                const T ar = zr[k1], ai = zi[k1];
+                const T br = zr[k2], bi = -zi[k2];
+                const T er = (ar + br) * T(0.5), ei = (ai + bi) * T(0.5);
+                const T or_ = (ai - bi) * T(0.5), oi = (br - ar) * T(0.5);
+                real[k] = er + rcos[k] * or_ + rsin[k] * oi;
+                imag[k] = ei + rcos[k] * oi - rsin[k] * or_;
+            }
+        }
+
+        //! @brief Computes a real signal from its spectrum.
+        //! @details The signal is scaled by \f$1/N\f$ so the inverse of the spectrum of a
+        //! signal is the signal.
+        //! @param real   The real parts of the spectrum.
+        //! @param imag   The imaginary parts of the spectrum.
+        //! @param output The signal of the size of the transform.
+        void inverse(const T* real, const T* imag, T* output) noexcept
+        {
+            Plan const& plan = *m_plan;
+            const size_t half = plan.size / 2;
+            T* zr = m_real.data();
+            T* zi = m_imag.data();
+            const size_t* reverse = plan.reverse.data();
+            const T* rcos = plan.rcos.data();
+            const T* rsin = plan.rsin.data();
+            for(size_t k = 0; k < half; ++k)
+            {
+                const T ar = real[k], ai = imag[k];
+                const T br = real[half - k], bi = -imag[half - k];
+                const T er = (ar + br) * T(0.5), ei = (ai + bi) * T(0.5);
+                const T dr = (ar - br) * T(0.5), di = (ai - bi) * T(0.5);
+                const T or_ = dr * rcos[k] - di * rsin[k];
+                const T oi = dr * rsin[k] + di * rcos[k];
+                const size_t r = reverse[k];
+                zr[r] = er - oi;
+                zi[r] = ei + or_;
+            }
+            transform(zr, zi, true);
+
+            const T scale = T(1) / T(half);
+            for(size_t i = 0; i < half; ++i)
+            {
+                output[i * 2]     = zr[i] * scale;
+                output[i * 2 + 1] = zi[i] * scale;
+            }
+        }
+
+    private:
+
+        //! @brief Computes the tables of a size.
+        static std::shared_ptr<const Plan> createPlan(const size_t size)
+        {
+            std::shared_ptr<Plan> plan = std::make_shared<Plan>();
+            const size_t half = size / 2;
+            plan->size = size;
+
+            size_t nbits = 0;
+            while((size_t(1) << nbits) < half) { ++nbits; }
+            plan->radix2 = (nbits % 2) == 1;
+            plan->reverse.resize(half);
+            for(size_t i = 0; i < half; ++i)
+            {
+                size_t r = 0;
+                for(size_t b = 0; b < nbits; ++b)
+                {
+                    r |= ((i >> b) & 1ul) << (nbits - 1 - b);
+                }
+                plan->reverse[i] = r;
+            }
+
+            // a radix-4 pass combines 4 sub-transforms of size L, its twiddles are
+            // w^k, w^2k and w^3k with w = exp(-2i.pi/4L), stored as 6 arrays of L values
+            for(size_t length = plan->radix2 ? 2 : 1; length * 4 <= half; length *= 4)
+            {
+                plan->passes.push_back(length);
+                for(size_t m = 1; m <= 3; ++m)
+                {
+                    for(size_t k = 0; k < length; ++k)
+                    {
+                        plan->twiddles.push_back(T(std::cos(HOA_2PI * double(m * k) / double(length * 4))));
+                    }
+                    for(size_t k = 0; k < length; ++k)
+                    {
+                        plan->twiddles.push_back(T(-std::sin(HOA_2PI * double(m * k) / double(length * 4))));
+                    }
+                }
+            }
+
+            plan->rcos.resize(half + 1);
+            plan->rsin.resize(half + 1);
+            for(size_t i = 0; i <= half; ++i)
+            {
+                const double angle = HOA_2PI * double(i) / double(size);
+                plan->rcos[i] = T(std::cos(angle));
+                plan->rsin[i] = T(std::sin(angle));
+            }
+            return plan;
+        }
+
+        //! @brief The complex transform of the bit-reversed arrays.
+        //! @details The inverse transform uses the conjugates of the twiddles.
+        void transform(T* real, T* imag, const bool inverse) noexcept
+        {
+            Plan const& plan = *m_plan;
+            const size_t half = plan.size / 2;
+
+            // the radix-2 pass when the number of bits is odd
+            if(plan.radix2)
+            {
+                for(size_t i = 0; i < half; i += 2)
+                {
+                    const T ar = real[i], ai = imag[i];
+                    const T br = real[i + 1], bi = imag[i + 1];
+                    real[i] = ar + br; imag[i] = ai + bi;
+                    real[i + 1] = ar - br; imag[i + 1] = ai - bi;
+                }
+            }
+
+            const T sign = inverse ? T(-1) : T(1);
+            const T* twiddles = plan.twiddles.data();
+            for(const size_t length : plan.passes)
+            {
+                const T* w1r = twiddles;
+                const T* w1i = w1r + length;
+                const T* w2r = w1i + length;
+                const T* w2i = w2r + length;
+                const T* w3r = w2i + length;
+                const T* w3i = w3r + length;
+                twiddles += length * 6;
+
+                for(size_t i = 0; i < half; i += length * 4)
+                {
+                    T* ar = real + i;
+                    T* ai = imag + i;
+                    T* br = ar + length;
+                    T* bi = ai + length;
+                    T* cr = br + length;
+                    T* ci = bi + length;
+                    T* dr = cr + length;
+                    T* di = ci + length;
+                    for(size_t k = 0; k < length; ++k)
+                    {
+                        const T t1r = br[k] * w2r[k] - sign * bi[k] * w2i[k];
+                        const T t1i = bi[k] * w2r[k] + sign * br[k] * w2i[k];
+                        const T t2r = cr[k] * w1r[k] - sign * ci[k] * w1i[k];
+                        const T t2i = ci[k] * w1r[k] + sign * cr[k] * w1i[k];
+                        const T t3r = dr[k] * w3r[k] - sign * di[k] * w3i[k];
+                        const T t3i = di[k] * w3r[k] + sign * dr[k] * w3i[k];
+
+                        const T s0r = ar[k] + t1r, s0i = ai[k] + t1i;
+                        const T s1r = ar[k] - t1r, s1i = ai[k] - t1i;
+                        const T s2r = t2r + t3r, s2i = t2i + t3i;
+                        // (t2 - t3) multiplied by -i (or i for the inverse)
+                        const T s3r = sign * (t2i - t3i), s3i = sign * (t3r - t2r);
+
+                        ar[k] = s0r + s2r; ai[k] = s0i + s2i;
+                        cr[k] = s0r - s2r; ci[k] = s0i - s2i;
+                        br[k] = s1r + s3r; bi[k] = s1i + s3i;
+                        dr[k] = s1r - s3r; di[k] = s1i - s3i;
+                    }
+                }
+            }
+        }
+
+        std::shared_ptr<const Plan> m_plan;
+        std::vector<T>  m_real {};
+        std::vector<T>  m_imag {};
+    };
+}
@@ -116,6 +116,27 @@ namespace hoa
             return (D == Hoa2d) ? ((degree != 0) + 1) : (degree * 2 + 1);
         }
 
+        //! @brief Returns the number of harmonics for a mixed order of decomposition.
+        //! @details A mixed order keeps all the harmonics up to the vertical order \f$V\f$
+        //! and only the horizontal harmonics (\f$\left|m\right| = l\f$) from \f$V+1\f$ to the
+        //! horizontal order \f$N\f$. The computation is \f$2N+1\f$ in 2D and
+        //! \f$(V+1)^{2}+2(N-V)\f$ in 3D.
+        //! @param order    The horizontal order of decomposition.
+        //! @param vertical The vertical order of decomposition.
+        static inline constexpr size_t getNumberOfHarmonics(const size_t order, const size_t vertical) noexcept
+        {
+            return (D == Hoa2d || vertical >= order) ? getNumberOfHarmonics(order) : (vertical + 1) * (vertical + 1) + (order - vertical) * 2;
+        }
+
+        //! @brief Returns true if an harmonic belongs to a mixed order of decomposition.
+        //! @param degree   The degree of the harmonic.
+        //! @param order    The azimuthal order of the harmonic.
+        //! @param vertical The vertical order of decomposition.
+        static inline bool isInMixedOrder(const size_t degree, const long order, const size_t vertical) noexcept
+        {
+            return D == Hoa2d || degree <= vertical || size_t(std::abs(order)) == degree;
+        }
+
         //! @brief Returns the normalization N3D or N2D of an harmonic.
         //! @details The semi-normalization \f$k^{n2d}_{l, m}\f$ and \f$k^{n3d}_{l, m}\f$
         //! are defined by:
@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include "Hoa_Harmonics.hpp"
 #include "Hoa_Hrir_Listen_1002C_2D.hpp"
 #include "Hoa_Hrir_Listen_1002C_3D.hpp"
 #include "Hoa_Hrir_Sadie_D2_2D.hpp"
@@ -76,6 +77,45 @@ namespace hoa
             return GetMatrix<FloatType>::right();
         }
         
+        //! @brief Gets the sign of the symmetry of the response of a harmonic.
+        //! @details The harmonics of the negative orders are odd with respect to the
+        //! median plane, the others are even.
+        //! @param index The index of the harmonic.
+        //! @return 1 for an even harmonic, -1 for an odd harmonic.
+        static int getSymmetrySign(const size_t index) noexcept
+        {
+            return Harmonic<D, double>::getOrder(index) < 0 ? -1 : 1;
+        }
+        
+        //! @brief Checks if the responses are symmetric with respect to the median plane.
+        //! @details The responses are symmetric if the response of each harmonic for the
+        //! right ear is the response for the left ear multiplied by the sign of the
+        //! symmetry of the harmonic. The difference is compared with the RMS of both ears.
+        //! @param tolerance The relative tolerance.
+        //! @return true if the responses are symmetric.
+        static bool isSymmetric(const double tolerance = 1e-4)
+        {
+            const double* left = getLeftMatrix<double>();
+            const double* right = getRightMatrix<double>();
+            for(size_t i = 0; i < getNumberOfColumns(); ++i)
+            {
+                const double sign = double(getSymmetrySign(i));
+                double energy = 0., error = 0.;
+                for(size_t j = 0; j < getNumberOfRows(); ++j)
+                {
+                    const double l = left[j * getNumberOfColumns() + i];
+                    const double r = right[j * getNumberOfColumns() + i];
+                    energy += (l * l + r * r) * 0.5;
+                    error  += (r - sign * l) * (r - sign * l);
+                }
+                if(error > energy * tolerance * tolerance)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+        
     private:
         
         template <typename FloatType, typename Unused = void>
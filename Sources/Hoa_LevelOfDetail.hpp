@@ -0,0 +1,412 @@
+/*
+// Copyright (c) 2012-2017 CICM - Universite Paris 8 - Labex Arts H2H.
+// Authors :
+// 2012: Pierre Guillot, Eliott Paris & Julien Colafrancesco.
+// 2012-2015: Pierre Guillot & Eliott Paris.
+// 2015: Pierre Guillot & Eliott Paris & Thomas Le Meur (Light version)
+// 2016-2017: Pierre Guillot.
+// For information on usage and redistribution, and for a DISCLAIMER OF ALL
+// WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+*/
+
+#pragma once
+
+#include "Hoa_Decoder.hpp"
+
+#include <atomic>
+
+namespace hoa
+{
+    // ================================================================================ //
+    // LEVEL OF DETAIL //
+    // ================================================================================ //
+
+    //! @brief The class decodes the harmonics with an order that can be reduced while processing.
+    //! @details When the processor is overloaded, it is better to lose spatial resolution
+    //! than to drop out. The class owns a decoding matrix for each order that has been
+    //! prepared and decodes with the matrix of the current order, so the cost of the
+    //! decoding is proportional to the number of harmonics of the current order and the
+    //! harmonics of the upper degrees are not read.<br>
+    //! When the order changes from \f$N\f$ to \f$M\f$, the outputs of the matrix of
+    //! \f$N\f$ and the outputs of the matrix of \f$M\f$ are crossfaded linearly over a
+    //! number of samples:
+    //! \f[y = (1-g)D_{N}x + gD_{M}x\f]
+    //! with \f$g\f$ the gain of the fade from \f$0\f$ to \f$1\f$. The harmonics are not
+    //! weighted by degree (unlike the Optim and the Wider classes), the degrees above
+    //! \f$min(N, M)\f$ are only read by the matrix of the higher order and fade with its
+    //! outputs. During the fade, both matrices are applied.<br>
+    //! The matrices are set by a control thread before processing, the order can be changed
+    //! from any thread (by the LoadController for example) and is taken by the audio thread
+    //! at the beginning of a vector when it isn't fading. An order without matrix is
+    //! replaced by the highest lower order with a matrix (or the lowest order with a matrix).
+    template <Dimension D, typename T>
+    class LevelOfDetail
+    : public ProcessorHarmonics<D, T>
+    {
+    public:
+
+        //! @brief Constructor.
+        //! @param order The maximum order.
+        //! @param nplws The number of plane waves.
+        //! @param vectorsize The vector size of the block processing.
+        LevelOfDetail(const size_t order, const size_t nplws, const size_t vectorsize = 64)
+        : ProcessorHarmonics<D, T>(order)
+        , m_number_of_planewaves(nplws)
+        , m_vector_size(vectorsize)
+        , m_levels(order + 1)
+        , m_temp(nplws * vectorsize)
+        , m_temp_channels(nplws)
+        , m_fade_length(vectorsize)
+        , m_order(order)
+        {
+            for(size_t i = 0; i < nplws; ++i)
+            {
+                m_temp_channels[i] = m_temp.data() + i * vectorsize;
+            }
+        }
+
+        //! @brief Destructor.
+        ~LevelOfDetail() = default;
+
+        //! @brief Returns the number of plane waves.
+        inline size_t getNumberOfPlanewaves() const noexcept { return m_number_of_planewaves; }
+
+        //! @brief Returns the vector size of the block processing.
+        inline size_t getVectorSize() const noexcept { return m_vector_size; }
+
+        //! @brief Sets the decoding matrix of an order.
+        //! @details The matrix is copied, it must be stored row by row with a row for each
+        //! plane wave and a column for each harmonic of the order. The method must be called
+        //! before processing.
+        //! @param order The order of the matrix.
+        //! @param matrix The decoding matrix.
+        void setMatrix(const size_t order, const T* matrix)
+        {
+            assert(order < m_levels.size());
+            const size_t nharm = Harmonic<D, T>::getNumberOfHarmonics(order);
+            Level& level = m_levels[order];
+            level.matrix.assign(matrix, matrix + m_number_of_planewaves * nharm);
+            level.packed.resize(Signal<T>::packsize(nharm, m_number_of_planewaves));
+            Signal<T>::pack(nharm, m_number_of_planewaves, matrix, level.packed.data());
+        }
+
+        //! @brief Sets the matrix of a decoder to its order.
+        //! @details The decoder must have the same number of plane waves and must have been
+        //! prepared. The method must be called before processing.
+        //! @param decoder The decoder.
+        template <class Decoder>
+        inline void setDecoder(Decoder const& decoder)
+        {
+            assert(decoder.getNumberOfPlanewaves() == m_number_of_planewaves);
+            setMatrix(decoder.getDecompositionOrder(), decoder.getMatrix());
+        }
+
+        //! @brief Returns true if an order has a decoding matrix.
+        inline bool hasMatrix(const size_t order) const noexcept
+        {
+            return order < m_levels.size() && !m_levels[order].matrix.empty();
+        }
+
+        //! @brief Requests an order.
+        //! @details The method can be called from any thread, the order is taken by the audio
+        //! thread at the beginning of the next vector that isn't fading.
+        //! @param order The order (clipped to the maximum order).
+        inline void setOrder(const size_t order) noexcept
+        {
+            m_order.store(std::min(order, ProcessorHarmonics<D, T>::getDecompositionOrder()));
+        }
+
+        //! @brief Returns the requested order.
+        inline size_t getOrder() const noexcept { return m_order.load(); }
+
+        //! @brief Returns the order used by the audio thread.
+        //! @details The method must be called from the audio thread.
+        inline size_t getCurrentOrder() const noexcept { return m_current; }
+
+        //! @brief Returns the number of harmonics read by the audio thread.
+        //! @details The harmonics above this number don't need to be computed when the
+        //! order isn't fading. The method must be called from the audio thread.
+        inline size_t getNumberOfActiveHarmonics() const noexcept
+        {
+            return Harmonic<D, T>::getNumberOfHarmonics(m_fade_size ? std::max(m_current, m_previous) : m_current);
+        }
+
+        //! @brief Sets the number of samples of the fades between two orders.
+        //! @param nsamples The number of samples (0 means no fade, default is the vector size).
+        inline void setFadeLength(const size_t nsamples) noexcept { m_fade_length.store(nsamples); }
+
+        //! @brief Returns the number of samples of the fades between two orders.
+        inline size_t getFadeLength() const noexcept { return m_fade_length.load(); }
+
+        //! @brief Returns true if the decoder is fading between two orders.
+        //! @details The method must be called from the audio thread.
+        inline bool isFading() const noexcept { return m_fade_size != 0; }
+
+        //! @brief The method performs the decoding of the harmonics signal.
+        //! @details The method must be called from the audio thread.
+        //! @param inputs  The inputs array.
+        //! @param outputs The outputs array.
+        void process(const T* inputs, T* outputs) noexcept override
+        {
+            const size_t nplws = m_number_of_planewaves;
+            if(!acquire())
+            {
+                Signal<T>::clear(nplws, outputs);
+                return;
+            }
+            Signal<T>::mul(Harmonic<D, T>::getNumberOfHarmonics(m_current), nplws,
+                           inputs, m_levels[m_current].matrix.data(), outputs);
+            if(m_fade_size)
+            {
+                T* temp = m_temp.data();
+                Signal<T>::mul(Harmonic<D, T>::getNumberOfHarmonics(m_previous), nplws,
+                               inputs, m_levels[m_previous].matrix.data(), temp);
+                ++m_fade_position;
+                const T gain = T(m_fade_position) / T(m_fade_size);
+                for(size_t i = 0; i < nplws; ++i)
+                {
+                    outputs[i] = temp[i] + (outputs[i] - temp[i]) * gain;
+                }
+                if(m_fade_position >= m_fade_size)
+                {
+                    m_fade_size = 0;
+                }
+            }
+        }
+
+        //! @brief The method performs the decoding of a block of harmonics signals.
+        //! @details The method must be called from the audio thread, the outputs must not
+        //! share memory with the inputs. Only the channels of the harmonics of the current
+        //! orders are read.
+        //! @param inputs  The inputs channels.
+        //! @param outputs The outputs channels.
+        void processBlock(const T** inputs, T** outputs) noexcept
+        {
+            const size_t nplws = m_number_of_planewaves;
+            const size_t vsize = m_vector_size;
+            if(!acquire())
+            {
+                for(size_t i = 0; i < nplws; ++i)
+                {
+                    Signal<T>::clear(vsize, outputs[i]);
+                }
+                return;
+            }
+            Signal<T>::mul(Harmonic<D, T>::getNumberOfHarmonics(m_current), nplws, vsize,
+                           m_levels[m_current].packed.data(), inputs, outputs);
+            if(m_fade_size)
+            {
+                Signal<T>::mul(Harmonic<D, T>::getNumberOfHarmonics(m_previous), nplws, vsize,
+                               m_levels[m_previous].packed.data(), inputs, m_temp_channels.data());
+                const T step = T(1) / T(m_fade_size);
+                for(size_t i = 0; i < nplws; ++i)
+                {
+                    const T* temp = m_temp_channels[i];
+                    T* output = outputs[i];
+                    size_t position = m_fade_position;
+                    for(size_t j = 0; j < vsize && position < m_fade_size; ++j)
+                    {
+                        ++position;
+                        output[j] = temp[j] + (output[j] - temp[j]) * (T(position) * step);
+                    }
+                }
+                m_fade_position += vsize;
+                if(m_fade_position >= m_fade_size)
+                {
+                    m_fade_size = 0;
+                }
+            }
+        }
+
+    private:
+
+        struct Level
+        {
+            std::vector<T> matrix;
+            std::vector<T> packed;
+        };
+
+        //! @brief Returns the order with a matrix that replaces a requested order.
+        size_t resolve(const size_t order) const noexcept
+        {
+            for(size_t i = order + 1; i > 0; --i)
+            {
+                if(hasMatrix(i - 1)) { return i - 1; }
+            }
+            for(size_t i = order + 1; i < m_levels.size(); ++i)
+            {
+                if(hasMatrix(i)) { return i; }
+            }
+            return m_levels.size();
+        }
+
+        //! @brief Takes the requested order if the audio thread isn't fading.
+        //! @return false if no order has a matrix.
+        inline bool acquire() noexcept
+        {
+            if(!m_fade_size)
+            {
+                const size_t order = resolve(m_order.load(std::memory_order_relaxed));
+                if(order >= m_levels.size())
+                {
+                    return false;
+                }
+                if(!m_started)
+                {
+                    m_current = order;
+                    m_started = true;
+                }
+                else if(order != m_current)
+                {
+                    m_previous = m_current;
+                    m_current  = order;
+                    m_fade_size = m_fade_length.load(std::memory_order_relaxed);
+                    m_fade_position = 0;
+                }
+            }
+            return true;
+        }
+
+        const size_t            m_number_of_planewaves;
+        const size_t            m_vector_size;
+        std::vector<Level>      m_levels;
+        std::vector<T>          m_temp;
+        std::vector<T*>         m_temp_channels;
+        std::atomic<size_t>     m_fade_length;
+        std::atomic<size_t>     m_order;
+
+        // Owned by the audio thread
+        size_t                  m_current = 0ul;
+        size_t                  m_previous = 0ul;
+        size_t                  m_fade_size = 0ul;
+        size_t                  m_fade_position = 0ul;
+        bool                    m_started = false;
+    };
+
+    // ================================================================================ //
+    // LOAD CONTROLLER //
+    // ================================================================================ //
+
+    //! @brief The class chooses the order of decoding from the measured processing time.
+    //! @details The load is the time spent to process a vector divided by the duration of
+    //! the vector. The load is smoothed with a fast attack and a slow release so a single
+    //! slow vector is enough to react. When the load exceeds the high threshold, the order
+    //! is reduced by one. The order is increased by one when the load predicted for the upper
+    //! order (the load scaled by the ratio of the numbers of harmonics) stays below the low
+    //! threshold during a number of vectors. After each change, the controller waits the
+    //! same number of vectors, so the measurements reflect the new order before deciding
+    //! again.
+    template <Dimension D, typename T>
+    class LoadController
+    {
+    public:
+
+        //! @brief Constructor.
+        //! @param minorder The minimum order.
+        //! @param maxorder The maximum order.
+        LoadController(const size_t minorder, const size_t maxorder) noexcept
+        : m_min_order(std::min(minorder, maxorder))
+        , m_max_order(maxorder)
+        , m_order(maxorder)
+        {
+            ;
+        }
+
+        //! @brief Destructor.
+        ~LoadController() = default;
+
+        //! @brief Sets the thresholds of the load.
+        //! @param low The load under which the order can be increased (default 0.5).
+        //! @param high The load over which the order is reduced (default 0.8).
+        inline void setThresholds(const T low, const T high) noexcept
+        {
+            m_low  = std::min(low, high);
+            m_high = high;
+        }
+
+        //! @brief Returns the low threshold.
+        inline T getLowThreshold() const noexcept { return m_low; }
+
+        //! @brief Returns the high threshold.
+        inline T getHighThreshold() const noexcept { return m_high; }
+
+        //! @brief Sets the number of vectors to wait before increasing the order.
+        //! @param nvectors The number of vectors (default 32).
+        inline void setHold(const size_t nvectors) noexcept { m_hold = nvectors; }
+
+        //! @brief Returns the number of vectors to wait before increasing the order.
+        inline size_t getHold() const noexcept { return m_hold; }
+
+        //! @brief Sets the coefficient of the release of the smoothed load.
+        //! @param coefficient The coefficient between 0 and 1 (default 0.1).
+        inline void setRelease(const T coefficient) noexcept
+        {
+            m_release = std::max(std::min(coefficient, T(1)), T(0));
+        }
+
+        //! @brief Returns the smoothed load.
+        inline T getLoad() const noexcept { return m_load; }
+
+        //! @brief Returns the order.
+        inline size_t getOrder() const noexcept { return m_order; }
+
+        //! @brief Resets the order to the maximum order and the load to zero.
+        void reset() noexcept
+        {
+            m_order = m_max_order;
+            m_load  = T(0);
+            m_count = 0;
+            m_wait  = 0;
+        }
+
+        //! @brief Updates the order from the time spent to process a vector.
+        //! @param elapsed The time spent to process the vector.
+        //! @param duration The duration of the vector (in the same unit).
+        //! @return The order.
+        size_t update(const T elapsed, const T duration) noexcept
+        {
+            const T load = duration > T(0) ? elapsed / duration : T(0);
+            m_load = load > m_load ? load : m_load + (load - m_load) * m_release;
+            if(m_wait)
+            {
+                --m_wait;
+                return m_order;
+            }
+            if(m_load > m_high && m_order > m_min_order)
+            {
+                --m_order;
+                m_count = 0;
+                m_wait  = m_hold;
+            }
+            else if(m_order < m_max_order
+                    && m_load * T(Harmonic<D, T>::getNumberOfHarmonics(m_order + 1))
+                    < m_low * T(Harmonic<D, T>::getNumberOfHarmonics(m_order)))
+            {
+                if(++m_count >= m_hold)
+                {
+                    ++m_order;
+                    m_count = 0;
+                    m_wait  = m_hold;
+                }
+            }
+            else
+            {
+                m_count = 0;
+            }
+            return m_order;
+        }
+
+    private:
+
+        const size_t    m_min_order;
+        const size_t    m_max_order;
+        size_t          m_order;
+        T               m_low = T(0.5);
+        T               m_high = T(0.8);
+        T               m_release = T(0.1);
+        T               m_load = T(0);
+        size_t          m_hold = 32ul;
+        size_t          m_count = 0ul;
+        size_t          m_wait = 0ul;
+    };
+}
@@ -180,7 +180,7 @@ namespace hoa
             }
         }
         
-    private:
+    protected:
         
         static inline void sigadd(const size_t size, const T* in, T* out) noexcept
         {
@@ -225,7 +225,7 @@ namespace hoa
             bool muted = false;
         };
         
-    private:
+    protected:
         
         T* m_temp = nullptr;
         std::vector<EncoderWrap> m_encoders {};
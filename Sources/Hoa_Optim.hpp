@@ -64,11 +64,26 @@ namespace hoa
             setMode(InPhase);
         }
 
+        //! @brief The constructor for a mixed order.
+        //! @details The weights depend on the degrees of the harmonics and on the horizontal
+        //! order of decomposition.
+        //! @param order The horizontal order of decomposition.
+        //! @param vertical The vertical order of decomposition.
+        Optim(size_t order, size_t vertical) noexcept
+        : ProcessorHarmonics<D, T>(order, vertical)
+        , m_weights(Signal<T>::alloc(ProcessorHarmonics<D, T>::getNumberOfHarmonics()))
+        {
+            setMode(InPhase);
+        }
+
         //! @brief Destructor.
 		~Optim() noexcept { Signal<T>::free(m_weights); }
         
         //! @brief Returns the current optimization mode.
         inline Mode getMode() const noexcept { return m_mode; }
+
+        //! @brief Returns the weights of the harmonics.
+        inline const T* getWeights() const noexcept { return m_weights; }
         
         //! @brief Set the optimization mode.
         //! @param mode The mode of optimization.
@@ -146,4 +161,212 @@ namespace hoa
         Mode m_mode;
         T*   m_weights;
     };
+
+    // ================================================================================ //
+    // OPTIM DUAL BAND //
+    // ================================================================================ //
+
+    //! @brief The class optimizes the ambisonic sound field with two frequency bands.
+    //! @details The basic optimization gives the best reconstruction of the velocity vector
+    //! at low frequencies while the max-re optimization gives the best energy vector at high
+    //! frequencies. The class splits the harmonics with a fourth order Linkwitz-Riley
+    //! crossover and applies a set of weights to each band (by default basic below the
+    //! crossover frequency and max-re above) before summing the bands, the result can be
+    //! decoded with a single decoding matrix. The filters are applied to the harmonics that
+    //! are fewer than the loudspeakers.<br>
+    //! The low-pass and the high-pass of the crossover sum to a second order all-pass with
+    //! the same frequency, so the output is computed as:<br>
+    //! \f[y_{l,m} = W^{high}_{l,m} \times AP(x_{l,m}) + (W^{low}_{l,m} - W^{high}_{l,m}) \times LP(x_{l,m})\f]<br>
+    //! that costs three biquads per harmonic instead of four and keeps the bands in phase.
+    //! The filters of all the harmonics are computed together for each sample, so the loops
+    //! run across the harmonics and can be vectorized by the compiler.
+    template <Dimension D, typename T>
+    class OptimDualBand
+    : public ProcessorHarmonics<D, T>
+    {
+    public:
+
+        //! @brief The constructor.
+        //! @param order The order of decomposition.
+        //! @param samplerate The sample rate.
+        //! @param frequency The crossover frequency.
+        //! @param vectorsize The vector size of the block processing.
+        OptimDualBand(const size_t order, const T samplerate, const T frequency = T(400), const size_t vectorsize = 64)
+        : ProcessorHarmonics<D, T>(order)
+        , m_optim(order)
+        , m_vector_size(vectorsize)
+        , m_weights(ProcessorHarmonics<D, T>::getNumberOfHarmonics())
+        , m_differences(ProcessorHarmonics<D, T>::getNumberOfHarmonics())
+        , m_frames(ProcessorHarmonics<D, T>::getNumberOfHarmonics() * vectorsize)
+        , m_sample_rate(samplerate)
+        , m_frequency(frequency)
+        {
+            for(auto& state : m_states)
+            {
+                state.resize(ProcessorHarmonics<D, T>::getNumberOfHarmonics());
+            }
+            setModes(Optim<D, T>::Basic, Optim<D, T>::MaxRe);
+            computeCoefficients();
+        }
+
+        //! @brief Destructor.
+        ~OptimDualBand() = default;
+
+        //! @brief Sets the optimization modes of the two bands.
+        //! @param low The mode below the crossover frequency.
+        //! @param high The mode above the crossover frequency.
+        void setModes(typename Optim<D, T>::Mode low, typename Optim<D, T>::Mode high) noexcept
+        {
+            const size_t size = ProcessorHarmonics<D, T>::getNumberOfHarmonics();
+            m_optim.setMode(high);
+            Signal<T>::copy(size, m_optim.getWeights(), m_weights.data());
+            m_optim.setMode(low);
+            for(size_t i = 0; i < size; ++i)
+            {
+                m_differences[i] = m_optim.getWeights()[i] - m_weights[i];
+            }
+            m_low_mode  = low;
+            m_high_mode = high;
+        }
+
+        //! @brief Returns the optimization mode below the crossover frequency.
+        inline typename Optim<D, T>::Mode getLowMode() const noexcept { return m_low_mode; }
+
+        //! @brief Returns the optimization mode above the crossover frequency.
+        inline typename Optim<D, T>::Mode getHighMode() const noexcept { return m_high_mode; }
+
+        //! @brief Sets the crossover frequency.
+        //! @param frequency The frequency in Hertz.
+        void setFrequency(const T frequency) noexcept
+        {
+            m_frequency = frequency;
+            computeCoefficients();
+        }
+
+        //! @brief Returns the crossover frequency.
+        inline T getFrequency() const noexcept { return m_frequency; }
+
+        //! @brief Sets the sample rate.
+        //! @param samplerate The sample rate.
+        void setSampleRate(const T samplerate) noexcept
+        {
+            m_sample_rate = samplerate;
+            computeCoefficients();
+        }
+
+        //! @brief Returns the sample rate.
+        inline T getSampleRate() const noexcept { return m_sample_rate; }
+
+        //! @brief Returns the vector size of the block processing.
+        inline size_t getVectorSize() const noexcept { return m_vector_size; }
+
+        //! @brief Clears the memory of the filters.
+        void clear() noexcept
+        {
+            for(auto& state : m_states)
+            {
+                Signal<T>::clear(state.size(), state.data());
+            }
+        }
+
+        //! @brief The method performs the optimization on the harmonics signal.
+        //! @details The method can be used for in-place or not-in-place processing and sample
+        //! by sample. The inputs array and outputs array contains the spherical harmonics
+        //! samples thus the minimum size of the array must be the number of harmonics.
+        //! @param inputs  The inputs array.
+        //! @param outputs The outputs array.
+        void process(T const* inputs, T* outputs) noexcept final
+        {
+            processFrame(inputs, outputs);
+        }
+
+        //! @brief The method performs the optimization on a block of harmonics signals.
+        //! @details The method can be used for in-place or not-in-place processing, each
+        //! channel contains the vector size number of samples of a harmonic.
+        //! @param inputs  The inputs channels.
+        //! @param outputs The outputs channels.
+        void processBlock(const T** inputs, T** outputs) noexcept
+        {
+            const size_t size  = ProcessorHarmonics<D, T>::getNumberOfHarmonics();
+            const size_t vsize = m_vector_size;
+            T* frames = m_frames.data();
+            for(size_t i = 0; i < size; ++i)
+            {
+                Signal<T>::copy(vsize, inputs[i], 1ul, frames + i, size);
+            }
+            for(size_t j = 0; j < vsize; ++j)
+            {
+                processFrame(frames + j * size, frames + j * size);
+            }
+            for(size_t i = 0; i < size; ++i)
+            {
+                Signal<T>::copy(vsize, frames + i, size, outputs[i], 1ul);
+            }
+        }
+
+    private:
+
+        //! @brief Filters a sample of all the harmonics.
+        inline void processFrame(T const* inputs, T* outputs) noexcept
+        {
+            const size_t size = ProcessorHarmonics<D, T>::getNumberOfHarmonics();
+            const T b0 = m_lowpass[0], b1 = m_lowpass[1], b2 = m_lowpass[2];
+            const T a1 = m_feedback[0], a2 = m_feedback[1];
+            const T c0 = m_allpass[0], c1 = m_allpass[1], c2 = m_allpass[2];
+            T* l11 = m_states[0].data(); T* l12 = m_states[1].data();
+            T* l21 = m_states[2].data(); T* l22 = m_states[3].data();
+            T* ap1 = m_states[4].data(); T* ap2 = m_states[5].data();
+            const T* weights = m_weights.data();
+            const T* differences = m_differences.data();
+            for(size_t i = 0; i < size; ++i)
+            {
+                const T x = inputs[i];
+
+                const T y1 = b0 * x + l11[i];
+                l11[i] = b1 * x - a1 * y1 + l12[i];
+                l12[i] = b2 * x - a2 * y1;
+
+                const T y2 = b0 * y1 + l21[i];
+                l21[i] = b1 * y1 - a1 * y2 + l22[i];
+                l22[i] = b2 * y1 - a2 * y2;
+
+                const T y3 = c0 * x + ap1[i];
+                ap1[i] = c1 * x - a1 * y3 + ap2[i];
+                ap2[i] = c2 * x - a2 * y3;
+
+                outputs[i] = weights[i] * y3 + differences[i] * y2;
+            }
+        }
+
+        //! @brief Computes the coefficients of the Butterworth low-pass and of the all-pass.
+        void computeCoefficients() noexcept
+        {
+            const T w0    = T(HOA_2PI) * m_frequency / m_sample_rate;
+            const T cosw  = std::cos(w0);
+            const T alpha = std::sin(w0) * T(0.70710678118654752440);
+            const T norm  = T(1) / (T(1) + alpha);
+            m_lowpass[0]  = (T(1) - cosw) * T(0.5) * norm;
+            m_lowpass[1]  = (T(1) - cosw) * norm;
+            m_lowpass[2]  = m_lowpass[0];
+            m_allpass[0]  = (T(1) - alpha) * norm;
+            m_allpass[1]  = T(-2) * cosw * norm;
+            m_allpass[2]  = T(1);
+            m_feedback[0] = m_allpass[1];
+            m_feedback[1] = m_allpass[0];
+        }
+
+        Optim<D, T>                 m_optim;
+        const size_t                m_vector_size;
+        std::vector<T>              m_weights;
+        std::vector<T>              m_differences;
+        std::vector<T>              m_frames;
+        std::vector<T>              m_states[6];
+        T                           m_sample_rate;
+        T                           m_frequency;
+        T                           m_lowpass[3];
+        T                           m_allpass[3];
+        T                           m_feedback[2];
+        typename Optim<D, T>::Mode  m_low_mode;
+        typename Optim<D, T>::Mode  m_high_mode;
+    };
 }
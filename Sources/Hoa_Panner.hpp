@@ -0,0 +1,590 @@
+/*
+// Copyright (c) 2012-2017 CICM - Universite Paris 8 - Labex Arts H2H.
+// Authors :
+// 2012: Pierre Guillot, Eliott Paris & Julien Colafrancesco.
+// 2012-2015: Pierre Guillot & Eliott Paris.
+// 2015: Pierre Guillot & Eliott Paris & Thomas Le Meur (Light version)
+// 2016-2017: Pierre Guillot.
+// For information on usage and redistribution, and for a DISCLAIMER OF ALL
+// WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+*/
+
+#pragma once
+
+#include "Hoa_Processor.hpp"
+#include "Hoa_Voronoi.hpp"
+
+#include <array>
+
+namespace hoa
+{
+    // ================================================================================ //
+    // PANNER LAYOUT //
+    // ================================================================================ //
+
+    //! @brief The class finds the loudspeakers that surround a direction.
+    //! @details The layout computes the raw vector base panning gains of a direction for
+    //! the two (2D) or the three (3D) loudspeakers that surround it. The gains are positive
+    //! but not normalized. The unused indices and the index of an imaginary loudspeaker are
+    //! equal to the number of loudspeakers, the gain of the imaginary loudspeaker is kept so
+    //! its energy is discarded by the normalization.
+    template <Dimension D, typename T> class PannerLayout;
+
+    //! @brief The class finds the pair of loudspeakers that surround a direction on a circle.
+    //! @details The loudspeakers are sorted by azimuth and the pair is found with a binary
+    //! search. If the pair is separated by more than \f$\pi\f$, the direction is panned to
+    //! the nearest loudspeaker.
+    template <typename T>
+    class PannerLayout<Hoa2d, T>
+    {
+    public:
+
+        //! @brief Computes the layout.
+        //! @param nplws The number of loudspeakers.
+        //! @param azimuths The azimuths of the loudspeakers.
+        //! @param elevations Unused.
+        void compute(const size_t nplws, const T* azimuths, const T* elevations)
+        {
+            hoa_unused(elevations);
+            m_size = nplws;
+            m_sorted.resize(nplws);
+            for(size_t i = 0; i < nplws; ++i)
+            {
+                m_sorted[i] = {double(math<T>::wrap_two_pi(azimuths[i])), i};
+            }
+            std::sort(m_sorted.begin(), m_sorted.end());
+            m_azimuths.resize(nplws);
+            for(size_t i = 0; i < nplws; ++i)
+            {
+                m_azimuths[i] = m_sorted[i].first;
+            }
+        }
+
+        //! @brief Computes the gains of a direction.
+        //! @param azimuth The azimuth of the direction.
+        //! @param elevation Unused.
+        //! @param indices The indices of the loudspeakers.
+        //! @param gains The gains of the loudspeakers.
+        void pan(const T azimuth, const T elevation, size_t* indices, T* gains) const noexcept
+        {
+            hoa_unused(elevation);
+            indices[0] = indices[1] = indices[2] = m_size;
+            gains[0] = gains[1] = gains[2] = T(0);
+            if(!m_size)
+            {
+                return;
+            }
+            const double a = double(math<T>::wrap_two_pi(azimuth));
+            const size_t upper = size_t(std::upper_bound(m_azimuths.begin(), m_azimuths.end(), a) - m_azimuths.begin());
+            const size_t i1 = upper % m_size;
+            const size_t i0 = (upper + m_size - 1) % m_size;
+            const double a0 = m_azimuths[i0];
+            const double a1 = m_azimuths[i1];
+            const double det = std::sin(a1 - a0);
+            if(m_size > 1 && det > HOA_EPSILON)
+            {
+                indices[0] = m_sorted[i0].second;
+                indices[1] = m_sorted[i1].second;
+                gains[0] = T(std::max(std::sin(a1 - a) / det, 0.));
+                gains[1] = T(std::max(std::sin(a - a0) / det, 0.));
+                return;
+            }
+            const double d0 = std::cos(a - a0);
+            const double d1 = std::cos(a - a1);
+            indices[0] = m_sorted[d0 >= d1 ? i0 : i1].second;
+            gains[0] = T(1);
+        }
+
+    private:
+        size_t                                  m_size = 0ul;
+        std::vector<std::pair<double, size_t>>  m_sorted {};
+        std::vector<double>                     m_azimuths {};
+    };
+
+    //! @brief The class finds the triangle of loudspeakers that surrounds a direction on a sphere.
+    //! @details The loudspeakers are triangulated with the Voronoi class (an imaginary
+    //! loudspeaker is added at the top if there is no loudspeaker above the horizontal plane)
+    //! and the inverse of the matrix of each triangle is computed. The sphere is divided in
+    //! cells of equal area and each cell stores the triangles that cover it, so a direction
+    //! is usually panned by testing a few triangles. The triangles are all tested if none of
+    //! the triangles of the cell contains the direction, and the direction is panned to the
+    //! nearest loudspeaker if no triangle contains it.
+    template <typename T>
+    class PannerLayout<Hoa3d, T>
+    {
+    public:
+
+        //! @brief Computes the layout.
+        //! @param nplws The number of loudspeakers.
+        //! @param azimuths The azimuths of the loudspeakers.
+        //! @param elevations The elevations of the loudspeakers.
+        void compute(const size_t nplws, const T* azimuths, const T* elevations)
+        {
+            m_size = nplws;
+            m_points.clear();
+            Voronoi<Hoa3d> voronoi;
+            bool top = false;
+            for(size_t i = 0; i < nplws; i++)
+            {
+                const Voronoi<Hoa3d>::Point point = Voronoi<Hoa3d>::Point::fromPolar(1., double(azimuths[i]), double(elevations[i]));
+                top = top || point.z > HOA_EPSILON;
+                voronoi.add(point);
+                m_points.push_back(point);
+            }
+            if(!top)
+            {
+                voronoi.add(Voronoi<Hoa3d>::Point(0., 0., 1.));
+            }
+            voronoi.triangulate();
+
+            std::vector<Voronoi<Hoa3d>::Point> const& points = voronoi.getPoints();
+            m_faces.clear();
+            for(auto const& triangle : voronoi.getTriangles())
+            {
+                const auto& a = points[triangle[0]];
+                const auto& b = points[triangle[1]];
+                const auto& c = points[triangle[2]];
+                const auto bc = c.cross(b);
+                const auto ca = a.cross(c);
+                const auto ab = b.cross(a);
+                const double det = a.dot(bc);
+                if(std::abs(det) > HOA_EPSILON)
+                {
+                    Face face;
+                    face.index = triangle;
+                    face.inverse = {{bc.x / det, bc.y / det, bc.z / det,
+                                     ca.x / det, ca.y / det, ca.z / det,
+                                     ab.x / det, ab.y / det, ab.z / det}};
+                    m_faces.push_back(face);
+                }
+            }
+            computeCells(points);
+        }
+
+        //! @brief Returns the number of triangles.
+        inline size_t getNumberOfFaces() const noexcept { return m_faces.size(); }
+
+        //! @brief Computes the gains of a direction.
+        //! @param azimuth The azimuth of the direction.
+        //! @param elevation The elevation of the direction.
+        //! @param indices The indices of the loudspeakers.
+        //! @param gains The gains of the loudspeakers.
+        void pan(const T azimuth, const T elevation, size_t* indices, T* gains) const noexcept
+        {
+            const auto v = Voronoi<Hoa3d>::Point::fromPolar(1., double(azimuth), double(elevation));
+            pan(v, indices, gains);
+        }
+
+        //! @brief Computes the gains of a unit vector.
+        //! @param v The unit vector.
+        //! @param indices The indices of the loudspeakers.
+        //! @param gains The gains of the loudspeakers.
+        void pan(Voronoi<Hoa3d>::Point const& v, size_t* indices, T* gains) const noexcept
+        {
+            double values[3];
+            Face const* best = nullptr;
+            const size_t cell = getCell(v);
+            for(size_t k = m_offsets[cell]; k < m_offsets[cell+1]; ++k)
+            {
+                Face const& face = m_faces[m_candidates[k]];
+                if(solve(face, v, values) >= 0.)
+                {
+                    best = &face;
+                    break;
+                }
+            }
+            if(!best)
+            {
+                double best_min = -HOA_EPSILON;
+                double temp[3];
+                for(auto const& face : m_faces)
+                {
+                    const double gmin = solve(face, v, temp);
+                    if(gmin >= best_min)
+                    {
+                        best = &face;
+                        best_min = gmin;
+                        values[0] = temp[0]; values[1] = temp[1]; values[2] = temp[2];
+                        if(gmin >= 0.)
+                        {
+                            break;
+                        }
+                    }
+                }
+            }
+
+            if(best)
+            {
+                for(size_t k = 0; k < 3; k++)
+                {
+                    indices[k] = std::min(best->index[k], m_size);
+                    gains[k] = T(std::max(values[k], 0.));
+                }
+                return;
+            }
+
+            // Falls back to the nearest loudspeaker
+            size_t nearest = m_size;
+            double distance = -2.;
+            for(size_t j = 0; j < m_points.size(); j++)
+            {
+                if(m_points[j].dot(v) > distance)
+                {
+                    distance = m_points[j].dot(v);
+                    nearest = j;
+                }
+            }
+            indices[0] = nearest;
+            gains[0] = nearest < m_size ? T(1) : T(0);
+            indices[1] = indices[2] = m_size;
+            gains[1] = gains[2] = T(0);
+        }
+
+    private:
+
+        //! @brief The inverse of the matrix of a triangle of loudspeakers.
+        struct Face
+        {
+            std::array<size_t, 3> index;
+            std::array<double, 9> inverse;
+        };
+
+        //! @brief Computes the gains of a triangle and returns the smallest one.
+        static inline double solve(Face const& face, Voronoi<Hoa3d>::Point const& v, double* gains) noexcept
+        {
+            const double* m = face.inverse.data();
+            gains[0] = m[0] * v.x + m[1] * v.y + m[2] * v.z;
+            gains[1] = m[3] * v.x + m[4] * v.y + m[5] * v.z;
+            gains[2] = m[6] * v.x + m[7] * v.y + m[8] * v.z;
+            return std::min(gains[0], std::min(gains[1], gains[2]));
+        }
+
+        //! @brief Returns the cell of a unit vector.
+        inline size_t getCell(Voronoi<Hoa3d>::Point const& v) const noexcept
+        {
+            const double azimuth = std::atan2(v.y, v.x) + HOA_PI;
+            const size_t band = std::min(size_t((v.z + 1.) * 0.5 * double(m_bands)), m_bands - 1);
+            const size_t sector = std::min(size_t(azimuth / HOA_2PI * double(m_sectors)), m_sectors - 1);
+            return band * m_sectors + sector;
+        }
+
+        //! @brief Computes the triangles that cover each cell.
+        //! @details The cells are bands of height and sectors of azimuth. Each triangle is
+        //! bounded by the spherical cap centered on its centroid that contains its vertices
+        //! and it is stored in all the cells that intersect the bounds of the cap.
+        void computeCells(std::vector<Voronoi<Hoa3d>::Point> const& points)
+        {
+            const size_t resolution = size_t(std::ceil(std::sqrt(double(m_faces.size()))));
+            m_bands = std::min(std::max(resolution, size_t(4)), size_t(64));
+            m_sectors = m_bands * 2;
+            std::vector<std::vector<size_t>> cells(m_bands * m_sectors);
+            for(size_t k = 0; k < m_faces.size(); ++k)
+            {
+                const auto& a = points[m_faces[k].index[0]];
+                const auto& b = points[m_faces[k].index[1]];
+                const auto& c = points[m_faces[k].index[2]];
+                const auto center = (a + b + c).normalized();
+                const double cosr = std::min(center.dot(a), std::min(center.dot(b), center.dot(c)));
+                const double radius = std::acos(std::min(std::max(cosr, -1.), 1.)) + HOA_EPSILON;
+                const double elevation = std::asin(std::min(std::max(center.z, -1.), 1.));
+                const double zmin = std::sin(std::max(elevation - radius, -HOA_PI2));
+                const double zmax = std::sin(std::min(elevation + radius, HOA_PI2));
+                const size_t bmin = std::min(size_t((zmin + 1.) * 0.5 * double(m_bands)), m_bands - 1);
+                const size_t bmax = std::min(size_t((zmax + 1.) * 0.5 * double(m_bands)), m_bands - 1);
+
+                size_t smin = 0, count = m_sectors;
+                if(elevation + radius < HOA_PI2 && elevation - radius > -HOA_PI2)
+                {
+                    const double width = std::asin(std::min(std::sin(radius) / std::cos(elevation), 1.));
+                    const double azimuth = std::atan2(center.y, center.x) + HOA_PI;
+                    const double start = (azimuth - width) / HOA_2PI * double(m_sectors);
+                    const double stop = (azimuth + width) / HOA_2PI * double(m_sectors);
+                    const long first = long(std::floor(start));
+                    count = std::min(size_t(long(std::floor(stop)) - first + 1), m_sectors);
+                    smin = size_t((first % long(m_sectors) + long(m_sectors)) % long(m_sectors));
+                }
+                for(size_t band = bmin; band <= bmax; ++band)
+                {
+                    for(size_t i = 0; i < count; ++i)
+                    {
+                        cells[band * m_sectors + (smin + i) % m_sectors].push_back(k);
+                    }
+                }
+            }
+            m_offsets.assign(cells.size() + 1, 0);
+            m_candidates.clear();
+            for(size_t i = 0; i < cells.size(); ++i)
+            {
+                m_candidates.insert(m_candidates.end(), cells[i].begin(), cells[i].end());
+                m_offsets[i + 1] = m_candidates.size();
+            }
+        }
+
+        size_t                              m_size = 0ul;
+        std::vector<Voronoi<Hoa3d>::Point>  m_points {};
+        std::vector<Face>                   m_faces {};
+        size_t                              m_bands = 1ul;
+        size_t                              m_sectors = 1ul;
+        std::vector<size_t>                 m_offsets {0ul, 0ul};
+        std::vector<size_t>                 m_candidates {};
+    };
+
+    // ================================================================================ //
+    // PANNER //
+    // ================================================================================ //
+
+    //! @brief The class pans several sources directly to the loudspeakers.
+    //! @details For the sources that must be precisely localized with a few loudspeakers,
+    //! encoding to the harmonics and decoding is more expensive and less precise than
+    //! panning the sources to the closest loudspeakers. The panner uses the vector base
+    //! amplitude panning (VBAP) or the vector base intensity panning (VBIP) over the pairs
+    //! (2D) or the triangles (3D) of loudspeakers. The outputs of the panner can be mixed
+    //! with the outputs of a decoder, so the point sources are panned while the ambience is
+    //! encoded in the harmonics.<br>
+    //! The loudspeakers are defined by the plane waves and the prepare method must be
+    //! called after changing them. The gains of a source are computed when its position
+    //! changes. The block processing interpolates the gains over the block, the sample by
+    //! sample processing applies the new gains immediately.
+    template <Dimension D, typename T>
+    class Panner
+    : public ProcessorPlanewaves<D, T>
+    {
+    public:
+
+        //! @brief The panning laws.
+        enum Mode
+        {
+            Amplitude = 0,  //!< The vector base amplitude panning (the gains have a unit energy).
+            Intensity = 1   //!< The vector base intensity panning (the squared gains are panned).
+        };
+
+        //! @brief Constructor.
+        //! @param nplws The number of loudspeakers.
+        //! @param nsources The number of sources.
+        //! @param vectorsize The vector size of the block processing.
+        Panner(const size_t nplws, const size_t nsources, const size_t vectorsize = 64)
+        : ProcessorPlanewaves<D, T>(nplws)
+        , m_vector_size(vectorsize)
+        , m_sources(nsources)
+        {
+            prepare();
+        }
+
+        //! @brief Destructor.
+        ~Panner() = default;
+
+        //! @brief Returns the number of sources.
+        inline size_t getNumberOfSources() const noexcept { return m_sources.size(); }
+
+        //! @brief Returns the vector size of the block processing.
+        inline size_t getVectorSize() const noexcept { return m_vector_size; }
+
+        //! @brief Sets the panning law.
+        //! @param mode The panning law (default is amplitude).
+        void setMode(const Mode mode) noexcept
+        {
+            m_mode = mode;
+            for(size_t i = 0; i < m_sources.size(); ++i)
+            {
+                update(i);
+            }
+        }
+
+        //! @brief Returns the panning law.
+        inline Mode getMode() const noexcept { return m_mode; }
+
+        //! @brief Sets the azimuth of a source.
+        //! @param index The index of the source.
+        //! @param azimuth The azimuth.
+        void setAzimuth(const size_t index, const T azimuth) noexcept
+        {
+            m_sources[index].azimuth = azimuth;
+            update(index);
+        }
+
+        //! @brief Returns the azimuth of a source.
+        inline T getAzimuth(const size_t index) const noexcept { return m_sources[index].azimuth; }
+
+        //! @brief Sets the elevation of a source.
+        //! @param index The index of the source.
+        //! @param elevation The elevation (ignored in 2D).
+        void setElevation(const size_t index, const T elevation) noexcept
+        {
+            m_sources[index].elevation = elevation;
+            update(index);
+        }
+
+        //! @brief Returns the elevation of a source.
+        inline T getElevation(const size_t index) const noexcept { return m_sources[index].elevation; }
+
+        //! @brief Returns the gain of a source for a loudspeaker.
+        //! @param index The index of the source.
+        //! @param channel The index of the loudspeaker.
+        T getGain(const size_t index, const size_t channel) const noexcept
+        {
+            Source const& source = m_sources[index];
+            for(size_t k = 0; k < 3; ++k)
+            {
+                if(source.target.indices[k] == channel)
+                {
+                    return source.target.gains[k];
+                }
+            }
+            return T(0);
+        }
+
+        //! @brief Computes the layout of the loudspeakers.
+        //! @details You should use this method after changing the position of the loudspeakers.
+        void prepare()
+        {
+            const size_t nplws = ProcessorPlanewaves<D, T>::getNumberOfPlanewaves();
+            std::vector<T> azimuths(nplws);
+            std::vector<T> elevations(nplws);
+            for(size_t i = 0; i < nplws; ++i)
+            {
+                azimuths[i] = ProcessorPlanewaves<D, T>::getPlanewaveAzimuth(i);
+                elevations[i] = ProcessorPlanewaves<D, T>::getPlanewaveElevation(i);
+            }
+            m_layout.compute(nplws, azimuths.data(), elevations.data());
+            for(size_t i = 0; i < m_sources.size(); ++i)
+            {
+                update(i);
+                m_sources[i].current = m_sources[i].target;
+            }
+        }
+
+        //! @brief The method pans a sample of the sources.
+        //! @param inputs  The inputs array with a sample for each source.
+        //! @param outputs The outputs array with a sample for each loudspeaker.
+        void process(const T* inputs, T* outputs) noexcept override
+        {
+            const size_t nplws = ProcessorPlanewaves<D, T>::getNumberOfPlanewaves();
+            Signal<T>::clear(nplws, outputs);
+            for(size_t i = 0; i < m_sources.size(); ++i)
+            {
+                Source& source = m_sources[i];
+                source.current = source.target;
+                for(size_t k = 0; k < 3; ++k)
+                {
+                    if(source.target.indices[k] < nplws)
+                    {
+                        outputs[source.target.indices[k]] += inputs[i] * source.target.gains[k];
+                    }
+                }
+            }
+        }
+
+        //! @brief The method pans a block of the sources.
+        //! @details The gains that changed since the previous block are interpolated over
+        //! the block.
+        //! @param inputs  The inputs channels, one for each source.
+        //! @param outputs The outputs channels, one for each loudspeaker.
+        void processBlock(const T** inputs, T** outputs) noexcept
+        {
+            const size_t nplws = ProcessorPlanewaves<D, T>::getNumberOfPlanewaves();
+            const size_t vsize = m_vector_size;
+            for(size_t i = 0; i < nplws; ++i)
+            {
+                Signal<T>::clear(vsize, outputs[i]);
+            }
+            const T step = T(1) / T(vsize);
+            for(size_t i = 0; i < m_sources.size(); ++i)
+            {
+                Source& source = m_sources[i];
+                const T* input = inputs[i];
+                const bool moving = source.current != source.target;
+                for(size_t k = 0; k < 3; ++k)
+                {
+                    const size_t index = source.target.indices[k];
+                    if(index < nplws && source.target.gains[k] != T(0))
+                    {
+                        T* output = outputs[index];
+                        const T gain = source.target.gains[k];
+                        if(moving)
+                        {
+                            for(size_t j = 0; j < vsize; ++j)
+                            {
+                                output[j] += input[j] * gain * (T(j + 1) * step);
+                            }
+                        }
+                        else
+                        {
+                            for(size_t j = 0; j < vsize; ++j)
+                            {
+                                output[j] += input[j] * gain;
+                            }
+                        }
+                    }
+                }
+                if(moving)
+                {
+                    for(size_t k = 0; k < 3; ++k)
+                    {
+                        const size_t index = source.current.indices[k];
+                        if(index < nplws && source.current.gains[k] != T(0))
+                        {
+                            T* output = outputs[index];
+                            const T gain = source.current.gains[k];
+                            for(size_t j = 0; j < vsize; ++j)
+                            {
+                                output[j] += input[j] * gain * (T(1) - T(j + 1) * step);
+                            }
+                        }
+                    }
+                    source.current = source.target;
+                }
+            }
+        }
+
+    private:
+
+        struct Gains
+        {
+            std::array<size_t, 3>   indices {{0ul, 0ul, 0ul}};
+            std::array<T, 3>        gains {{T(0), T(0), T(0)}};
+
+            inline bool operator!=(Gains const& other) const noexcept
+            {
+                return indices != other.indices || gains != other.gains;
+            }
+        };
+
+        struct Source
+        {
+            T       azimuth = T(0);
+            T       elevation = T(0);
+            Gains   current {};
+            Gains   target {};
+        };
+
+        //! @brief Computes the normalized gains of a source.
+        void update(const size_t index) noexcept
+        {
+            Source& source = m_sources[index];
+            Gains& target = source.target;
+            m_layout.pan(source.azimuth, source.elevation, target.indices.data(), target.gains.data());
+            if(m_mode == Amplitude)
+            {
+                const T norm = std::sqrt(target.gains[0] * target.gains[0] + target.gains[1] * target.gains[1]
+                                         + target.gains[2] * target.gains[2]);
+                if(norm > T(0))
+                {
+                    for(auto& gain : target.gains) { gain /= norm; }
+                }
+            }
+            else
+            {
+                const T sum = target.gains[0] + target.gains[1] + target.gains[2];
+                if(sum > T(0))
+                {
+                    for(auto& gain : target.gains) { gain = std::sqrt(gain / sum); }
+                }
+            }
+        }
+
+        const size_t            m_vector_size;
+        PannerLayout<D, T>      m_layout {};
+        std::vector<Source>     m_sources;
+        Mode                    m_mode = Amplitude;
+    };
+}
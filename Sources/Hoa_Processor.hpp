@@ -58,7 +58,21 @@ namespace hoa
         //! @param order The order of decomposition, must be at least 1.
         ProcessorHarmonics(const size_t order) noexcept
         : m_order_of_decomposition(order)
-        , m_harmonics(createVector(order))
+        , m_vertical_order(order)
+        , m_harmonics(createVector(order, order))
+        {}
+
+        //! @brief The harmonics constructor for a mixed order.
+        //! @details The harmonics are all the harmonics up to the vertical order and the
+        //! horizontal harmonics (\f$\left|m\right| = l\f$) from the vertical order to the
+        //! order of decomposition, sorted in the ACN order (the vertical order is ignored in
+        //! 2D).
+        //! @param order The order of decomposition, must be at least 1.
+        //! @param vertical The vertical order, must be lower or equal to the order.
+        ProcessorHarmonics(const size_t order, const size_t vertical) noexcept
+        : m_order_of_decomposition(order)
+        , m_vertical_order(D == Hoa2d ? order : std::min(vertical, order))
+        , m_harmonics(createVector(order, m_vertical_order))
         {}
 
         //! @brief The harmonics destructor.
@@ -67,6 +81,13 @@ namespace hoa
         //! @brief Returns the order of decomposition.
         inline size_t getDecompositionOrder() const noexcept { return m_order_of_decomposition; }
 
+        //! @brief Returns the vertical order of decomposition.
+        //! @details The vertical order is the order of decomposition if the order isn't mixed.
+        inline size_t getVerticalOrder() const noexcept { return m_vertical_order; }
+
+        //! @brief Returns true if the order of decomposition is mixed.
+        inline bool isMixedOrder() const noexcept { return m_vertical_order < m_order_of_decomposition; }
+
         //! @brief Returns the number of harmonics.
         inline size_t getNumberOfHarmonics() const noexcept { return m_harmonics.size(); }
 
@@ -85,11 +106,30 @@ namespace hoa
         }
 
         //! @brief Returns the index of an harmonic given the degree and the azimuthal order.
+        //! @details For a mixed order, the method returns the number of harmonics if the
+        //! harmonic doesn't belong to the mixed order.
         //! @param degree The degree of the harmonic.
         //! @param order  The azimuthal order of the harmonic.
         inline size_t getHarmonicIndex(const size_t degree, const long order) const
         {
-            return Harmonic<D, T>::getIndex(degree, order);
+            if(!isMixedOrder())
+            {
+                return Harmonic<D, T>::getIndex(degree, order);
+            }
+            const size_t acn = size_t(Harmonic<D, T>::getIndex(degree, order));
+            for(size_t i = 0; i < m_harmonics.size(); ++i)
+            {
+                if(m_harmonics[i].getIndex() == acn) { return i; }
+            }
+            return m_harmonics.size();
+        }
+
+        //! @brief Returns the ACN index of an harmonic.
+        //! @details The ACN index is the index of the harmonic for a full order.
+        //! @param index The index of an harmonic.
+        inline size_t getHarmonicAcn(const size_t index) const
+        {
+            return m_harmonics[index].getIndex();
         }
 
         //! @brief Returns the name of an harmonic.
@@ -115,12 +155,15 @@ namespace hoa
         
     private:
         
-        static inline std::vector< Harmonic<D, T> > createVector(const size_t order)
+        static inline std::vector< Harmonic<D, T> > createVector(const size_t order, const size_t vertical)
         {
             std::vector<Harmonic<D, T>> harmonics {};
             for(size_t i = 0; i < Harmonic<D, T>::getNumberOfHarmonics(order); ++i)
             {
-                harmonics.push_back(Harmonic<D, T>(i));
+                if(Harmonic<D, T>::isInMixedOrder(Harmonic<D, T>::getDegree(i), Harmonic<D, T>::getOrder(i), vertical))
+                {
+                    harmonics.push_back(Harmonic<D, T>(i));
+                }
             }
             return harmonics;
         }
@@ -128,6 +171,7 @@ namespace hoa
     private:
         
         const size_t m_order_of_decomposition = 0ul;
+        const size_t m_vertical_order = 0ul;
         const std::vector< Harmonic<D, T> > m_harmonics;
     };
     
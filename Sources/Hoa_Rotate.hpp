@@ -11,7 +11,9 @@
 
 #pragma once
 
-#include "Hoa_Processor.hpp"
+#include "Hoa_Encoder.hpp"
+
+#include <Eigen/Dense>
 
 namespace hoa
 {
@@ -19,7 +21,7 @@ namespace hoa
     // ROTATE //
     // ================================================================================ //
     
-    //! @brief The rotate class rotates a sound field in the harmonics domain (2d available only).
+    //! @brief The rotate class rotates a sound field in the harmonics domain.
     //! @details Rotate a sound field by weighting the harmonics depending on the rotation.
     template <Dimension D, typename T>
     class Rotate
@@ -139,9 +141,323 @@ namespace hoa
     
 #endif // DOXYGEN_SHOULD_SKIP_THIS
     
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+    
     // ================================================================================ //
     // ROTATE 3D //
     // ================================================================================ //
     
-    //! @todo to be implemented..
+    //! @brief 3d specialisation.
+    //! @details The rotation doesn't mix the degrees, the harmonics of a degree \f$l\f$ are
+    //! rotated by a matrix \f$M_{l}\f$ of size \f$(2l+1)\times(2l+1)\f$. The matrices are
+    //! fitted by least squares on a set of directions \f$D\f$ spread on the sphere (a
+    //! Fibonacci lattice) so they follow the conventions of the encoder:
+    //! \f[M_{l} = Y_{l}(RD)Y_{l}(D)^{T}(Y_{l}(D)Y_{l}(D)^{T})^{-1}\f]
+    //! with \f$R\f$ the rotation and \f$Y_{l}\f$ the harmonics of the degree \f$l\f$. The
+    //! right part is computed by the constructor, a rotation only encodes the rotated
+    //! directions and doesn't allocate memory. The directions use the coordinates
+    //! \f$(\cos{\phi}\cos{\theta}, \sin{\phi}\cos{\theta}, \sin{\theta})\f$ with \f$\phi\f$ the
+    //! azimuth and \f$\theta\f$ the elevation.
+    template <typename T>
+    class Rotate<Hoa3d, T>
+    : public ProcessorHarmonics<Hoa3d, T>
+    {
+    public:
+        
+        //! @brief Constructor.
+        //! @param order The order (minimum 1).
+        Rotate(const size_t order)
+        : ProcessorHarmonics<Hoa3d, T>(order)
+        , m_encoder(order)
+        {
+            const size_t nharmos = ProcessorHarmonics<Hoa3d, T>::getNumberOfHarmonics();
+            const size_t ndirs = nharmos * 2 + 8;
+            m_directions.resize(ndirs * 3);
+            m_azimuths.resize(ndirs);
+            m_elevations.resize(ndirs);
+            m_harmonics.resize(ndirs * nharmos);
+            for(size_t k = 0; k < ndirs; ++k)
+            {
+                const double z = 1. - (2. * double(k) + 1.) / double(ndirs);
+                const double azimuth = double(k) * HOA_PI * (3. - std::sqrt(5.));
+                const double radius = std::sqrt(1. - z * z);
+                m_directions[k * 3]     = radius * std::cos(azimuth);
+                m_directions[k * 3 + 1] = radius * std::sin(azimuth);
+                m_directions[k * 3 + 2] = z;
+                m_azimuths[k]   = T(azimuth);
+                m_elevations[k] = T(std::asin(z));
+            }
+            m_encoder.processDirections(ndirs, m_azimuths.data(), m_elevations.data(), m_harmonics.data());
+            
+            // the projections of the directions on the harmonics of each degree
+            m_projections.resize(ndirs * nharmos);
+            m_matrices.resize(getMatricesSize(order));
+            for(size_t l = 0; l <= order; ++l)
+            {
+                const size_t size = l * 2 + 1;
+                Eigen::MatrixXd harmonics(size, ndirs);
+                for(size_t k = 0; k < ndirs; ++k)
+                {
+                    for(size_t i = 0; i < size; ++i)
+                    {
+                        harmonics(i, k) = double(m_harmonics[k * nharmos + l * l + i]);
+                    }
+                }
+                const Eigen::MatrixXd projections = (harmonics * harmonics.transpose()).ldlt().solve(harmonics);
+                for(size_t k = 0; k < ndirs; ++k)
+                {
+                    for(size_t i = 0; i < size; ++i)
+                    {
+                        m_projections[l * l * ndirs + k * size + i] = T(projections(i, k));
+                    }
+                }
+            }
+            const T identity[9] = {T(1), T(0), T(0), T(0), T(1), T(0), T(0), T(0), T(1)};
+            setMatrix(identity);
+            m_previous = m_matrices;
+            m_temp.resize((order * 2 + 1) * 16);
+        }
+        
+        //! @brief Destructor.
+        ~Rotate() = default;
+        
+        //! @brief This method sets the rotation with a matrix.
+        //! @details The matrix is a 3x3 orthogonal matrix stored row by row, it moves the
+        //! direction \f$d\f$ of a source to the direction \f$Rd\f$.
+        //! @param matrix The matrix of the rotation.
+        void setMatrix(const T* matrix) noexcept
+        {
+            const size_t order   = ProcessorHarmonics<Hoa3d, T>::getDecompositionOrder();
+            const size_t nharmos = ProcessorHarmonics<Hoa3d, T>::getNumberOfHarmonics();
+            const size_t ndirs   = m_azimuths.size();
+            std::copy(matrix, matrix + 9, m_rotation);
+            for(size_t k = 0; k < ndirs; ++k)
+            {
+                const double* d = m_directions.data() + k * 3;
+                const double x = double(matrix[0]) * d[0] + double(matrix[1]) * d[1] + double(matrix[2]) * d[2];
+                const double y = double(matrix[3]) * d[0] + double(matrix[4]) * d[1] + double(matrix[5]) * d[2];
+                const double z = double(matrix[6]) * d[0] + double(matrix[7]) * d[1] + double(matrix[8]) * d[2];
+                m_azimuths[k]   = T(std::atan2(y, x));
+                m_elevations[k] = T(std::asin(std::max(-1., std::min(1., z))));
+            }
+            m_encoder.processDirections(ndirs, m_azimuths.data(), m_elevations.data(), m_harmonics.data());
+            
+            for(size_t l = 0; l <= order; ++l)
+            {
+                const size_t size = l * 2 + 1;
+                T* result = m_matrices.data() + getMatricesSize(l) - size * size;
+                std::fill(result, result + size * size, T(0));
+                for(size_t k = 0; k < ndirs; ++k)
+                {
+                    const T* rotated = m_harmonics.data() + k * nharmos + l * l;
+                    const T* projection = m_projections.data() + l * l * ndirs + k * size;
+                    for(size_t i = 0; i < size; ++i)
+                    {
+                        for(size_t j = 0; j < size; ++j)
+                        {
+                            result[i * size + j] += rotated[i] * projection[j];
+                        }
+                    }
+                }
+            }
+        }
+        
+        //! @brief This method sets the rotation with the yaw, the pitch and the roll.
+        //! @details See getMatrix(const T, const T, const T, T*).
+        //! @param yaw   The rotation around the z axis.
+        //! @param pitch The rotation around the y axis.
+        //! @param roll  The rotation around the x axis.
+        void setYawPitchRoll(const T yaw, const T pitch, const T roll) noexcept
+        {
+            T matrix[9];
+            getMatrix(yaw, pitch, roll, matrix);
+            setMatrix(matrix);
+        }
+        
+        //! @brief This method sets the rotation with a unit quaternion.
+        //! @param w The real part of the quaternion.
+        //! @param x The x part of the quaternion.
+        //! @param y The y part of the quaternion.
+        //! @param z The z part of the quaternion.
+        void setQuaternion(const T w, const T x, const T y, const T z) noexcept
+        {
+            T matrix[9];
+            getMatrix(w, x, y, z, matrix);
+            setMatrix(matrix);
+        }
+        
+        //! @brief Computes the matrix of a rotation from the yaw, the pitch and the roll.
+        //! @details The rotation is \f$R = R_{z}(yaw)R_{y}(pitch)R_{x}(roll)\f$: the yaw
+        //! increases the azimuths (as the 2d rotation), the pitch raises the direction of
+        //! the azimuth 0 and the roll raises the direction of the azimuth \f$\pi/2\f$. The
+        //! angles are in radian.
+        //! @param yaw    The rotation around the z axis.
+        //! @param pitch  The rotation around the y axis.
+        //! @param roll   The rotation around the x axis.
+        //! @param matrix The 3x3 matrix stored row by row.
+        static void getMatrix(const T yaw, const T pitch, const T roll, T* matrix) noexcept
+        {
+            const T cy = std::cos(yaw),   sy = std::sin(yaw);
+            const T cp = std::cos(pitch), sp = std::sin(pitch);
+            const T cr = std::cos(roll),  sr = std::sin(roll);
+            matrix[0] = cy * cp; matrix[1] = -cy * sp * sr - sy * cr; matrix[2] = -cy * sp * cr + sy * sr;
+            matrix[3] = sy * cp; matrix[4] = -sy * sp * sr + cy * cr; matrix[5] = -sy * sp * cr - cy * sr;
+            matrix[6] = sp;      matrix[7] = cp * sr;                 matrix[8] = cp * cr;
+        }
+        
+        //! @brief Computes the matrix of a rotation from a unit quaternion.
+        //! @param w      The real part of the quaternion.
+        //! @param x      The x part of the quaternion.
+        //! @param y      The y part of the quaternion.
+        //! @param z      The z part of the quaternion.
+        //! @param matrix The 3x3 matrix stored row by row.
+        static void getMatrix(const T w, const T x, const T y, const T z, T* matrix) noexcept
+        {
+            matrix[0] = T(1) - T(2) * (y * y + z * z);
+            matrix[1] = T(2) * (x * y - w * z);
+            matrix[2] = T(2) * (x * z + w * y);
+            matrix[3] = T(2) * (x * y + w * z);
+            matrix[4] = T(1) - T(2) * (x * x + z * z);
+            matrix[5] = T(2) * (y * z - w * x);
+            matrix[6] = T(2) * (x * z - w * y);
+            matrix[7] = T(2) * (y * z + w * x);
+            matrix[8] = T(1) - T(2) * (x * x + y * y);
+        }
+        
+        //! @brief This method sets the angle of the rotation around the z axis.
+        //! @param yaw The yaw value.
+        inline void setYaw(const T yaw) noexcept
+        {
+            setYawPitchRoll(yaw, T(0), T(0));
+        }
+        
+        //! @brief Get the angle of the rotation around the z axis, the yaw value.
+        //! @return The yaw value in radian between 0 and 2π.
+        inline T getYaw() const noexcept
+        {
+            return math<T>::wrap_two_pi(std::atan2(m_rotation[3], m_rotation[0]));
+        }
+        
+        //! @brief Gets the matrix of the rotation.
+        //! @return The 3x3 matrix stored row by row.
+        inline const T* getMatrix() const noexcept
+        {
+            return m_rotation;
+        }
+        
+        //! @brief Gets the rotation matrix of the harmonics of a degree.
+        //! @param degree The degree.
+        //! @return The \f$(2l+1)\times(2l+1)\f$ matrix stored row by row.
+        inline const T* getDegreeMatrix(const size_t degree) const noexcept
+        {
+            const size_t size = degree * 2 + 1;
+            return m_matrices.data() + getMatricesSize(degree) - size * size;
+        }
+        
+        //! @brief This method performs the rotation.
+        //! @details You should use this method for in-place or not-in-place processing and sample by sample.
+        //! The inputs array and outputs array contains the spherical harmonics samples.
+        //! The minimum size must be the number of harmonics.
+        //! @param inputs   The input array.
+        //! @param outputs  The output array.
+        void process(const T* inputs, T* outputs) noexcept override
+        {
+            const size_t order = ProcessorHarmonics<Hoa3d, T>::getDecompositionOrder();
+            T* temp = m_temp.data();
+            outputs[0] = inputs[0];
+            for(size_t l = 1; l <= order; ++l)
+            {
+                const size_t size = l * 2 + 1;
+                const T* matrix = getDegreeMatrix(l);
+                std::copy(inputs + l * l, inputs + l * l + size, temp);
+                for(size_t i = 0; i < size; ++i)
+                {
+                    outputs[l * l + i] = Signal<T>::dot(size, matrix + i * size, temp);
+                }
+            }
+        }
+        
+        //! @brief This method performs the rotation of a block.
+        //! @details The matrices are interpolated linearly over the block from the rotation
+        //! of the previous block to the current rotation, the rotation of a block is reached
+        //! at its last sample. The samples are processed by groups of 16 in a local buffer,
+        //! so the method can be used for in-place or not-in-place processing.
+        //! @param vectorsize The vector size.
+        //! @param inputs     The inputs channels.
+        //! @param outputs    The outputs channels.
+        void processBlock(const size_t vectorsize, const T** inputs, T** outputs) noexcept
+        {
+            const size_t order = ProcessorHarmonics<Hoa3d, T>::getDecompositionOrder();
+            const T step = T(1) / T(vectorsize);
+            T* temp = m_temp.data();
+            Signal<T>::copy(vectorsize, inputs[0], outputs[0]);
+            for(size_t start = 0; start < vectorsize; start += 16)
+            {
+                const size_t count = std::min(size_t(16), vectorsize - start);
+                T ramp[16];
+                for(size_t n = 0; n < 16; ++n)
+                {
+                    ramp[n] = T(start + n + 1) * step;
+                }
+                for(size_t l = 1; l <= order; ++l)
+                {
+                    const size_t size = l * 2 + 1;
+                    const size_t offset = getMatricesSize(l) - size * size;
+                    const T* current = m_matrices.data() + offset;
+                    const T* previous = m_previous.data() + offset;
+                    for(size_t i = 0; i < size; ++i)
+                    {
+                        T acc[16] = {};
+                        for(size_t j = 0; j < size; ++j)
+                        {
+                            const T* input = inputs[l * l + j] + start;
+                            const T gain = previous[i * size + j];
+                            const T delta = current[i * size + j] - gain;
+                            if(count == 16)
+                            {
+                                for(size_t n = 0; n < 16; ++n)
+                                {
+                                    acc[n] += (gain + delta * ramp[n]) * input[n];
+                                }
+                            }
+                            else
+                            {
+                                for(size_t n = 0; n < count; ++n)
+                                {
+                                    acc[n] += (gain + delta * ramp[n]) * input[n];
+                                }
+                            }
+                        }
+                        std::copy(acc, acc + count, temp + i * 16);
+                    }
+                    for(size_t i = 0; i < size; ++i)
+                    {
+                        std::copy(temp + i * 16, temp + i * 16 + count, outputs[l * l + i] + start);
+                    }
+                }
+            }
+            m_previous = m_matrices;
+        }
+        
+    private:
+        
+        //! @brief Returns the size of the matrices of the degrees up to an order.
+        static constexpr size_t getMatricesSize(const size_t order) noexcept
+        {
+            return (order + 1) * (2 * order + 1) * (2 * order + 3) / 3;
+        }
+        
+        Encoder<Hoa3d, T>   m_encoder;
+        std::vector<double> m_directions {};
+        std::vector<T>      m_azimuths {};
+        std::vector<T>      m_elevations {};
+        std::vector<T>      m_harmonics {};
+        std::vector<T>      m_projections {};
+        std::vector<T>      m_matrices {};
+        std::vector<T>      m_previous {};
+        std::vector<T>      m_temp {};
+        T                   m_rotation[9];
+    };
+    
+#endif // DOXYGEN_SHOULD_SKIP_THIS
 }
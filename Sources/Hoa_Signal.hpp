@@ -130,6 +130,137 @@ namespace hoa
             }
         }
         
+        //! @brief Multiplies the transpose of a matrix by a vector.
+        //! @details The matrix is stored column by column, each column of the matrix is
+        //! scaled by an element of the input vector and added to the output vector, thus the
+        //! loops run across the elements of the output vector.
+        //! @param colsize  The size of the input vector and the number of columns.
+        //! @param rowsize  The size of the output vector and the number of rows.
+        //! @param in       The input vector.
+        //! @param in2      The input matrix stored column by column.
+        //! @param output   The output vector.
+        static inline void mulTransposed(const size_t colsize,
+                                         const size_t rowsize,
+                                         const T* in, const T* in2, T* output) noexcept
+        {
+            clear(rowsize, output);
+            for(size_t i = 0ul; i < colsize; i++, in2 += rowsize)
+            {
+                const T g0 = in[i];
+                if(g0 != 0)
+                {
+                    const T* in1 = in2;
+                    T* out = output;
+                    for(size_t j = rowsize>>3; j; --j, in1 += 8, out += 8)
+                    {
+                        out[0] += in1[0] * g0; out[1] += in1[1] * g0;
+                        out[2] += in1[2] * g0; out[3] += in1[3] * g0;
+                        out[4] += in1[4] * g0; out[5] += in1[5] * g0;
+                        out[6] += in1[6] * g0; out[7] += in1[7] * g0;
+                    }
+                    for(size_t j = rowsize&7; j; --j, in1++, out++)
+                    {
+                        out[0] += in1[0] * g0;
+                    }
+                }
+            }
+        }
+        
+        //! @brief The number of rows of a panel of a packed matrix.
+        static constexpr size_t panelsize() noexcept { return 4ul; }
+        
+        //! @brief Returns the size of a packed matrix.
+        //! @param colsize  The number of columns of the matrix.
+        //! @param rowsize  The number of rows of the matrix.
+        static constexpr size_t packsize(const size_t colsize, const size_t rowsize) noexcept
+        {
+            return ((rowsize + panelsize() - 1ul) / panelsize()) * panelsize() * colsize;
+        }
+        
+        //! @brief Packs a matrix in panels of rows for the block multiplication.
+        //! @details The rows of the matrix are grouped by panels of 4 rows and the coefficients
+        //! of a panel are interleaved column by column, the missing rows of the last panel
+        //! are filled with zeros. The size of the packed matrix is given by packsize().
+        //! @param colsize  The number of columns of the matrix.
+        //! @param rowsize  The number of rows of the matrix.
+        //! @param matrix   The matrix stored row by row.
+        //! @param packed   The packed matrix.
+        static inline void pack(const size_t colsize, const size_t rowsize, const T* matrix, T* packed) noexcept
+        {
+            const size_t npanels = (rowsize + panelsize() - 1ul) / panelsize();
+            for(size_t i = 0ul; i < npanels; i++)
+            {
+                for(size_t j = 0ul; j < colsize; j++)
+                {
+                    for(size_t k = 0ul; k < panelsize(); k++, packed++)
+                    {
+                        const size_t row = i * panelsize() + k;
+                        *packed = (row < rowsize) ? matrix[row * colsize + j] : T(0);
+                    }
+                }
+            }
+        }
+        
+        //! @brief Multiplies a packed matrix by a block of vectors.
+        //! @details Computes the product of a matrix of rowsize x colsize by a matrix of
+        //! colsize x vectorsize. The block of input vectors and the block of output vectors
+        //! are arrays of channels (the signals are not interleaved). The computation is tiled
+        //! by panels of 4 rows and 8 samples so the accumulators stay in the registers and each
+        //! coefficient of the matrix is loaded once per tile instead of once per sample.
+        //! @param colsize      The number of columns of the matrix and the number of input channels.
+        //! @param rowsize      The number of rows of the matrix and the number of output channels.
+        //! @param vectorsize   The number of samples of the channels.
+        //! @param packed       The matrix packed with the pack() method.
+        //! @param inputs       The input channels.
+        //! @param outputs      The output channels.
+        static inline void mul(const size_t colsize, const size_t rowsize, const size_t vectorsize,
+                               const T* packed, const T* const* inputs, T* const* outputs) noexcept
+        {
+            const size_t npanels = (rowsize + panelsize() - 1ul) / panelsize();
+            for(size_t i = 0ul; i < npanels; i++, packed += colsize * panelsize())
+            {
+                const size_t row    = i * panelsize();
+                const size_t nrows  = std::min(panelsize(), rowsize - row);
+                size_t n = 0ul;
+                for(; n + 8ul <= vectorsize; n += 8ul)
+                {
+                    T acc[4][8] = {};
+                    const T* a = packed;
+                    for(size_t j = 0ul; j < colsize; j++, a += 4)
+                    {
+                        const T* x = inputs[j] + n;
+                        for(size_t k = 0ul; k < 4ul; k++)
+                        {
+                            const T g0 = a[k];
+                            acc[k][0] += x[0] * g0; acc[k][1] += x[1] * g0;
+                            acc[k][2] += x[2] * g0; acc[k][3] += x[3] * g0;
+                            acc[k][4] += x[4] * g0; acc[k][5] += x[5] * g0;
+                            acc[k][6] += x[6] * g0; acc[k][7] += x[7] * g0;
+                        }
+                    }
+                    for(size_t k = 0ul; k < nrows; k++)
+                    {
+                        copy(8ul, acc[k], outputs[row + k] + n);
+                    }
+                }
+                for(; n < vectorsize; n++)
+                {
+                    T acc[4] = {};
+                    const T* a = packed;
+                    for(size_t j = 0ul; j < colsize; j++, a += 4)
+                    {
+                        const T x = inputs[j][n];
+                        acc[0] += x * a[0]; acc[1] += x * a[1];
+                        acc[2] += x * a[2]; acc[3] += x * a[3];
+                    }
+                    for(size_t k = 0ul; k < nrows; k++)
+                    {
+                        outputs[row + k][n] = acc[k];
+                    }
+                }
+            }
+        }
+        
         //! @brief Gets the maximum of the absolute values of a vector.
         //! @param   vectorsize   The size of the vector.
         //! @param   vector       The vector.
@@ -245,6 +376,21 @@ namespace hoa
             }
         }
         
+        //! @brief Replaces two vectors by their sum and their difference.
+        //! @details Computes \f$a = a + b\f$ and \f$b = a - b\f$ value by value.
+        //! @param   size   The size of the vectors.
+        //! @param   a      The first vector.
+        //! @param   b      The second vector.
+        static inline void butterfly(const size_t size, T* a, T* b) noexcept
+        {
+            for(size_t i = 0ul; i < size; i++)
+            {
+                const T sum = a[i] + b[i];
+                b[i] = a[i] - b[i];
+                a[i] = sum;
+            }
+        }
+        
         //! @brief Computes the dot product of two vectors.
         //! @details Computes the dot product of two vectors.
         //! @param   size   The size of the vectors.
@@ -270,5 +416,136 @@ namespace hoa
             return result;
         }
     };
+    
+    // ================================================================================ //
+    // SPARSE MATRIX //
+    // ================================================================================ //
+    
+    //! @brief The class stores a matrix in the compressed sparse row format.
+    //! @details The class stores only the coefficients of a matrix that are not negligible
+    //! and multiplies the vectors with these coefficients. It should be used when most of
+    //! the coefficients of a matrix are null, otherwise the dense products of the Signal
+    //! class are faster. The matrices of the decoders are dense (the AllRAD matrices of the
+    //! usual layouts have more than 99% of non-negligible coefficients), so the class is only
+    //! an opt-in for the matrices that are pruned on purpose.
+    template<typename T>
+    class SparseMatrix
+    {
+    public:
+        
+        //! @brief Compresses a matrix.
+        //! @details The coefficients with an absolute value lower or equal to the tolerance
+        //! multiplied by the largest absolute value of the matrix are ignored.
+        //! @param rows The number of rows.
+        //! @param columns The number of columns.
+        //! @param matrix The matrix stored row by row.
+        //! @param tolerance The relative tolerance.
+        //! @return The density of the matrix (the ratio of the stored coefficients).
+        T compress(const size_t rows, const size_t columns, const T* matrix, const T tolerance)
+        {
+            T largest = T(0);
+            for(size_t i = 0; i < rows * columns; ++i)
+            {
+                largest = std::max(largest, std::abs(matrix[i]));
+            }
+            const T threshold = largest * tolerance;
+            
+            m_rows = rows;
+            m_columns = columns;
+            m_offsets.resize(rows + 1);
+            m_indices.clear();
+            m_values.clear();
+            for(size_t i = 0; i < rows; ++i)
+            {
+                m_offsets[i] = m_values.size();
+                for(size_t j = 0; j < columns; ++j)
+                {
+                    const T value = matrix[i * columns + j];
+                    if(value != T(0) && std::abs(value) > threshold)
+                    {
+                        m_indices.push_back(j);
+                        m_values.push_back(value);
+                    }
+                }
+            }
+            m_offsets[rows] = m_values.size();
+            return getDensity();
+        }
+        
+        //! @brief Returns the ratio of the stored coefficients.
+        inline T getDensity() const noexcept
+        {
+            return (m_rows && m_columns) ? T(m_values.size()) / T(m_rows * m_columns) : T(0);
+        }
+        
+        //! @brief Returns the number of stored coefficients.
+        inline size_t getNumberOfCoefficients() const noexcept { return m_values.size(); }
+        
+        //! @brief Multiplies a vector by the matrix.
+        //! @param input The input vector with a value for each column.
+        //! @param output The output vector with a value for each row.
+        void mul(const T* input, T* output) const noexcept
+        {
+            const size_t* indices = m_indices.data();
+            const T* values = m_values.data();
+            for(size_t i = 0; i < m_rows; ++i)
+            {
+                T result = T(0);
+                for(size_t k = m_offsets[i]; k < m_offsets[i+1]; ++k)
+                {
+                    result += values[k] * input[indices[k]];
+                }
+                output[i] = result;
+            }
+        }
+        
+        //! @brief Multiplies a block of vectors by the matrix.
+        //! @details The coefficients of a row are applied by groups of four so each output
+        //! vector is read and written once for four inputs vectors. The outputs must not
+        //! share memory with the inputs.
+        //! @param vectorsize The number of samples of each channel.
+        //! @param inputs The input channels, one for each column.
+        //! @param outputs The output channels, one for each row.
+        void mul(const size_t vectorsize, const T* const* inputs, T* const* outputs) const noexcept
+        {
+            const size_t* indices = m_indices.data();
+            const T* values = m_values.data();
+            for(size_t i = 0; i < m_rows; ++i)
+            {
+                T* output = outputs[i];
+                size_t k = m_offsets[i];
+                const size_t end = m_offsets[i+1];
+                Signal<T>::clear(vectorsize, output);
+                for(; k + 4 <= end; k += 4)
+                {
+                    const T* in0 = inputs[indices[k]];
+                    const T* in1 = inputs[indices[k+1]];
+                    const T* in2 = inputs[indices[k+2]];
+                    const T* in3 = inputs[indices[k+3]];
+                    const T v0 = values[k], v1 = values[k+1], v2 = values[k+2], v3 = values[k+3];
+                    for(size_t j = 0; j < vectorsize; ++j)
+                    {
+                        output[j] += v0 * in0[j] + v1 * in1[j] + v2 * in2[j] + v3 * in3[j];
+                    }
+                }
+                for(; k < end; ++k)
+                {
+                    const T* in = inputs[indices[k]];
+                    const T v = values[k];
+                    for(size_t j = 0; j < vectorsize; ++j)
+                    {
+                        output[j] += v * in[j];
+                    }
+                }
+            }
+        }
+        
+    private:
+        
+        size_t              m_rows = 0ul;
+        size_t              m_columns = 0ul;
+        std::vector<size_t> m_offsets {};
+        std::vector<size_t> m_indices {};
+        std::vector<T>      m_values {};
+    };
 }
-
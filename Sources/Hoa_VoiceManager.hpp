@@ -0,0 +1,293 @@
+/*
+// Copyright (c) 2012-2017 CICM - Universite Paris 8 - Labex Arts H2H.
+// Authors :
+// 2012: Pierre Guillot, Eliott Paris & Julien Colafrancesco.
+// 2012-2015: Pierre Guillot & Eliott Paris.
+// 2015: Pierre Guillot & Eliott Paris & Thomas Le Meur (Light version)
+// 2016-2017: Pierre Guillot.
+// For information on usage and redistribution, and for a DISCLAIMER OF ALL
+// WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+*/
+
+#pragma once
+
+#include "Hoa_MultiEncoder.hpp"
+
+namespace hoa
+{
+    // ================================================================================ //
+    // VOICE MANAGER //
+    // ================================================================================ //
+
+    //! @brief The class renders only the most important sources of a multi encoder.
+    //! @details The voice manager ranks the sources with a priority defined by:
+    //! \f[P_{i} = L_{i} \times G(\rho_{i}) \times U_{i}\f]
+    //! with \f$L_{i}\f$ the loudness of the source (the RMS of its last block), \f$G(\rho_{i})\f$
+    //! the distance attenuation of the encoder (\f$\frac{1}{\rho}\f$ beyond the unit circle or
+    //! sphere, \f$1\f$ inside) and \f$U_{i}\f$ the user priority. Only the \f$K\f$ sources with
+    //! the highest priority (the voices) are encoded at the full order, the other sources are
+    //! culled and can optionally be mixed into a bed encoded at the first order. When a voice
+    //! is stolen, the outgoing source fades out and the incoming source fades in over a
+    //! number of samples, and the bed crossfades in the opposite direction.<br>
+    //! The ranking is performed by the update() method that should be called once per block
+    //! of samples while the process() method is called for each sample.
+    template <Dimension D, typename T>
+    class VoiceManager
+    : public MultiEncoder<D, T>
+    {
+    public:
+
+        //! @brief Constructor.
+        //! @param order The order.
+        //! @param nsources The number of sources.
+        //! @param nvoices The maximum number of sources encoded at the full order.
+        VoiceManager(size_t order, size_t nsources, size_t nvoices)
+        : MultiEncoder<D, T>(order, nsources)
+        , m_nvoices(nvoices)
+        , m_voices(nsources)
+        , m_bed_temp(Harmonic<D, T>::getNumberOfHarmonics(1))
+        {
+            m_ranking.reserve(nsources);
+            m_rendered.reserve(nsources);
+            m_bedded.reserve(nsources);
+            m_bed_encoders.reserve(nsources);
+            for(size_t i = 0; i < nsources; ++i)
+            {
+                m_bed_encoders.emplace_back(1);
+            }
+
+            update();
+            for(auto& voice : m_voices)
+            {
+                voice.gain = voice.target;
+            }
+        }
+
+        //! @brief Destructor.
+        ~VoiceManager() = default;
+
+        //! @brief Sets the maximum number of sources encoded at the full order.
+        //! @param nvoices The number of voices.
+        inline void setNumberOfVoices(const size_t nvoices) noexcept { m_nvoices = nvoices; }
+
+        //! @brief Returns the maximum number of sources encoded at the full order.
+        inline size_t getNumberOfVoices() const noexcept { return m_nvoices; }
+
+        //! @brief Sets the user priority of a source.
+        //! @param index The index of the source.
+        //! @param priority The priority (must be positive, default is 1).
+        inline void setPriority(const size_t index, const T priority) noexcept
+        {
+            m_voices[index].priority = std::max(priority, T(0));
+        }
+
+        //! @brief Returns the user priority of a source.
+        inline T getPriority(const size_t index) const noexcept { return m_voices[index].priority; }
+
+        //! @brief Returns the loudness of a source measured during the last update.
+        inline T getLoudness(const size_t index) const noexcept { return m_voices[index].loudness; }
+
+        //! @brief Sets the number of samples of the fade-in and fade-out on voice steals.
+        //! @param nsamples The number of samples (0 means no fade).
+        inline void setFadeLength(const size_t nsamples) noexcept { m_fade_length = nsamples; }
+
+        //! @brief Returns the number of samples of the fade-in and fade-out on voice steals.
+        inline size_t getFadeLength() const noexcept { return m_fade_length; }
+
+        //! @brief Enables or disables the mix of the culled sources into the first order bed.
+        //! @param state The bed state.
+        inline void setBed(const bool state) noexcept { m_bed = state; }
+
+        //! @brief Returns the state of the first order bed.
+        inline bool getBed() const noexcept { return m_bed; }
+
+        //! @brief Returns true if a source is currently encoded at the full order.
+        //! @param index The index of the source.
+        inline bool isVoiceActive(const size_t index) const noexcept
+        {
+            return m_voices[index].gain > T(0) || m_voices[index].target > T(0);
+        }
+
+        //! @brief Returns the number of sources currently encoded at the full order.
+        //! @details The sources that are fading out are considered as active.
+        size_t getNumberOfActiveVoices() const noexcept
+        {
+            size_t count = 0;
+            for(auto index : m_rendered)
+            {
+                count += size_t(isVoiceActive(index));
+            }
+            return count;
+        }
+
+        //! @brief Returns the number of voices stolen since the creation or the last reset.
+        inline size_t getNumberOfSteals() const noexcept { return m_steals; }
+
+        //! @brief Resets the counter of voice steals.
+        inline void resetNumberOfSteals() noexcept { m_steals = 0; }
+
+        //! @brief Ranks the sources and allocates the voices.
+        //! @details The method should be called once per block, it computes the loudness of
+        //! the sources from the samples processed since the previous call, ranks the sources
+        //! and starts the fades of the stolen voices. The method doesn't allocate memory.
+        void update() noexcept
+        {
+            const size_t nsources = MultiEncoder<D, T>::getNumberOfSources();
+            const T count = m_samples ? T(m_samples) : T(1);
+
+            m_ranking.clear();
+            for(size_t i = 0; i < nsources; ++i)
+            {
+                Voice& voice = m_voices[i];
+                voice.loudness = std::max(std::sqrt(voice.energy / count), voice.loudness * release());
+                voice.energy = T(0);
+                voice.selected = false;
+                if(!MultiEncoder<D, T>::getMute(i))
+                {
+                    const T radius = MultiEncoder<D, T>::getRadius(i);
+                    const T attenuation = radius > T(1) ? T(1) / radius : T(1);
+                    const T hold = voice.target > T(0) ? T(1) + hysteresis() : T(1);
+                    voice.score = voice.loudness * attenuation * voice.priority * hold;
+                    m_ranking.push_back(i);
+                }
+            }
+            m_samples = 0;
+
+            const size_t nselected = std::min(m_nvoices, m_ranking.size());
+            if(nselected < m_ranking.size())
+            {
+                std::nth_element(m_ranking.begin(), m_ranking.begin() + long(nselected), m_ranking.end(),
+                                 [this](size_t a, size_t b) { return m_voices[a].score > m_voices[b].score; });
+            }
+            for(size_t i = 0; i < nselected; ++i)
+            {
+                m_voices[m_ranking[i]].selected = true;
+            }
+
+            m_rendered.clear();
+            m_bedded.clear();
+            const T step = m_fade_length ? T(1) / T(m_fade_length) : T(1);
+            for(size_t i = 0; i < nsources; ++i)
+            {
+                Voice& voice = m_voices[i];
+                const bool muted = MultiEncoder<D, T>::getMute(i);
+                const T target = voice.selected ? T(1) : T(0);
+                if(target != voice.target)
+                {
+                    if(target < voice.target && !muted)
+                    {
+                        ++m_steals;
+                    }
+                    voice.target = target;
+                    voice.step = step;
+                }
+                if(muted || !m_fade_length)
+                {
+                    voice.gain = voice.target;
+                }
+                if(voice.gain > T(0) || voice.target > T(0))
+                {
+                    m_rendered.push_back(i);
+                }
+                if(m_bed && !muted && (voice.gain < T(1) || voice.target < T(1)))
+                {
+                    Encoder<D, T>& bed = m_bed_encoders[i];
+                    Encoder<D, T> const& encoder = *MultiEncoder<D, T>::m_encoders[i].encoder;
+                    if(bed.getRadius() != encoder.getRadius()) { bed.setRadius(encoder.getRadius()); }
+                    if(bed.getAzimuth() != encoder.getAzimuth()) { bed.setAzimuth(encoder.getAzimuth()); }
+                    if(bed.getElevation() != encoder.getElevation()) { bed.setElevation(encoder.getElevation()); }
+                    m_bedded.push_back(i);
+                }
+            }
+        }
+
+        //! @brief The method performs the encoding of the harmonics signal.
+        //! @details The inputs array contains the samples of the sources to encode and the
+        //! outputs array contains the spherical harmonics samples thus the minimum size of
+        //! the array must be the number of sources and the number of harmonics. Only the
+        //! voices are encoded at the full order, the culled sources are encoded in the first
+        //! harmonics if the bed is enabled.
+        //! @param input   The inputs array.
+        //! @param outputs The outputs array.
+        void process(const T* input, T* outputs) noexcept override
+        {
+            const size_t nsources   = MultiEncoder<D, T>::getNumberOfSources();
+            const size_t nharmos    = MultiEncoder<D, T>::getNumberOfHarmonics();
+            T* temp                 = MultiEncoder<D, T>::m_temp;
+            Signal<T>::clear(nharmos, outputs);
+
+            for(size_t i = 0; i < nsources; ++i)
+            {
+                m_voices[i].energy += input[i] * input[i];
+            }
+            ++m_samples;
+
+            for(auto index : m_rendered)
+            {
+                Voice& voice = m_voices[index];
+                if(voice.gain < voice.target)
+                {
+                    voice.gain = std::min(voice.gain + voice.step, voice.target);
+                }
+                else if(voice.gain > voice.target)
+                {
+                    voice.gain = std::max(voice.gain - voice.step, voice.target);
+                }
+                if(voice.gain > T(0))
+                {
+                    const T sample = input[index] * voice.gain;
+                    MultiEncoder<D, T>::m_encoders[index].encoder->process(&sample, temp);
+                    MultiEncoder<D, T>::sigadd(nharmos, temp, outputs);
+                }
+            }
+
+            if(m_bed)
+            {
+                const size_t nbed = m_bed_temp.size();
+                for(auto index : m_bedded)
+                {
+                    const T gain = T(1) - m_voices[index].gain;
+                    if(gain > T(0))
+                    {
+                        const T sample = input[index] * gain;
+                        m_bed_encoders[index].process(&sample, m_bed_temp.data());
+                        MultiEncoder<D, T>::sigadd(nbed, m_bed_temp.data(), outputs);
+                    }
+                }
+            }
+        }
+
+    private:
+
+        //! @brief The decay factor of the loudness between two updates.
+        static constexpr T release() noexcept { return T(0.9); }
+
+        //! @brief The priority bonus of the current voices that avoids voice thrashing.
+        static constexpr T hysteresis() noexcept { return T(0.25); }
+
+        struct Voice
+        {
+            T priority  = T(1);
+            T energy    = T(0);
+            T loudness  = T(0);
+            T score     = T(0);
+            T gain      = T(0);
+            T target    = T(0);
+            T step      = T(1);
+            bool selected = false;
+        };
+
+        size_t  m_nvoices = 0ul;
+        size_t  m_fade_length = 0ul;
+        size_t  m_samples = 0ul;
+        size_t  m_steals = 0ul;
+        bool    m_bed = false;
+
+        std::vector<Voice>          m_voices {};
+        std::vector<size_t>         m_ranking {};
+        std::vector<size_t>         m_rendered {};
+        std::vector<size_t>         m_bedded {};
+        std::vector<Encoder<D, T>>  m_bed_encoders {};
+        std::vector<T>              m_bed_temp {};
+    };
+}
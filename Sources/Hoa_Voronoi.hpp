@@ -14,6 +14,8 @@
 #include "Hoa_Defs.hpp"
 #include "Hoa_Math.hpp"
 
+#include <array>
+
 //! @cond
 
 namespace hoa
@@ -353,7 +355,48 @@ namespace hoa
             return p1.z < 0.;
         }
 
-        std::vector<Point>       m_points;
+        //! Calls a function for each triangle of the Delaunay triangulation of the points.
+        template <typename Function>
+        void delaunay(Function function)
+        {
+            m_triangles.clear();
+            if(find_if(m_points.begin(), m_points.end(), onBottom) == m_points.end())
+            {
+                m_points.push_back(Point(0., 0., -1.));
+            }
+            for(size_t i = 0; i < m_points.size() - 2; i++)
+            {
+                for(size_t j = i+1; j < m_points.size() - 1; j++)
+                {
+                    for(size_t k = j+1; k < m_points.size(); k++)
+                    {
+                        Triangle t(m_points[i], m_points[j], m_points[k]);
+                        if(t.r > 0.)
+                        {
+                            bool valid = true;
+                            for(size_t l = 0; l < m_points.size() && valid; l++)
+                            {
+                                if(l != i && l != j && l != k)
+                                {
+                                    if(t.p.length(m_points[l]) < t.r - HOA_EPSILON)
+                                    {
+                                        valid = false;
+                                    }
+                                }
+                            }
+                            if(valid)
+                            {
+                                m_triangles.push_back({{i, j, k}});
+                                function(i, j, k, t);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        std::vector<Point>                      m_points;
+        std::vector<std::array<size_t, 3>>      m_triangles;
     public:
 
         Voronoi() noexcept
@@ -374,6 +417,16 @@ namespace hoa
         void clear()
         {
             m_points.clear();
+            m_triangles.clear();
+        }
+
+        //! Get the triangles of the triangulation.
+        /** Each triangle is defined by the indices of its three points, the bottom point added
+         by the computation (if any) is the last point.
+         */
+        std::vector<std::array<size_t, 3>> const& getTriangles() const noexcept
+        {
+            return m_triangles;
         }
 
         std::vector<Point> const& getPoints() const noexcept
@@ -406,48 +459,29 @@ namespace hoa
             return m_points[i].neightbours;
         }
 
+        //! Compute the triangles only.
+        /** The method computes the Delaunay triangulation of the points without the neighbours
+         and the bounds of the points.
+         */
+        void triangulate()
+        {
+            delaunay([](size_t, size_t, size_t, Triangle const&) {});
+        }
+
         void compute()
         {
-            if(find_if(m_points.begin(), m_points.end(), onBottom) == m_points.end())
-            {
-                m_points.push_back(Point(0., 0., -1.));
-            }
-            for(size_t i = 0; i < m_points.size() - 2; i++)
-            {
-                for(size_t j = i+1; j < m_points.size() - 1; j++)
-                {
-                    for(size_t k = j+1; k < m_points.size(); k++)
-                    {
-                        Triangle t(m_points[i], m_points[j], m_points[k]);
-                        if(t.r > 0.)
-                        {
-                            bool valid = true;
-                            for(size_t l = 0; l < m_points.size(); l++)
-                            {
-                                if(l != i && l != j && l != k)
-                                {
-                                    if(t.p.length(m_points[l]) < t.r - HOA_EPSILON)
-                                    {
-                                        valid = false;
-                                    }
-                                }
-                            }
-                            if(valid)
-                            {
-                                m_points[i].addNeighbour(m_points[j]);
-                                m_points[i].addNeighbour(m_points[k]);
-                                m_points[i].addBound(t.p);
-                                m_points[j].addNeighbour(m_points[i]);
-                                m_points[j].addNeighbour(m_points[k]);
-                                m_points[j].addBound(t.p);
-                                m_points[k].addNeighbour(m_points[i]);
-                                m_points[k].addNeighbour(m_points[j]);
-                                m_points[k].addBound(t.p);
-                            }
-                        }
-                    }
-                }
-            }
+            delaunay([this](size_t i, size_t j, size_t k, Triangle const& t)
+            {
+                m_points[i].addNeighbour(m_points[j]);
+                m_points[i].addNeighbour(m_points[k]);
+                m_points[i].addBound(t.p);
+                m_points[j].addNeighbour(m_points[i]);
+                m_points[j].addNeighbour(m_points[k]);
+                m_points[j].addBound(t.p);
+                m_points[k].addNeighbour(m_points[i]);
+                m_points[k].addNeighbour(m_points[j]);
+                m_points[k].addBound(t.p);
+            });
             for(size_t i = 0; i < m_points.size(); i++)
             {
                 m_points[i].filterBounds();
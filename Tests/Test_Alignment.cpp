@@ -0,0 +1,101 @@
+/*
+// Copyright (c) 2015 Pierre Guillot.
+// For information on usage and redistribution, and for a DISCLAIMER OF ALL
+// WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+*/
+
+#include <cfloat>
+#include <cmath>
+
+#include <Hoa.hpp>
+using namespace hoa;
+
+#define CATCH_CONFIG_PREFIX_ALL
+#include "catch.hpp"
+
+CATCH_TEST_CASE("Alignment", "[Alignment] [2D]")
+{
+    // one meter is ten samples
+    Alignment<Hoa2d, float> alignment(4, 3430.f, 0.05f, 16);
+    const std::vector<float> distances = {2.f, 1.f, 1.25f, 2.f};
+    alignment.setDistances(distances.data());
+    alignment.setGain(3, 0.5f);
+    CATCH_CHECK(alignment.getVectorSize() == 16);
+    CATCH_CHECK(alignment.getDistance(2) == Approx(1.25f));
+    CATCH_CHECK(alignment.getDelay(0) == Approx(0.f));
+    CATCH_CHECK(alignment.getDelay(1) == Approx(10.f));
+    CATCH_CHECK(alignment.getDelay(2) == Approx(7.5f));
+    CATCH_CHECK(alignment.getCompensation(1) == Approx(0.5f));
+    CATCH_CHECK(alignment.getCompensation(3) == Approx(0.5f));
+
+    CATCH_SECTION("Impulse")
+    {
+        std::vector<float> inputs(4, 1.f);
+        std::vector<float> outputs(4);
+        std::vector<std::vector<float>> responses(4, std::vector<float>(20));
+        for(size_t j = 0; j < 20; ++j)
+        {
+            alignment.process(inputs.data(), outputs.data());
+            for(size_t i = 0; i < 4; ++i) { responses[i][j] = outputs[i]; }
+            std::fill(inputs.begin(), inputs.end(), 0.f);
+        }
+        for(size_t j = 0; j < 20; ++j)
+        {
+            CATCH_CHECK(responses[0][j] == Approx(j == 0 ? 1.f : 0.f));
+            CATCH_CHECK(responses[1][j] == Approx(j == 10 ? 0.5f : 0.f));
+            CATCH_CHECK(responses[2][j] == Approx((j == 7 || j == 8) ? 0.3125f : 0.f));
+            CATCH_CHECK(responses[3][j] == Approx(j == 0 ? 0.5f : 0.f));
+        }
+    }
+
+    CATCH_SECTION("Block")
+    {
+        Alignment<Hoa2d, float> reference(4, 3430.f, 0.05f, 16);
+        reference.setDistances(distances.data());
+        reference.setGain(3, 0.5f);
+        std::vector<float> channels(4 * 16);
+        std::vector<float*> outs(4);
+        std::vector<const float*> ins(4);
+        for(size_t i = 0; i < 4; ++i)
+        {
+            outs[i] = channels.data() + i * 16;
+            ins[i] = outs[i];
+        }
+        std::vector<float> inputs(4);
+        std::vector<float> expected(4);
+
+        // enough blocks to wrap the ring buffers several times, processed in place
+        auto compare = [&](const size_t k)
+        {
+            std::vector<float> block(4 * 16);
+            for(size_t i = 0; i < block.size(); ++i)
+            {
+                block[i] = std::sin(float(i * 3 + k * 17));
+            }
+            channels = block;
+            alignment.processBlock(ins.data(), outs.data());
+            for(size_t j = 0; j < 16; ++j)
+            {
+                for(size_t i = 0; i < 4; ++i) { inputs[i] = block[i * 16 + j]; }
+                reference.process(inputs.data(), expected.data());
+                for(size_t i = 0; i < 4; ++i)
+                {
+                    CATCH_CHECK(channels[i * 16 + j] == Approx(expected[i]).margin(1e-6));
+                }
+            }
+        };
+        for(size_t k = 0; k < 40; ++k)
+        {
+            compare(k);
+        }
+
+        // a delay added to a loudspeaker without delay reads the last samples
+        alignment.setDistance(0, 1.5f);
+        reference.setDistance(0, 1.5f);
+        CATCH_CHECK(alignment.getDelay(0) == Approx(5.f));
+        for(size_t k = 40; k < 44; ++k)
+        {
+            compare(k);
+        }
+    }
+}
@@ -0,0 +1,187 @@
+/*
+// Copyright (c) 2015 Pierre Guillot.
+// For information on usage and redistribution, and for a DISCLAIMER OF ALL
+// WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+*/
+
+#include <cfloat>
+#include <cmath>
+
+#include <Hoa.hpp>
+using namespace hoa;
+
+#define CATCH_CONFIG_PREFIX_ALL
+#include "catch.hpp"
+
+CATCH_TEST_CASE("Chain 2D", "[Chain] [Decoder] [2D]")
+{
+    const size_t order = 5;
+    const size_t nharm = 11;
+    const size_t nplws = 12;
+    Optim<Hoa2d, float> optim(order);
+    Wider<Hoa2d, float> wider(order);
+    Rotate<Hoa2d, float> rotate(order);
+    DecoderRegular<Hoa2d, float> decoder(order, nplws);
+    Chain<Hoa2d, float> chain(order, nplws, 16);
+    optim.setMode(Optim<Hoa2d, float>::MaxRe);
+    wider.setWidening(0.5f);
+    rotate.setYaw(0.3f);
+    CATCH_CHECK(chain.addStage(optim));
+    CATCH_CHECK(chain.addStage(wider));
+    CATCH_CHECK(chain.addStage(rotate));
+    CATCH_CHECK(chain.setDecoder(decoder));
+    DecoderRegular<Hoa2d, float> other(order, nplws + 1);
+    CATCH_CHECK_FALSE(chain.setDecoder(other));
+    Optim<Hoa2d, float> higher(order + 2);
+    CATCH_CHECK_FALSE(chain.addStage(higher));
+    CATCH_CHECK(chain.getNumberOfStages() == 3);
+    CATCH_CHECK(chain.getNumberOfPlanewaves() == nplws);
+
+    Encoder<Hoa2d, float> encoder(order);
+    std::vector<float> harmonics(nharm);
+    std::vector<float> temp1(nharm);
+    std::vector<float> temp2(nharm);
+    std::vector<float> outputs(nplws);
+    std::vector<float> expected(nplws);
+
+    auto sequential = [&]()
+    {
+        optim.process(harmonics.data(), temp1.data());
+        wider.process(temp1.data(), temp2.data());
+        rotate.process(temp2.data(), temp1.data());
+        decoder.process(temp1.data(), expected.data());
+    };
+
+    CATCH_CHECK(chain.update());
+    CATCH_CHECK_FALSE(chain.update());
+
+    CATCH_SECTION("Sample")
+    {
+        const float input = 0.7f;
+        for(size_t k = 0; k < 8; ++k)
+        {
+            encoder.setAzimuth(float(k) * 0.8f);
+            encoder.process(&input, harmonics.data());
+            chain.process(harmonics.data(), outputs.data());
+            sequential();
+            for(size_t i = 0; i < nplws; ++i)
+            {
+                CATCH_CHECK(outputs[i] == Approx(expected[i]).margin(1e-5));
+            }
+        }
+    }
+
+    CATCH_SECTION("Block")
+    {
+        std::vector<float> inputs(nharm * 16);
+        std::vector<float> results(nplws * 16);
+        std::vector<const float*> ins(nharm);
+        std::vector<float*> outs(nplws);
+        for(size_t i = 0; i < nharm; ++i) { ins[i] = inputs.data() + i * 16; }
+        for(size_t i = 0; i < nplws; ++i) { outs[i] = results.data() + i * 16; }
+        for(size_t j = 0; j < 16; ++j)
+        {
+            const float input = std::sin(float(j));
+            encoder.setAzimuth(float(j) * 0.4f);
+            encoder.process(&input, harmonics.data());
+            for(size_t i = 0; i < nharm; ++i) { inputs[i * 16 + j] = harmonics[i]; }
+        }
+        chain.processBlock(ins.data(), outs.data());
+        for(size_t j = 0; j < 16; ++j)
+        {
+            for(size_t i = 0; i < nharm; ++i) { harmonics[i] = inputs[i * 16 + j]; }
+            sequential();
+            for(size_t i = 0; i < nplws; ++i)
+            {
+                CATCH_CHECK(results[i * 16 + j] == Approx(expected[i]).margin(1e-5));
+            }
+        }
+    }
+
+    CATCH_SECTION("Update")
+    {
+        const float input = 1.f;
+        encoder.setAzimuth(1.2f);
+        encoder.process(&input, harmonics.data());
+        chain.process(harmonics.data(), outputs.data());
+        sequential();
+        const std::vector<float> before = expected;
+
+        // the new matrix is published and crossfaded
+        chain.setFadeLength(4);
+        CATCH_CHECK(chain.getFadeLength() == 4);
+        rotate.setYaw(-1.f);
+        CATCH_CHECK_FALSE(chain.update());
+        chain.invalidate();
+        CATCH_CHECK(chain.update());
+        CATCH_CHECK_FALSE(chain.update());
+        chain.invalidate();
+        CATCH_CHECK_FALSE(chain.update());
+        sequential();
+        for(size_t k = 1; k <= 4; ++k)
+        {
+            chain.process(harmonics.data(), outputs.data());
+            const float gain = float(k) / 4.f;
+            for(size_t i = 0; i < nplws; ++i)
+            {
+                CATCH_CHECK(outputs[i] == Approx(before[i] * (1.f - gain) + expected[i] * gain).margin(1e-5));
+            }
+        }
+
+        // removing the stages only leaves the decoder
+        chain.clearStages();
+        CATCH_CHECK(chain.update());
+        decoder.process(harmonics.data(), expected.data());
+        const float* matrix = chain.getMatrix();
+        for(size_t i = 0; i < nplws; ++i)
+        {
+            float sum = 0.f;
+            for(size_t j = 0; j < nharm; ++j) { sum += matrix[i * nharm + j] * harmonics[j]; }
+            CATCH_CHECK(sum == Approx(expected[i]).margin(1e-5));
+        }
+    }
+}
+
+CATCH_TEST_CASE("Chain 3D", "[Chain] [Decoder] [3D]")
+{
+    const size_t order = 3;
+    const size_t nharm = 16;
+    Optim<Hoa3d, float> optim(order);
+    Wider<Hoa3d, float> wider(order);
+    Chain<Hoa3d, float> chain(order, nharm);
+    optim.setMode(Optim<Hoa3d, float>::InPhase);
+    wider.setWidening(0.3f);
+    CATCH_CHECK(chain.addStage(optim));
+    CATCH_CHECK(chain.addStage(wider));
+
+    // the stages of another order or of a mixed order are rejected
+    Optim<Hoa3d, float> higher(order + 1);
+    Optim<Hoa3d, float> mixed(7, 1);
+    CATCH_CHECK(mixed.getNumberOfHarmonics() == nharm);
+    CATCH_CHECK_FALSE(chain.addStage(higher));
+    CATCH_CHECK_FALSE(chain.addStage(mixed));
+    CATCH_CHECK(chain.getNumberOfStages() == 2);
+    CATCH_CHECK(chain.update());
+
+    // without decoder the number of outputs must be the number of harmonics
+    Chain<Hoa3d, float> invalid(order, nharm + 1);
+    CATCH_CHECK_FALSE(invalid.update());
+
+    // without decoder the chain outputs the harmonics
+    Encoder<Hoa3d, float> encoder(order);
+    const float input = 1.f;
+    std::vector<float> harmonics(nharm);
+    std::vector<float> temp(nharm);
+    std::vector<float> outputs(nharm);
+    std::vector<float> expected(nharm);
+    encoder.setAzimuth(2.1f);
+    encoder.setElevation(0.4f);
+    encoder.process(&input, harmonics.data());
+    chain.process(harmonics.data(), outputs.data());
+    optim.process(harmonics.data(), temp.data());
+    wider.process(temp.data(), expected.data());
+    for(size_t i = 0; i < nharm; ++i)
+    {
+        CATCH_CHECK(outputs[i] == Approx(expected[i]).margin(1e-5));
+    }
+}
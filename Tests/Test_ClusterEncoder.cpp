@@ -0,0 +1,134 @@
+/*
+// Copyright (c) 2015 Pierre Guillot.
+// For information on usage and redistribution, and for a DISCLAIMER OF ALL
+// WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+*/
+
+#include <cfloat>
+#include <cmath>
+
+#include <Hoa.hpp>
+using namespace hoa;
+
+#define CATCH_CONFIG_PREFIX_ALL
+#include "catch.hpp"
+
+CATCH_TEST_CASE("ClusterEncoder 2D", "[Encoder] [ClusterEncoder] [2D]")
+{
+    ClusterEncoder<Hoa2d, float> cluster(5, 6, 2);
+    MultiEncoder<Hoa2d, float> multi(5, 6);
+    std::vector<float> inputs = {1.f, 0.5f, 0.25f, 0.8f, 0.6f, 0.4f};
+    std::vector<float> outputs(11);
+    std::vector<float> expected(11);
+
+    // two groups of three close sources
+    const std::vector<float> azimuths = {0.f, 0.01f, 6.275f, 3.1f, 3.11f, 3.12f};
+    for(size_t i = 0; i < 6; ++i)
+    {
+        cluster.setAzimuth(i, azimuths[i]);
+        multi.setAzimuth(i, azimuths[i]);
+    }
+    cluster.update();
+
+    CATCH_CHECK(cluster.getNumberOfClusters() == 2);
+    CATCH_CHECK(cluster.getNumberOfIndividualSources() == 0);
+    CATCH_CHECK(cluster.getCluster(0) == cluster.getCluster(1));
+    CATCH_CHECK(cluster.getCluster(0) == cluster.getCluster(2));
+    CATCH_CHECK(cluster.getCluster(3) == cluster.getCluster(4));
+    CATCH_CHECK(cluster.getCluster(3) == cluster.getCluster(5));
+    CATCH_CHECK(cluster.getCluster(0) != cluster.getCluster(3));
+    CATCH_CHECK(cluster.getClusterSize(0) == 3);
+    CATCH_CHECK(cluster.getClusterSize(1) == 3);
+
+    const size_t front = cluster.getCluster(0);
+    const size_t back  = cluster.getCluster(3);
+    CATCH_CHECK(std::cos(cluster.getClusterAzimuth(front)) == Approx(1.f).margin(1e-3));
+    CATCH_CHECK(cluster.getClusterAzimuth(back) == Approx(3.11f).margin(1e-3));
+
+    CATCH_SECTION("Clustered")
+    {
+        cluster.process(inputs.data(), outputs.data());
+        multi.process(inputs.data(), expected.data());
+        for(size_t j = 0; j < 11; ++j)
+        {
+            CATCH_CHECK(outputs[j] == Approx(expected[j]).margin(0.05));
+        }
+    }
+
+    CATCH_SECTION("Individual")
+    {
+        // the sources at the edges of the groups are encoded individually
+        cluster.setMaximumError(0.004f);
+        cluster.update();
+        CATCH_CHECK(cluster.getMaximumError() == Approx(0.004f));
+        CATCH_CHECK(cluster.getNumberOfIndividualSources() == 4);
+        CATCH_CHECK(cluster.isClustered(0));
+        CATCH_CHECK(cluster.isClustered(4));
+        CATCH_CHECK_FALSE(cluster.isClustered(1));
+        CATCH_CHECK_FALSE(cluster.isClustered(2));
+        CATCH_CHECK_FALSE(cluster.isClustered(3));
+        CATCH_CHECK_FALSE(cluster.isClustered(5));
+
+        cluster.process(inputs.data(), outputs.data());
+        multi.process(inputs.data(), expected.data());
+        for(size_t j = 0; j < 11; ++j)
+        {
+            CATCH_CHECK(outputs[j] == Approx(expected[j]).margin(1e-2));
+        }
+    }
+
+    CATCH_SECTION("Radius and mute")
+    {
+        cluster.setRadius(3, 2.f);
+        cluster.setRadius(4, 2.f);
+        cluster.setRadius(5, 2.f);
+        multi.setRadius(3, 2.f);
+        multi.setRadius(4, 2.f);
+        multi.setRadius(5, 2.f);
+        cluster.setMute(0, true);
+        multi.setMute(0, true);
+        cluster.update();
+        CATCH_CHECK(cluster.getClusterSize(front) == 2);
+        CATCH_CHECK(cluster.getClusterRadius(back) == Approx(1.f));
+
+        cluster.process(inputs.data(), outputs.data());
+        multi.process(inputs.data(), expected.data());
+        for(size_t j = 0; j < 11; ++j)
+        {
+            CATCH_CHECK(outputs[j] == Approx(expected[j]).margin(0.05));
+        }
+    }
+}
+
+CATCH_TEST_CASE("ClusterEncoder 3D", "[Encoder] [ClusterEncoder] [3D]")
+{
+    ClusterEncoder<Hoa3d, float> cluster(3, 4, 2);
+    MultiEncoder<Hoa3d, float> multi(3, 4);
+    std::vector<float> inputs = {1.f, 0.5f, 0.25f, 0.8f};
+    std::vector<float> outputs(16);
+    std::vector<float> expected(16);
+
+    const std::vector<float> azimuths   = {1.f, 1.02f, 4.f, 4.01f};
+    const std::vector<float> elevations = {0.5f, 0.49f, -0.3f, -0.32f};
+    for(size_t i = 0; i < 4; ++i)
+    {
+        cluster.setAzimuth(i, azimuths[i]);
+        cluster.setElevation(i, elevations[i]);
+        multi.setAzimuth(i, azimuths[i]);
+        multi.setElevation(i, elevations[i]);
+    }
+    cluster.update();
+
+    CATCH_CHECK(cluster.getCluster(0) == cluster.getCluster(1));
+    CATCH_CHECK(cluster.getCluster(2) == cluster.getCluster(3));
+    CATCH_CHECK(cluster.getCluster(0) != cluster.getCluster(2));
+    CATCH_CHECK(cluster.getClusterElevation(cluster.getCluster(0)) == Approx(0.495f).margin(1e-2));
+    CATCH_CHECK(cluster.getClusterElevation(cluster.getCluster(2)) == Approx(-0.31f).margin(1e-2));
+
+    cluster.process(inputs.data(), outputs.data());
+    multi.process(inputs.data(), expected.data());
+    for(size_t j = 0; j < 16; ++j)
+    {
+        CATCH_CHECK(outputs[j] == Approx(expected[j]).margin(0.05));
+    }
+}
@@ -0,0 +1,153 @@
+/*
+// Copyright (c) 2015 Pierre Guillot.
+// For information on usage and redistribution, and for a DISCLAIMER OF ALL
+// WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+*/
+
+#include <cfloat>
+#include <cmath>
+
+#include <Hoa.hpp>
+using namespace hoa;
+
+#define CATCH_CONFIG_PREFIX_ALL
+#include "catch.hpp"
+
+CATCH_TEST_CASE("Converter", "[Converter] [2D] [3D]")
+{
+    const size_t order = 5;
+    const float input = 0.7f;
+    Encoder<Hoa2d, float> encoder2d(order);
+    Encoder<Hoa3d, float> encoder3d(order);
+    std::vector<float> harmonics2d(11);
+    std::vector<float> harmonics3d(36);
+
+    CATCH_SECTION("2D to 3D")
+    {
+        typedef Converter<Hoa2d, Hoa3d, float> converter_t;
+        converter_t converter(order, order);
+        CATCH_CHECK(converter.getNumberOfInputs() == 11);
+        CATCH_CHECK(converter.getNumberOfOutputs() == 36);
+        std::vector<float> outputs(36);
+        for(size_t k = 0; k < 16; ++k)
+        {
+            const float azimuth = float(k) * 0.41f;
+            encoder2d.setAzimuth(azimuth);
+            encoder3d.setAzimuth(azimuth);
+            encoder3d.setElevation(0.f);
+            encoder2d.process(&input, harmonics2d.data());
+            encoder3d.process(&input, harmonics3d.data());
+            converter.process(harmonics2d.data(), outputs.data());
+            for(size_t i = 0; i < 36; ++i)
+            {
+                const size_t degree = Harmonic<Hoa3d, float>::getDegree(i);
+                if(size_t(std::abs(Harmonic<Hoa3d, float>::getOrder(i))) == degree)
+                {
+                    CATCH_CHECK(outputs[i] == Approx(harmonics3d[i]).margin(1e-5));
+                }
+                else
+                {
+                    CATCH_CHECK(outputs[i] == 0.f);
+                }
+            }
+        }
+    }
+
+    CATCH_SECTION("3D to 2D")
+    {
+        typedef Converter<Hoa3d, Hoa2d, float> converter_t;
+        converter_t converter(order, 3);
+        CATCH_CHECK(converter.getNumberOfOutputs() == 7);
+        std::vector<float> outputs(7);
+        for(size_t k = 0; k < 16; ++k)
+        {
+            const float azimuth = float(k) * 0.41f;
+            encoder2d.setAzimuth(azimuth);
+            encoder3d.setAzimuth(azimuth);
+            encoder3d.setElevation(0.f);
+            encoder2d.process(&input, harmonics2d.data());
+            encoder3d.process(&input, harmonics3d.data());
+            converter.process(harmonics3d.data(), outputs.data());
+            for(size_t i = 0; i < 7; ++i)
+            {
+                CATCH_CHECK(outputs[i] == Approx(harmonics2d[i]).margin(1e-5));
+            }
+        }
+
+        // the sectoral harmonics of a mixed order
+        typedef Converter<Hoa3d, Hoa2d, float> mixed_t;
+        mixed_t mixed(order, 1, order, order);
+        Encoder<Hoa3d, float> encoder(order, 1);
+        std::vector<float> inputs(encoder.getNumberOfHarmonics());
+        std::vector<float> results(11);
+        encoder.setAzimuth(2.f);
+        encoder.setElevation(0.f);
+        encoder.process(&input, inputs.data());
+        encoder2d.setAzimuth(2.f);
+        encoder2d.process(&input, harmonics2d.data());
+        mixed.process(inputs.data(), results.data());
+        for(size_t i = 0; i < 11; ++i)
+        {
+            CATCH_CHECK(results[i] == Approx(harmonics2d[i]).margin(1e-5));
+        }
+    }
+
+    CATCH_SECTION("Truncation and extension")
+    {
+        typedef Converter<Hoa3d, Hoa3d, float> converter_t;
+        converter_t truncation(order, 3);
+        converter_t extension(3, order);
+        Encoder<Hoa3d, float> encoder(3);
+        std::vector<float> truncated(16);
+        std::vector<float> expected(16);
+        std::vector<float> extended(36);
+        encoder3d.setAzimuth(1.1f);
+        encoder3d.setElevation(0.6f);
+        encoder.setAzimuth(1.1f);
+        encoder.setElevation(0.6f);
+        encoder3d.process(&input, harmonics3d.data());
+        encoder.process(&input, expected.data());
+        truncation.process(harmonics3d.data(), truncated.data());
+        extension.process(truncated.data(), extended.data());
+        for(size_t i = 0; i < 16; ++i)
+        {
+            CATCH_CHECK(truncated[i] == Approx(expected[i]).margin(1e-5));
+            CATCH_CHECK(extended[i] == truncated[i]);
+        }
+        for(size_t i = 16; i < 36; ++i)
+        {
+            CATCH_CHECK(extended[i] == 0.f);
+        }
+    }
+
+    CATCH_SECTION("Block")
+    {
+        const size_t vsize = 8;
+        typedef Converter<Hoa2d, Hoa3d, float> converter_t;
+        converter_t converter(order, 3, vsize);
+        std::vector<float> inputs(11 * vsize);
+        std::vector<float> outputs(16 * vsize, 1.f);
+        std::vector<const float*> ins(11);
+        std::vector<float*> outs(16);
+        for(size_t i = 0; i < 11; ++i) { ins[i] = inputs.data() + i * vsize; }
+        for(size_t i = 0; i < 16; ++i) { outs[i] = outputs.data() + i * vsize; }
+        for(size_t j = 0; j < vsize; ++j)
+        {
+            encoder2d.setAzimuth(float(j) * 0.8f);
+            encoder2d.process(&input, harmonics2d.data());
+            for(size_t i = 0; i < 11; ++i) { inputs[i * vsize + j] = harmonics2d[i]; }
+        }
+        converter.processBlock(ins.data(), outs.data());
+        std::vector<float> sample(11);
+        std::vector<float> expected(16);
+        for(size_t j = 0; j < vsize; ++j)
+        {
+            for(size_t i = 0; i < 11; ++i) { sample[i] = inputs[i * vsize + j]; }
+            converter.process(sample.data(), expected.data());
+            for(size_t i = 0; i < 16; ++i)
+            {
+                CATCH_CHECK(outputs[i * vsize + j] == expected[i]);
+            }
+        }
+    }
+}
@@ -0,0 +1,521 @@
+/*
+// Copyright (c) 2015 Pierre Guillot.
+// For information on usage and redistribution, and for a DISCLAIMER OF ALL
+// WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+*/
+
+#include <cfloat>
+#include <cmath>
+
+#include <Hoa.hpp>
+using namespace hoa;
+
+#define CATCH_CONFIG_PREFIX_ALL
+#include "catch.hpp"
+
+// the direct convolution of a signal with a response
+static std::vector<double> hoa_convolve(std::vector<double> const& signal, const double* response, const size_t size, const size_t stride = 1)
+{
+    std::vector<double> result(signal.size(), 0.);
+    for(size_t n = 0; n < signal.size(); ++n)
+    {
+        for(size_t k = 0; k < size && k <= n; ++k)
+        {
+            result[n] += response[k * stride] * signal[n - k];
+        }
+    }
+    return result;
+}
+
+CATCH_TEST_CASE("Convolver", "[Convolver]")
+{
+    const size_t ninputs = 3;
+    const size_t noutputs = 2;
+    const size_t nblocks = 12;
+    std::vector<std::vector<double>> responses(ninputs * noutputs);
+    for(size_t r = 0; r < responses.size(); ++r)
+    {
+        // responses of different sizes, one is missing
+        responses[r].resize((r == 4) ? 0 : 17 + r * 23);
+        for(size_t k = 0; k < responses[r].size(); ++k)
+        {
+            responses[r][k] = std::cos(double(k * (r + 1)) * 0.11) * std::exp(-double(k) * 0.02);
+        }
+    }
+
+    for(size_t vsize : {8ul, 24ul, 64ul, 256ul})
+    {
+        Convolver<double> convolver(ninputs, noutputs);
+        for(size_t o = 0; o < noutputs; ++o)
+        {
+            for(size_t i = 0; i < ninputs; ++i)
+            {
+                std::vector<double> const& response = responses[o * ninputs + i];
+                convolver.setResponse(o, i, response.size(), response.data());
+            }
+        }
+        convolver.prepare(vsize);
+        CATCH_CHECK(convolver.getResponseSize() == 17 + 5 * 23);
+        CATCH_CHECK(convolver.getNumberOfPartitions() == (convolver.getResponseSize() + vsize - 1) / vsize);
+        CATCH_CHECK(convolver.getFftSize() >= vsize * 2);
+
+        std::vector<std::vector<double>> signals(ninputs, std::vector<double>(vsize * nblocks));
+        for(size_t i = 0; i < ninputs; ++i)
+        {
+            for(size_t n = 0; n < signals[i].size(); ++n)
+            {
+                signals[i][n] = std::sin(double(n * (i + 2)) * 0.13) + ((n % 17 == 0) ? 0.5 : 0.);
+            }
+        }
+        std::vector<std::vector<double>> expected(noutputs, std::vector<double>(vsize * nblocks, 0.));
+        for(size_t o = 0; o < noutputs; ++o)
+        {
+            for(size_t i = 0; i < ninputs; ++i)
+            {
+                std::vector<double> const& response = responses[o * ninputs + i];
+                const auto result = hoa_convolve(signals[i], response.data(), response.size());
+                for(size_t n = 0; n < result.size(); ++n) { expected[o][n] += result[n]; }
+            }
+        }
+
+        // the outputs share the memory of the inputs
+        std::vector<std::vector<double>> buffers(ninputs, std::vector<double>(vsize));
+        std::vector<const double*> ins(ninputs);
+        std::vector<double*> outs(noutputs);
+        for(size_t i = 0; i < ninputs; ++i) { ins[i] = buffers[i].data(); }
+        for(size_t o = 0; o < noutputs; ++o) { outs[o] = buffers[o].data(); }
+        for(size_t b = 0; b < nblocks; ++b)
+        {
+            for(size_t i = 0; i < ninputs; ++i)
+            {
+                std::copy(signals[i].begin() + b * vsize, signals[i].begin() + (b + 1) * vsize, buffers[i].begin());
+            }
+            convolver.process(ins.data(), outs.data());
+            for(size_t o = 0; o < noutputs; ++o)
+            {
+                for(size_t n = 0; n < vsize; ++n)
+                {
+                    CATCH_CHECK(buffers[o][n] == Approx(expected[o][b * vsize + n]).margin(1e-9));
+                }
+            }
+        }
+
+        // the delay lines are cleared by prepare
+        convolver.prepare(vsize);
+        for(size_t i = 0; i < ninputs; ++i)
+        {
+            std::copy(signals[i].begin(), signals[i].begin() + vsize, buffers[i].begin());
+        }
+        convolver.process(ins.data(), outs.data());
+        for(size_t n = 0; n < vsize; ++n)
+        {
+            CATCH_CHECK(buffers[0][n] == Approx(expected[0][n]).margin(1e-9));
+        }
+    }
+}
+
+CATCH_TEST_CASE("ConvolverNonUniform", "[Convolver]")
+{
+    const size_t ninputs = 2;
+    const size_t noutputs = 2;
+    const size_t rsize = 700;
+    std::vector<std::vector<double>> responses(ninputs * noutputs, std::vector<double>(rsize));
+    for(size_t r = 0; r < responses.size(); ++r)
+    {
+        for(size_t k = 0; k < rsize; ++k)
+        {
+            responses[r][k] = std::sin(double(k * (r + 2)) * 0.07) * std::exp(-double(k) * 0.004);
+        }
+    }
+
+    for(size_t vsize : {4ul, 8ul, 32ul})
+    {
+        const size_t nblocks = (rsize * 2) / vsize;
+        ConvolverNonUniform<double> convolver(ninputs, noutputs);
+        CATCH_CHECK(convolver.getPartitioning() == ConvolverNonUniform<double>::Uniform);
+        for(size_t o = 0; o < noutputs; ++o)
+        {
+            for(size_t i = 0; i < ninputs; ++i)
+            {
+                convolver.setResponse(o, i, rsize, responses[o * ninputs + i].data());
+            }
+        }
+        convolver.prepare(vsize);
+        CATCH_CHECK(convolver.getNumberOfLevels() == 1);
+
+        // the partitions grow by 4 from the vector size
+        convolver.setPartitioning(ConvolverNonUniform<double>::NonUniform);
+        convolver.prepare(vsize);
+        CATCH_CHECK(convolver.getLatency() == 0);
+        CATCH_CHECK(convolver.getNumberOfLevels() > 1);
+        CATCH_CHECK(convolver.getPartitionSize(0) == vsize);
+        CATCH_CHECK(convolver.getPartitionOffset(0) == 0);
+        for(size_t l = 1; l < convolver.getNumberOfLevels(); ++l)
+        {
+            CATCH_CHECK(convolver.getPartitionSize(l) == convolver.getPartitionSize(l - 1) * 4);
+            CATCH_CHECK(convolver.getPartitionOffset(l) == convolver.getPartitionSize(l) * 2);
+            CATCH_CHECK(convolver.getPartitionOffset(l) < rsize);
+        }
+
+        std::vector<std::vector<double>> signals(ninputs, std::vector<double>(vsize * nblocks));
+        for(size_t i = 0; i < ninputs; ++i)
+        {
+            for(size_t n = 0; n < signals[i].size(); ++n)
+            {
+                signals[i][n] = std::cos(double(n * (i + 1)) * 0.19) + ((n % 23 == 0) ? 0.7 : 0.);
+            }
+        }
+        std::vector<std::vector<double>> expected(noutputs, std::vector<double>(vsize * nblocks, 0.));
+        for(size_t o = 0; o < noutputs; ++o)
+        {
+            for(size_t i = 0; i < ninputs; ++i)
+            {
+                const auto result = hoa_convolve(signals[i], responses[o * ninputs + i].data(), rsize);
+                for(size_t n = 0; n < result.size(); ++n) { expected[o][n] += result[n]; }
+            }
+        }
+
+        // the outputs share the memory of the inputs
+        std::vector<std::vector<double>> buffers(ninputs, std::vector<double>(vsize));
+        std::vector<const double*> ins = {buffers[0].data(), buffers[1].data()};
+        std::vector<double*> outs = {buffers[0].data(), buffers[1].data()};
+        for(size_t b = 0; b < nblocks; ++b)
+        {
+            for(size_t i = 0; i < ninputs; ++i)
+            {
+                std::copy(signals[i].begin() + b * vsize, signals[i].begin() + (b + 1) * vsize, buffers[i].begin());
+            }
+            convolver.process(ins.data(), outs.data());
+            for(size_t o = 0; o < noutputs; ++o)
+            {
+                for(size_t n = 0; n < vsize; ++n)
+                {
+                    CATCH_CHECK(buffers[o][n] == Approx(expected[o][b * vsize + n]).margin(1e-9));
+                }
+            }
+        }
+    }
+}
+
+CATCH_TEST_CASE("ConvolverDirect", "[Convolver]")
+{
+    const size_t ninputs = 3;
+    const size_t noutputs = 2;
+    const std::vector<size_t> rsizes = {1, 20, 64, 33, 0, 47};
+    std::vector<std::vector<double>> responses(ninputs * noutputs);
+    for(size_t r = 0; r < responses.size(); ++r)
+    {
+        responses[r].resize(rsizes[r]);
+        for(size_t k = 0; k < rsizes[r]; ++k)
+        {
+            responses[r][k] = std::sin(double(k * (r + 2)) * 0.11) * std::exp(-double(k) * 0.02) + 0.1;
+        }
+    }
+
+    // the vector sizes that are not multiple of the groups
+    for(size_t vsize : {5ul, 8ul, 32ul, 77ul})
+    {
+        const size_t nblocks = std::max(size_t(4), 256 / vsize);
+        ConvolverDirect<double> convolver(ninputs, noutputs);
+        for(size_t o = 0; o < noutputs; ++o)
+        {
+            for(size_t i = 0; i < ninputs; ++i)
+            {
+                convolver.setResponse(o, i, rsizes[o * ninputs + i], responses[o * ninputs + i].data());
+            }
+        }
+        convolver.prepare(vsize);
+        CATCH_CHECK(convolver.getResponseSize() == 64);
+        CATCH_CHECK(convolver.getVectorSize() == vsize);
+
+        std::vector<std::vector<double>> signals(ninputs, std::vector<double>(vsize * nblocks));
+        for(size_t i = 0; i < ninputs; ++i)
+        {
+            for(size_t n = 0; n < signals[i].size(); ++n)
+            {
+                signals[i][n] = std::cos(double(n * (i + 1)) * 0.23) + ((n % 17 == 0) ? 0.5 : 0.);
+            }
+        }
+        std::vector<std::vector<double>> expected(noutputs, std::vector<double>(vsize * nblocks, 0.));
+        for(size_t o = 0; o < noutputs; ++o)
+        {
+            for(size_t i = 0; i < ninputs; ++i)
+            {
+                const auto result = hoa_convolve(signals[i], responses[o * ninputs + i].data(), rsizes[o * ninputs + i]);
+                for(size_t n = 0; n < result.size(); ++n) { expected[o][n] += result[n]; }
+            }
+        }
+
+        // the outputs share the memory of the inputs
+        std::vector<std::vector<double>> buffers(ninputs, std::vector<double>(vsize));
+        std::vector<const double*> ins = {buffers[0].data(), buffers[1].data(), buffers[2].data()};
+        std::vector<double*> outs = {buffers[0].data(), buffers[1].data()};
+        for(size_t b = 0; b < nblocks; ++b)
+        {
+            for(size_t i = 0; i < ninputs; ++i)
+            {
+                std::copy(signals[i].begin() + b * vsize, signals[i].begin() + (b + 1) * vsize, buffers[i].begin());
+            }
+            convolver.process(ins.data(), outs.data());
+            for(size_t o = 0; o < noutputs; ++o)
+            {
+                for(size_t n = 0; n < vsize; ++n)
+                {
+                    CATCH_CHECK(buffers[o][n] == Approx(expected[o][b * vsize + n]).margin(1e-9));
+                }
+            }
+        }
+    }
+
+    CATCH_CHECK(ConvolverDirect<double>::isEfficient(64, 64));
+    CATCH_CHECK(ConvolverDirect<double>::isEfficient(16, 8));
+    CATCH_CHECK_FALSE(ConvolverDirect<double>::isEfficient(64, 16));
+    CATCH_CHECK_FALSE(ConvolverDirect<double>::isEfficient(256, 512));
+}
+
+// a set of responses with the right ear mirrored from the left ear
+template <class Base>
+struct hoa_symmetric
+{
+    static const Dimension dimension = Base::dimension;
+    static const size_t order = Base::order;
+    static const size_t number_of_harmonics = Base::number_of_harmonics;
+    static const size_t responses_size = Base::responses_size;
+
+    template <typename T>
+    static std::vector<T> mirror(const T* left)
+    {
+        std::vector<T> right(responses_size * number_of_harmonics);
+        for(size_t j = 0; j < responses_size; ++j)
+        {
+            for(size_t i = 0; i < number_of_harmonics; ++i)
+            {
+                const T sign = T(Hrir<dimension, Base>::getSymmetrySign(i));
+                right[j * number_of_harmonics + i] = sign * left[j * number_of_harmonics + i];
+            }
+        }
+        return right;
+    }
+
+    static float const* get_float_left() { return Base::get_float_left(); }
+    static double const* get_double_left() { return Base::get_double_left(); }
+    static float const* get_float_right()
+    {
+        static const std::vector<float> right = mirror(Base::get_float_left());
+        return right.data();
+    }
+    static double const* get_double_right()
+    {
+        static const std::vector<double> right = mirror(Base::get_double_left());
+        return right.data();
+    }
+};
+
+// the size of the response of a harmonic used by a binaural decoder
+template <class HrirType>
+size_t hoa_response_size(DecoderBinaural<Hoa2d, double, HrirType> const&, const size_t, const size_t crop)
+{
+    return crop ? crop : Hrir<Hoa2d, HrirType>::getNumberOfRows();
+}
+
+template <class HrirType>
+size_t hoa_response_size(DecoderBinaural<Hoa3d, double, HrirType> const& decoder, const size_t index, const size_t)
+{
+    return decoder.getResponseSize(index);
+}
+
+template <Dimension D, class HrirType>
+void hoa_check_binaural(DecoderBinaural<D, double, HrirType>& decoder, const size_t vsize, const size_t crop = 0)
+{
+    typedef Hrir<D, HrirType> hrir_t;
+    const size_t order = decoder.getDecompositionOrder();
+    const size_t nharm = std::min(decoder.getNumberOfHarmonics(), hrir_t::getNumberOfColumns());
+    const size_t ncols = hrir_t::getNumberOfColumns();
+    const size_t nblocks = std::max(size_t(4), hrir_t::getNumberOfRows() * 2 / vsize);
+
+    Encoder<D, double> encoder(order);
+    std::vector<double> harmonics(decoder.getNumberOfHarmonics());
+    std::vector<std::vector<double>> signals(decoder.getNumberOfHarmonics(), std::vector<double>(vsize * nblocks));
+    for(size_t n = 0; n < vsize * nblocks; ++n)
+    {
+        const double input = std::sin(double(n) * 0.21) + ((n % 31 == 0) ? 1. : 0.);
+        encoder.setAzimuth(double(n) * 0.01);
+        encoder.process(&input, harmonics.data());
+        for(size_t i = 0; i < harmonics.size(); ++i) { signals[i][n] = harmonics[i]; }
+    }
+
+    std::vector<double> left(vsize * nblocks, 0.);
+    std::vector<double> right(vsize * nblocks, 0.);
+    for(size_t i = 0; i < nharm; ++i)
+    {
+        const size_t rsize = hoa_response_size(decoder, i, crop);
+        const auto l = hoa_convolve(signals[i], hrir_t::template getLeftMatrix<double>() + i, rsize, ncols);
+        const auto r = hoa_convolve(signals[i], hrir_t::template getRightMatrix<double>() + i, rsize, ncols);
+        for(size_t n = 0; n < left.size(); ++n) { left[n] += l[n]; right[n] += r[n]; }
+    }
+
+    std::vector<const double*> ins(signals.size());
+    std::vector<std::vector<double>> outputs(2, std::vector<double>(vsize));
+    std::vector<double*> outs = {outputs[0].data(), outputs[1].data()};
+    for(size_t b = 0; b < nblocks; ++b)
+    {
+        for(size_t i = 0; i < signals.size(); ++i) { ins[i] = signals[i].data() + b * vsize; }
+        decoder.processBlock(ins.data(), outs.data());
+        for(size_t n = 0; n < vsize; ++n)
+        {
+            CATCH_CHECK(outputs[0][n] == Approx(left[b * vsize + n]).margin(1e-9));
+            CATCH_CHECK(outputs[1][n] == Approx(right[b * vsize + n]).margin(1e-9));
+        }
+    }
+}
+
+CATCH_TEST_CASE("Binaural Convolution", "[Convolver] [Decoder] [2D] [3D]")
+{
+    CATCH_SECTION("2D")
+    {
+        DecoderBinaural<Hoa2d, double, hrir::Sadie_D2_2D> sadie(7);
+        sadie.prepare(64);
+        hoa_check_binaural(sadie, 64);
+        sadie.prepare(512);
+        hoa_check_binaural(sadie, 512);
+
+        DecoderBinaural<Hoa2d, double, hrir::Listen_1002C_2D> listen(3);
+        listen.prepare(128);
+        hoa_check_binaural(listen, 128);
+
+        // the crop size is applied to a prepared decoder
+        listen.setCropSize(100);
+        CATCH_CHECK(listen.getCropSize() == 100);
+        hoa_check_binaural(listen, 128, 100);
+
+        // the non-uniform partitioning keeps the crop size
+        listen.setPartitioning(ConvolverNonUniform<double>::NonUniform);
+        listen.prepare(16);
+        CATCH_CHECK(listen.getLatency() == 0);
+        hoa_check_binaural(listen, 16, 100);
+        sadie.setPartitioning(ConvolverNonUniform<double>::NonUniform);
+        sadie.prepare(8);
+        hoa_check_binaural(sadie, 8);
+        CATCH_CHECK_FALSE(sadie.isDirectConvolution());
+
+        // the short responses are convolved in the time domain
+        sadie.setCropSize(48);
+        CATCH_CHECK(sadie.isDirectConvolution() == false);
+        sadie.prepare(64);
+        CATCH_CHECK(sadie.isDirectConvolution());
+        hoa_check_binaural(sadie, 64, 48);
+        sadie.prepare(50);
+        CATCH_CHECK(sadie.isDirectConvolution());
+        hoa_check_binaural(sadie, 50, 48);
+        sadie.setCropSize(16);
+        sadie.prepare(8);
+        CATCH_CHECK(sadie.isDirectConvolution());
+        hoa_check_binaural(sadie, 8, 16);
+        sadie.setCropSize(0);
+        CATCH_CHECK_FALSE(sadie.isDirectConvolution());
+        hoa_check_binaural(sadie, 8);
+    }
+
+    CATCH_SECTION("3D")
+    {
+        DecoderBinaural<Hoa3d, double, hrir::Sadie_D2_3D> sadie(7);
+        sadie.prepare(64);
+        hoa_check_binaural(sadie, 64);
+
+        DecoderBinaural<Hoa3d, double, hrir::Listen_1002C_3D> listen(2);
+        listen.prepare(512);
+        hoa_check_binaural(listen, 512);
+
+        listen.setPartitioning(ConvolverNonUniform<double>::NonUniform);
+        listen.prepare(32);
+        hoa_check_binaural(listen, 32);
+    }
+
+    CATCH_SECTION("Symmetry")
+    {
+        typedef hoa_symmetric<hrir::Sadie_D2_2D> symmetric_2d;
+        typedef hoa_symmetric<hrir::Listen_1002C_3D> symmetric_3d;
+        typedef Hrir<Hoa2d, symmetric_2d> hrir_symmetric_2d;
+        typedef Hrir<Hoa3d, symmetric_3d> hrir_symmetric_3d;
+        typedef Hrir<Hoa2d, hrir::Sadie_D2_2D> hrir_sadie_2d;
+        typedef Hrir<Hoa3d, hrir::Listen_1002C_3D> hrir_listen_3d;
+        CATCH_CHECK(hrir_symmetric_2d::isSymmetric());
+        CATCH_CHECK(hrir_symmetric_3d::isSymmetric());
+        CATCH_CHECK(hrir_symmetric_2d::getSymmetrySign(1) == -1);
+        CATCH_CHECK(hrir_symmetric_2d::getSymmetrySign(2) == 1);
+
+        // the bundled sets are measured and aren't symmetric
+        CATCH_CHECK_FALSE(hrir_sadie_2d::isSymmetric());
+        CATCH_CHECK_FALSE(hrir_listen_3d::isSymmetric());
+        DecoderBinaural<Hoa2d, double, hrir::Sadie_D2_2D> sadie(5);
+        CATCH_CHECK_FALSE(sadie.isSymmetric());
+
+        DecoderBinaural<Hoa2d, double, symmetric_2d> decoder2d(5);
+        CATCH_CHECK(decoder2d.isSymmetric());
+        decoder2d.prepare(64);
+        hoa_check_binaural(decoder2d, 64);
+        decoder2d.setCropSize(32);
+        CATCH_CHECK(decoder2d.isDirectConvolution());
+        hoa_check_binaural(decoder2d, 64, 32);
+
+        DecoderBinaural<Hoa3d, double, symmetric_3d> decoder3d(3);
+        CATCH_CHECK(decoder3d.isSymmetric());
+        decoder3d.prepare(128);
+        hoa_check_binaural(decoder3d, 128);
+        decoder3d.setTruncation(-40.);
+        decoder3d.setPartitioning(ConvolverNonUniform<double>::NonUniform);
+        decoder3d.prepare(16);
+        hoa_check_binaural(decoder3d, 16);
+    }
+
+    CATCH_SECTION("3D truncation")
+    {
+        typedef Hrir<Hoa3d, hrir::Sadie_D2_3D> hrir_t;
+        const size_t nrows = hrir_t::getNumberOfRows();
+        const size_t ncols = hrir_t::getNumberOfColumns();
+        DecoderBinaural<Hoa3d, double, hrir::Sadie_D2_3D> sadie(3);
+        CATCH_CHECK(sadie.getTruncation() == 0.);
+        for(size_t i = 0; i < ncols; ++i)
+        {
+            CATCH_CHECK(sadie.getResponseSize(i) == nrows);
+        }
+
+        // the truncation is applied to a prepared decoder
+        sadie.prepare(64);
+        sadie.setTruncation(-40.);
+        CATCH_CHECK(sadie.getTruncation() == -40.);
+        size_t total = 0;
+        for(size_t i = 0; i < ncols; ++i)
+        {
+            const size_t size = sadie.getResponseSize(i);
+            CATCH_CHECK(size > 0);
+            CATCH_CHECK(size <= nrows);
+            total += size;
+
+            // the energy of the tail is below the threshold, not with one more sample
+            double energy = 0., tail = 0., last = 0.;
+            for(size_t j = 0; j < nrows; ++j)
+            {
+                const double l = hrir_t::getLeftMatrix<double>()[j * ncols + i];
+                const double r = hrir_t::getRightMatrix<double>()[j * ncols + i];
+                energy += l * l + r * r;
+                if(j >= size) { tail += l * l + r * r; }
+                if(j + 1 == size) { last = l * l + r * r; }
+            }
+            CATCH_CHECK(tail <= energy * 1e-4);
+            CATCH_CHECK(tail + last > energy * 1e-4);
+        }
+        CATCH_CHECK(total < nrows * ncols);
+        hoa_check_binaural(sadie, 64);
+
+        sadie.setTruncation(-60.);
+        sadie.setPartitioning(ConvolverNonUniform<double>::NonUniform);
+        sadie.prepare(16);
+        hoa_check_binaural(sadie, 16);
+
+        sadie.setTruncation(0.);
+        CATCH_CHECK(sadie.getResponseSize(15) == nrows);
+        CATCH_CHECK(sadie.getResponseSize(16) == 0);
+        hoa_check_binaural(sadie, 16);
+    }
+}
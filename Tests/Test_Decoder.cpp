@@ -219,3 +219,359 @@ CATCH_TEST_CASE("Decoder 3D", "[Decoder] [3D]")
         decoder.process(harmonics.data(), outputs.data());
     }
 }
+
+template<Dimension D> void hoa_check_block(DecoderRegular<D, hoa_float_t>& decoder, const size_t vectorsize)
+{
+    const size_t nharm = decoder.getNumberOfHarmonics();
+    const size_t nplws = decoder.getNumberOfPlanewaves();
+    std::vector<std::vector<hoa_float_t>> inputs(nharm, std::vector<hoa_float_t>(vectorsize));
+    std::vector<std::vector<hoa_float_t>> outputs(nplws, std::vector<hoa_float_t>(vectorsize));
+    std::vector<const hoa_float_t*> ins(nharm);
+    std::vector<hoa_float_t*> outs(nplws);
+    std::vector<hoa_float_t> harmonics(nharm);
+    std::vector<hoa_float_t> expected(nplws);
+    std::vector<hoa_float_t> transposed(nplws);
+    for(size_t i = 0; i < nharm; ++i)
+    {
+        for(size_t j = 0; j < vectorsize; ++j)
+        {
+            inputs[i][j] = hoa_float_t(std::sin(double(i * vectorsize + j) * 0.37));
+        }
+        ins[i] = inputs[i].data();
+    }
+    for(size_t i = 0; i < nplws; ++i)
+    {
+        outs[i] = outputs[i].data();
+    }
+
+    decoder.prepare(vectorsize);
+    CATCH_CHECK(decoder.getVectorSize() == vectorsize);
+    decoder.processBlock(ins.data(), outs.data());
+    for(size_t j = 0; j < vectorsize; ++j)
+    {
+        for(size_t i = 0; i < nharm; ++i)
+        {
+            harmonics[i] = inputs[i][j];
+        }
+        decoder.setTransposed(false);
+        decoder.process(harmonics.data(), expected.data());
+        decoder.setTransposed(true);
+        decoder.process(harmonics.data(), transposed.data());
+        for(size_t i = 0; i < nplws; ++i)
+        {
+            CATCH_CHECK(outputs[i][j] == Approx(expected[i]).margin(1e-5));
+            CATCH_CHECK(transposed[i] == Approx(expected[i]).margin(1e-5));
+        }
+    }
+    CATCH_CHECK(decoder.getTransposed());
+    CATCH_CHECK(decoder.getVectorSize() == vectorsize);
+}
+
+CATCH_TEST_CASE("Decoder Block", "[Decoder] [2D] [3D]")
+{
+    CATCH_SECTION("Regular 2D")
+    {
+        DecoderRegular<Hoa2d, hoa_float_t> decoder(7, 17);
+        hoa_check_block(decoder, 64);
+        hoa_check_block(decoder, 13);
+    }
+
+    CATCH_SECTION("Regular 3D")
+    {
+        DecoderRegular<Hoa3d, hoa_float_t> decoder(3, 22);
+        hoa_check_block(decoder, 64);
+        hoa_check_block(decoder, 7);
+    }
+}
+
+CATCH_TEST_CASE("Decoder 3D Irregular", "[Decoder] [3D]")
+{
+    // a dome of 60 loudspeakers without loudspeakers below the horizontal plane
+    const std::vector<std::pair<size_t, hoa_float_t>> rings = {{24, 0.f}, {16, 0.35f}, {12, 0.8f}, {7, 1.2f}, {1, 1.5707963f}};
+    DecoderIrregular<Hoa3d, hoa_float_t> decoder(5, 60);
+    size_t index = 0;
+    for(auto const& ring : rings)
+    {
+        for(size_t i = 0; i < ring.first; ++i, ++index)
+        {
+            decoder.setPlanewaveAzimuth(index, hoa_float_t(i) * hoa_float_t(HOA_2PI) / hoa_float_t(ring.first));
+            decoder.setPlanewaveElevation(index, ring.second);
+        }
+    }
+    decoder.prepare(32);
+    CATCH_CHECK((decoder.getMode() == Decoder<Hoa3d, hoa_float_t>::IrregularMode));
+    CATCH_CHECK(decoder.getNumberOfVirtualPlanewaves() == 240);
+
+    Encoder<Hoa3d, hoa_float_t> encoder(5);
+    hoa_float_t input(1.);
+    std::vector<hoa_float_t> harmonics(36);
+    std::vector<hoa_float_t> outputs(60);
+
+    CATCH_SECTION("Localization")
+    {
+        for(size_t speaker : {size_t(0), size_t(5), size_t(30), size_t(45), size_t(52), size_t(59)})
+        {
+            encoder.setAzimuth(decoder.getPlanewaveAzimuth(speaker));
+            encoder.setElevation(decoder.getPlanewaveElevation(speaker));
+            encoder.process(&input, harmonics.data());
+            decoder.process(harmonics.data(), outputs.data());
+            const auto loudest = std::max_element(outputs.begin(), outputs.end());
+            CATCH_CHECK(size_t(loudest - outputs.begin()) == speaker);
+            for(auto value : outputs)
+            {
+                CATCH_CHECK(std::isfinite(value));
+            }
+        }
+    }
+
+    CATCH_SECTION("Symmetry")
+    {
+        // the first ring receives the same omnidirectional coefficient
+        const hoa_float_t* matrix = decoder.getMatrix();
+        for(size_t i = 1; i < 24; ++i)
+        {
+            CATCH_CHECK(matrix[i * 36] == Approx(matrix[0]).epsilon(0.1));
+        }
+    }
+
+    CATCH_SECTION("Block")
+    {
+        std::vector<std::vector<hoa_float_t>> inputs(36, std::vector<hoa_float_t>(32));
+        std::vector<std::vector<hoa_float_t>> blocks(60, std::vector<hoa_float_t>(32));
+        std::vector<const hoa_float_t*> ins(36);
+        std::vector<hoa_float_t*> outs(60);
+        for(size_t i = 0; i < 36; ++i)
+        {
+            for(size_t j = 0; j < 32; ++j)
+            {
+                inputs[i][j] = hoa_float_t(std::cos(double(i * 32 + j) * 0.21));
+            }
+            ins[i] = inputs[i].data();
+        }
+        for(size_t i = 0; i < 60; ++i)
+        {
+            outs[i] = blocks[i].data();
+        }
+        decoder.processBlock(ins.data(), outs.data());
+        for(size_t j = 0; j < 32; ++j)
+        {
+            for(size_t i = 0; i < 36; ++i)
+            {
+                harmonics[i] = inputs[i][j];
+            }
+            decoder.process(harmonics.data(), outputs.data());
+            for(size_t i = 0; i < 60; ++i)
+            {
+                CATCH_CHECK(blocks[i][j] == Approx(outputs[i]).margin(1e-5));
+            }
+        }
+    }
+
+    CATCH_SECTION("Sparse")
+    {
+        // the matrix of the dome is dense
+        SparseMatrix<hoa_float_t> sparse;
+        CATCH_CHECK(sparse.compress(60, 36, decoder.getMatrix(), hoa_float_t(1e-5)) > 0.99);
+
+        // keeps 6 harmonics for each loudspeaker
+        std::vector<hoa_float_t> matrix(decoder.getMatrix(), decoder.getMatrix() + 60 * 36);
+        for(size_t i = 0; i < 60; ++i)
+        {
+            for(size_t j = 0; j < 36; ++j)
+            {
+                if((j + i) % 6) { matrix[i * 36 + j] = 0.f; }
+            }
+        }
+        CATCH_CHECK(sparse.compress(60, 36, matrix.data(), hoa_float_t(1e-5)) == Approx(1. / 6.));
+        CATCH_CHECK(sparse.getDensity() == Approx(1. / 6.));
+
+        std::vector<hoa_float_t> expected(60);
+        std::vector<std::vector<hoa_float_t>> inputs(36, std::vector<hoa_float_t>(32));
+        std::vector<std::vector<hoa_float_t>> blocks(60, std::vector<hoa_float_t>(32));
+        std::vector<const hoa_float_t*> ins(36);
+        std::vector<hoa_float_t*> outs(60);
+        for(size_t i = 0; i < 36; ++i)
+        {
+            for(size_t j = 0; j < 32; ++j)
+            {
+                inputs[i][j] = hoa_float_t(std::sin(double(i * 32 + j) * 0.43));
+            }
+            ins[i] = inputs[i].data();
+        }
+        for(size_t i = 0; i < 60; ++i)
+        {
+            outs[i] = blocks[i].data();
+        }
+        sparse.mul(32, ins.data(), outs.data());
+        for(size_t j = 0; j < 32; ++j)
+        {
+            for(size_t i = 0; i < 36; ++i)
+            {
+                harmonics[i] = inputs[i][j];
+            }
+            sparse.mul(harmonics.data(), outputs.data());
+            Signal<hoa_float_t>::mul(36, 60, harmonics.data(), matrix.data(), expected.data());
+            for(size_t i = 0; i < 60; ++i)
+            {
+                CATCH_CHECK(outputs[i] == Approx(expected[i]).margin(1e-5));
+                CATCH_CHECK(blocks[i][j] == Approx(expected[i]).margin(1e-5));
+            }
+        }
+    }
+}
+
+CATCH_TEST_CASE("Decoder 2D Irregular", "[Decoder] [2D]")
+{
+    const size_t nplws = 128;
+    DecoderIrregular<Hoa2d, hoa_float_t> decoder(7, nplws);
+    DecoderIrregular<Hoa2d, hoa_float_t> fresh(7, nplws);
+    Encoder<Hoa2d, hoa_float_t> encoder(7);
+    hoa_float_t input(1.);
+    std::vector<hoa_float_t> harmonics(15);
+    std::vector<hoa_float_t> outputs(nplws);
+    std::vector<hoa_float_t> expected(nplws);
+
+    // an irregular ring given in a shuffled order
+    for(size_t i = 0; i < nplws; ++i)
+    {
+        const size_t position = (i * 37) % nplws;
+        const hoa_float_t azimuth = (hoa_float_t(position) + hoa_float_t(0.3) * std::sin(hoa_float_t(position))) * hoa_float_t(HOA_2PI) / hoa_float_t(nplws);
+        decoder.setPlanewaveAzimuth(i, azimuth);
+        fresh.setPlanewaveAzimuth(i, azimuth);
+    }
+    decoder.prepare();
+    CATCH_CHECK((decoder.getMode() == Decoder<Hoa2d, hoa_float_t>::IrregularMode));
+
+    CATCH_SECTION("Localization")
+    {
+        for(size_t speaker : {size_t(0), size_t(1), size_t(64), size_t(127)})
+        {
+            encoder.setAzimuth(decoder.getPlanewaveAzimuth(speaker));
+            encoder.process(&input, harmonics.data());
+            decoder.process(harmonics.data(), outputs.data());
+            // the main lobe at the order 7 covers several loudspeakers
+            const auto loudest = std::max_element(outputs.begin(), outputs.end());
+            const hoa_float_t azimuth = decoder.getPlanewaveAzimuth(size_t(loudest - outputs.begin()));
+            const hoa_float_t distance = std::acos(std::cos(azimuth - decoder.getPlanewaveAzimuth(speaker)));
+            CATCH_CHECK(distance < hoa_float_t(HOA_PI) / hoa_float_t(15));
+        }
+    }
+
+    CATCH_SECTION("Edit")
+    {
+        // moves a loudspeaker and prepares again
+        decoder.setPlanewaveAzimuth(3, hoa_float_t(2.));
+        decoder.prepare();
+        fresh.setPlanewaveAzimuth(3, hoa_float_t(2.));
+        fresh.prepare();
+
+        encoder.setAzimuth(hoa_float_t(1.9));
+        encoder.process(&input, harmonics.data());
+        decoder.process(harmonics.data(), outputs.data());
+        fresh.process(harmonics.data(), expected.data());
+        for(size_t i = 0; i < nplws; ++i)
+        {
+            CATCH_CHECK(outputs[i] == Approx(expected[i]).margin(1e-6));
+        }
+    }
+
+    CATCH_SECTION("Duplicates")
+    {
+        // two loudspeakers at the same position
+        decoder.setPlanewaveAzimuth(5, decoder.getPlanewaveAzimuth(6));
+        decoder.prepare();
+        encoder.setAzimuth(hoa_float_t(0.5));
+        encoder.process(&input, harmonics.data());
+        decoder.process(harmonics.data(), outputs.data());
+        for(auto value : outputs)
+        {
+            CATCH_CHECK(std::isfinite(value));
+        }
+    }
+}
+
+CATCH_TEST_CASE("Decoder Mode Matching and Energy Preserving", "[Decoder] [2D] [3D]")
+{
+    CATCH_SECTION("Regular layout 2D")
+    {
+        // on a regular layout both decoders match the regular decoder up to a gain
+        DecoderRegular<Hoa2d, hoa_float_t> regular(3, 8);
+        DecoderModeMatching<Hoa2d, hoa_float_t> matching(3, 8);
+        DecoderEnergyPreserving<Hoa2d, hoa_float_t> preserving(3, 8);
+        CATCH_CHECK((matching.getMode() == Decoder<Hoa2d, hoa_float_t>::ModeMatchingMode));
+        CATCH_CHECK((preserving.getMode() == Decoder<Hoa2d, hoa_float_t>::EnergyPreservingMode));
+        matching.setRegularization(0.f);
+        matching.prepare();
+        CATCH_CHECK(matching.getRegularization() == 0.f);
+        const hoa_float_t gain = hoa_float_t(7. * 2. / 8.);
+        for(size_t i = 0; i < 8 * 7; ++i)
+        {
+            CATCH_CHECK(matching.getMatrix()[i] == Approx(regular.getMatrix()[i] * gain).margin(1e-5));
+            CATCH_CHECK(preserving.getMatrix()[i] == Approx(regular.getMatrix()[i] * gain).margin(1e-5));
+        }
+    }
+
+    // an irregular dome with more loudspeakers than harmonics
+    const size_t order = 2;
+    const size_t nplws = 14;
+    DecoderModeMatching<Hoa3d, hoa_float_t> matching(order, nplws);
+    DecoderEnergyPreserving<Hoa3d, hoa_float_t> preserving(order, nplws);
+    for(size_t i = 0; i < nplws; ++i)
+    {
+        const hoa_float_t azimuth = hoa_float_t(i) * hoa_float_t(2.4);
+        const hoa_float_t elevation = hoa_float_t(std::asin(1. - (2. * double(i) + 1.) / double(nplws)));
+        matching.setPlanewaveAzimuth(i, azimuth);
+        matching.setPlanewaveElevation(i, elevation);
+        preserving.setPlanewaveAzimuth(i, azimuth);
+        preserving.setPlanewaveElevation(i, elevation);
+    }
+    matching.setRegularization(hoa_float_t(1e-6));
+    matching.prepare();
+    preserving.prepare();
+
+    Encoder<Hoa3d, hoa_float_t> encoder(order);
+    Encoder<Hoa3d, hoa_float_t> reencoder(order);
+    hoa_float_t input(1.);
+    std::vector<hoa_float_t> harmonics(9);
+    std::vector<hoa_float_t> temp(9);
+    std::vector<hoa_float_t> reencoded(9);
+    std::vector<hoa_float_t> outputs(nplws);
+
+    CATCH_SECTION("Mode Matching")
+    {
+        // the harmonics of the decoded plane waves match the harmonics of the source
+        encoder.setAzimuth(hoa_float_t(0.7));
+        encoder.setElevation(hoa_float_t(0.3));
+        encoder.process(&input, harmonics.data());
+        matching.process(harmonics.data(), outputs.data());
+        std::fill(reencoded.begin(), reencoded.end(), hoa_float_t(0));
+        for(size_t i = 0; i < nplws; ++i)
+        {
+            reencoder.setAzimuth(matching.getPlanewaveAzimuth(i));
+            reencoder.setElevation(matching.getPlanewaveElevation(i));
+            reencoder.process(&outputs[i], temp.data());
+            for(size_t j = 0; j < 9; ++j) { reencoded[j] += temp[j]; }
+        }
+        for(size_t j = 0; j < 9; ++j)
+        {
+            CATCH_CHECK(reencoded[j] == Approx(harmonics[j]).margin(1e-3));
+        }
+    }
+
+    CATCH_SECTION("Energy Preserving")
+    {
+        // the energy of the plane waves doesn't depend on the direction of the source
+        hoa_float_t reference = 0;
+        for(size_t k = 0; k < 8; ++k)
+        {
+            encoder.setAzimuth(hoa_float_t(k) * hoa_float_t(0.9));
+            encoder.setElevation(hoa_float_t(k) * hoa_float_t(0.2) - hoa_float_t(0.7));
+            encoder.process(&input, harmonics.data());
+            preserving.process(harmonics.data(), outputs.data());
+            hoa_float_t energy = 0;
+            for(auto value : outputs) { energy += value * value; }
+            if(k == 0) { reference = energy; }
+            CATCH_CHECK(energy == Approx(reference).epsilon(1e-3));
+        }
+    }
+}
@@ -0,0 +1,167 @@
+/*
+// Copyright (c) 2015 Pierre Guillot.
+// For information on usage and redistribution, and for a DISCLAIMER OF ALL
+// WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+*/
+
+#include <cfloat>
+#include <cmath>
+
+#include <Hoa.hpp>
+using namespace hoa;
+
+#define CATCH_CONFIG_PREFIX_ALL
+#include "catch.hpp"
+
+// the harmonics of a plane wave with a signal
+static void hoa_batch_signal(const size_t nharmos, const size_t vsize, const size_t block, std::vector<double>& inputs)
+{
+    Encoder<Hoa3d, double> encoder(Harmonic<Hoa3d, double>::getDegree(nharmos - 1));
+    std::vector<double> harmonics(nharmos);
+    const double azimuth = 1.1, elevation = 0.4;
+    encoder.processDirections(1, &azimuth, &elevation, harmonics.data());
+    for(size_t n = 0; n < vsize; ++n)
+    {
+        const size_t t = block * vsize + n;
+        const double source = std::sin(double(t) * 0.13) + ((t % 37 == 0) ? 1. : 0.);
+        for(size_t i = 0; i < nharmos; ++i)
+        {
+            inputs[i * vsize + n] = source * harmonics[i];
+        }
+    }
+}
+
+CATCH_TEST_CASE("Decoder Binaural Batch", "[Decoder] [Binaural] [3D]")
+{
+    typedef DecoderBinaural<Hoa3d, double, hrir::Sadie_D2_3D> decoder_t;
+    typedef DecoderBinauralBatch<double, hrir::Sadie_D2_3D> batch_t;
+    const size_t order = 3;
+    const size_t vsize = 64;
+    const size_t nlisteners = 5;
+    const size_t nblocks = 10;
+    const size_t nharmos = Harmonic<Hoa3d, double>::getNumberOfHarmonics(order);
+
+    std::vector<double> inputs(nharmos * vsize);
+    std::vector<const double*> ins(nharmos);
+    for(size_t i = 0; i < nharmos; ++i) { ins[i] = inputs.data() + i * vsize; }
+
+    CATCH_SECTION("Listeners")
+    {
+        // each listener is a decoder with the same orientation
+        batch_t batch(order, nlisteners);
+        CATCH_CHECK(batch.getNumberOfListeners() == nlisteners);
+        CATCH_CHECK(batch.getNumberOfOutputs() == nlisteners * 2);
+        CATCH_CHECK(batch.getNumberOfThreads() == 1);
+        CATCH_CHECK(batch.getLatency() == 0);
+        batch.prepare(vsize);
+        std::vector<std::unique_ptr<decoder_t>> decoders;
+        for(size_t l = 0; l < nlisteners; ++l)
+        {
+            const double angle = double(l) * 0.7 - 1.2;
+            decoders.emplace_back(new decoder_t(order));
+            decoders.back()->prepare(vsize);
+            batch.setHeadOrientation(l, angle, angle * 0.4, -angle * 0.3);
+            decoders.back()->setHeadOrientation(angle, angle * 0.4, -angle * 0.3);
+        }
+
+        std::vector<double> outputs(nlisteners * 2 * vsize);
+        std::vector<double*> outs(nlisteners * 2);
+        for(size_t i = 0; i < nlisteners * 2; ++i) { outs[i] = outputs.data() + i * vsize; }
+        std::vector<double> references(2 * vsize);
+        std::vector<double*> refs = {references.data(), references.data() + vsize};
+
+        // the interpolation of the rotation of the decoders is applied to silence
+        std::fill(inputs.begin(), inputs.end(), 0.);
+        batch.processBlock(ins.data(), outs.data());
+        for(auto& decoder : decoders) { decoder->processBlock(ins.data(), refs.data()); }
+        for(size_t b = 0; b < nblocks; ++b)
+        {
+            hoa_batch_signal(nharmos, vsize, b, inputs);
+            batch.processBlock(ins.data(), outs.data());
+            for(size_t l = 0; l < nlisteners; ++l)
+            {
+                decoders[l]->processBlock(ins.data(), refs.data());
+                for(size_t n = 0; n < 2 * vsize; ++n)
+                {
+                    CATCH_CHECK(outputs[l * 2 * vsize + n] == Approx(references[n]).margin(1e-9));
+                }
+            }
+        }
+    }
+
+    CATCH_SECTION("Orientation")
+    {
+        // a listener that turns the head converges to a listener with the new orientation
+        batch_t batch(order, 2);
+        batch.prepare(vsize);
+        batch.setHeadOrientation(0, 0.3, 0., 0.);
+        batch.setHeadOrientation(1, -0.9, 0.2, 0.1);
+        std::vector<double> outputs(4 * vsize);
+        std::vector<double*> outs = {outputs.data(), outputs.data() + vsize, outputs.data() + 2 * vsize, outputs.data() + 3 * vsize};
+        for(size_t b = 0; b < 3; ++b)
+        {
+            hoa_batch_signal(nharmos, vsize, b, inputs);
+            batch.processBlock(ins.data(), outs.data());
+        }
+
+        // the partitions of the responses of 256 samples cover 4 blocks
+        const double cy = std::cos(-0.45), sy = std::sin(-0.45);
+        const double cp = std::cos(0.1), sp = std::sin(-0.1);
+        const double cr = std::cos(0.05), sr = std::sin(0.05);
+        batch.setHeadOrientation(0, cy * cp * cr + sy * sp * sr, cy * cp * sr - sy * sp * cr,
+                                 cy * sp * cr + sy * cp * sr, sy * cp * cr - cy * sp * sr);
+        for(size_t b = 3; b < 3 + nblocks; ++b)
+        {
+            hoa_batch_signal(nharmos, vsize, b, inputs);
+            batch.processBlock(ins.data(), outs.data());
+            if(b >= 3 + 4)
+            {
+                for(size_t n = 0; n < 2 * vsize; ++n)
+                {
+                    CATCH_CHECK(outputs[n] == Approx(outputs[2 * vsize + n]).margin(1e-9));
+                }
+            }
+        }
+    }
+
+    CATCH_SECTION("Threads")
+    {
+        // the threads give the same outputs, in-place
+        batch_t single(order, nlisteners, 1);
+        batch_t multiple(order, nlisteners, 3);
+        CATCH_CHECK(multiple.getNumberOfThreads() == 3);
+        single.prepare(vsize);
+        multiple.prepare(vsize);
+        for(size_t l = 0; l < nlisteners; ++l)
+        {
+            const double angle = double(l) * 0.5 + 0.2;
+            single.setHeadOrientation(l, angle, -angle * 0.2, angle * 0.1);
+            multiple.setHeadOrientation(l, angle, -angle * 0.2, angle * 0.1);
+        }
+
+        std::vector<double> outputs(nlisteners * 2 * vsize);
+        std::vector<double*> outs(nlisteners * 2);
+        for(size_t i = 0; i < nlisteners * 2; ++i) { outs[i] = outputs.data() + i * vsize; }
+        std::vector<double> buffer(std::max(nharmos, nlisteners * 2) * vsize);
+        std::vector<const double*> bins(nharmos);
+        std::vector<double*> bouts(nlisteners * 2);
+        for(size_t i = 0; i < nharmos; ++i) { bins[i] = buffer.data() + i * vsize; }
+        for(size_t i = 0; i < nlisteners * 2; ++i) { bouts[i] = buffer.data() + i * vsize; }
+        for(size_t b = 0; b < nblocks; ++b)
+        {
+            hoa_batch_signal(nharmos, vsize, b, inputs);
+            std::copy(inputs.begin(), inputs.end(), buffer.begin());
+            single.processBlock(ins.data(), outs.data());
+            multiple.processBlock(bins.data(), bouts.data());
+            for(size_t n = 0; n < nlisteners * 2 * vsize; ++n)
+            {
+                CATCH_CHECK(buffer[n] == outputs[n]);
+            }
+        }
+
+        // prepared again with another vector size
+        multiple.prepare(vsize / 2);
+        multiple.processBlock(bins.data(), bouts.data());
+        CATCH_CHECK(multiple.getVectorSize() == vsize / 2);
+    }
+}
@@ -0,0 +1,114 @@
+/*
+// Copyright (c) 2015 Pierre Guillot.
+// For information on usage and redistribution, and for a DISCLAIMER OF ALL
+// WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+*/
+
+#include <cfloat>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+#include <Hoa.hpp>
+using namespace hoa;
+
+#define CATCH_CONFIG_PREFIX_ALL
+#include "catch.hpp"
+
+CATCH_TEST_CASE("DecoderCache 3D", "[Decoder] [DecoderCache] [3D]")
+{
+    typedef DecoderIrregular<Hoa3d, float> decoder_t;
+    typedef DecoderCache<Hoa3d, float> cache_t;
+    cache_t cache(".");
+    decoder_t decoder1(3, 20);
+    decoder_t decoder2(3, 20);
+    for(size_t i = 0; i < 20; ++i)
+    {
+        const float azimuth = float(i) * 2.39996323f;
+        const float elevation = std::asin(1.f - (float(i) + 0.5f) / 20.f);
+        decoder1.setPlanewaveAzimuth(i, azimuth);
+        decoder1.setPlanewaveElevation(i, elevation);
+        decoder2.setPlanewaveAzimuth(i, azimuth);
+        decoder2.setPlanewaveElevation(i, elevation);
+    }
+    const uint64_t key = cache_t::hash(decoder1);
+    CATCH_CHECK(key == cache_t::hash(decoder2));
+    std::remove(cache.getPath(key).c_str());
+
+    // the first decoder is prepared and stored, the second is loaded
+    CATCH_CHECK_FALSE(cache.prepare(decoder1, 32));
+    CATCH_CHECK(cache.prepare(decoder2, 32));
+    const size_t size = 20 * 16;
+    for(size_t i = 0; i < size; ++i)
+    {
+        CATCH_CHECK(decoder2.getMatrix()[i] == decoder1.getMatrix()[i]);
+    }
+
+    CATCH_SECTION("Keys")
+    {
+        const float regularization = 0.01f;
+        CATCH_CHECK(key != cache_t::hash(decoder1, &regularization, 1));
+        decoder2.setPlanewavesRotation(0.f, 0.f, 0.1f);
+        CATCH_CHECK(key != cache_t::hash(decoder2));
+        decoder2.setPlanewavesRotation(0.f, 0.f, 0.f);
+        decoder2.setPlanewaveElevation(3, 0.2f);
+        CATCH_CHECK(key != cache_t::hash(decoder2));
+        DecoderModeMatching<Hoa3d, float> matching(3, 20);
+        CATCH_CHECK(cache_t::hash(matching) != cache_t::hash(decoder_t(3, 20)));
+
+        // the regularization of the decoder is a part of the key
+        DecoderModeMatching<Hoa3d, float> regularized(3, 20);
+        CATCH_CHECK(cache_t::hash(matching) == cache_t::hash(regularized));
+        regularized.setRegularization(0.05f);
+        CATCH_CHECK(cache_t::hash(matching) != cache_t::hash(regularized));
+    }
+
+    CATCH_SECTION("Corruption")
+    {
+        {
+            std::fstream stream(cache.getPath(key), std::ios::binary | std::ios::in | std::ios::out);
+            stream.seekp(100);
+            const char byte = 0x7f;
+            stream.write(&byte, 1);
+        }
+        decoder_t decoder3(3, 20);
+        CATCH_CHECK_FALSE(cache.load(key, decoder3));
+        CATCH_CHECK_FALSE(cache.prepare(decoder2));
+        CATCH_CHECK(cache.load(key, decoder3));
+    }
+
+    std::remove(cache.getPath(key).c_str());
+}
+
+CATCH_TEST_CASE("DecoderCache 2D", "[Decoder] [DecoderCache] [2D]")
+{
+    typedef DecoderCache<Hoa2d, float> cache_t;
+    cache_t cache("./");
+    DecoderIrregular<Hoa2d, float> decoder1(5, 7);
+    DecoderIrregular<Hoa2d, float> decoder2(5, 7);
+    const std::vector<float> azimuths = {0.f, 0.6f, 1.5f, 2.5f, 3.3f, 4.4f, 5.5f};
+    for(size_t i = 0; i < 7; ++i)
+    {
+        decoder1.setPlanewaveAzimuth(i, azimuths[i]);
+        decoder2.setPlanewaveAzimuth(i, azimuths[i]);
+    }
+    const uint64_t key = cache_t::hash(decoder1);
+    std::remove(cache.getPath(key).c_str());
+    CATCH_CHECK_FALSE(cache.prepare(decoder1));
+    CATCH_CHECK(cache.prepare(decoder2));
+
+    Encoder<Hoa2d, float> encoder(5);
+    const float input = 1.f;
+    std::vector<float> harmonics(11);
+    std::vector<float> outputs1(7);
+    std::vector<float> outputs2(7);
+    encoder.setAzimuth(2.f);
+    encoder.process(&input, harmonics.data());
+    decoder1.process(harmonics.data(), outputs1.data());
+    decoder2.process(harmonics.data(), outputs2.data());
+    for(size_t i = 0; i < 7; ++i)
+    {
+        CATCH_CHECK(outputs2[i] == outputs1[i]);
+    }
+    std::remove(cache.getPath(key).c_str());
+}
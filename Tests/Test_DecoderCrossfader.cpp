@@ -0,0 +1,126 @@
+/*
+// Copyright (c) 2015 Pierre Guillot.
+// For information on usage and redistribution, and for a DISCLAIMER OF ALL
+// WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+*/
+
+#include <cfloat>
+#include <cmath>
+#include <thread>
+
+#include <Hoa.hpp>
+using namespace hoa;
+
+#define CATCH_CONFIG_PREFIX_ALL
+#include "catch.hpp"
+
+CATCH_TEST_CASE("DecoderCrossfader", "[Decoder] [DecoderCrossfader] [2D]")
+{
+    DecoderCrossfader<Hoa2d, float> crossfader(3, 8, 16);
+    DecoderRegular<Hoa2d, float> decoder1(3, 8);
+    DecoderIrregular<Hoa2d, float> decoder2(3, 8);
+    decoder2.setPlanewavesRotation(0.f, 0.f, 0.4f);
+    decoder2.prepare();
+
+    Encoder<Hoa2d, float> encoder(3);
+    const float input = 1.f;
+    std::vector<float> harmonics(7);
+    std::vector<float> outputs(8);
+    std::vector<float> expected1(8);
+    std::vector<float> expected2(8);
+    encoder.setAzimuth(1.f);
+    encoder.process(&input, harmonics.data());
+    decoder1.process(harmonics.data(), expected1.data());
+    decoder2.process(harmonics.data(), expected2.data());
+
+    // nothing published yet
+    crossfader.process(harmonics.data(), outputs.data());
+    for(auto value : outputs) { CATCH_CHECK(value == 0.f); }
+
+    // the first matrix is used without crossfade
+    crossfader.setFadeLength(4);
+    CATCH_CHECK(crossfader.getFadeLength() == 4);
+    crossfader.publish(decoder1);
+    crossfader.process(harmonics.data(), outputs.data());
+    CATCH_CHECK_FALSE(crossfader.isFading());
+    for(size_t i = 0; i < 8; ++i)
+    {
+        CATCH_CHECK(outputs[i] == Approx(expected1[i]).margin(1e-6));
+    }
+
+    CATCH_SECTION("Sample")
+    {
+        crossfader.publish(decoder2);
+        for(size_t k = 1; k <= 4; ++k)
+        {
+            crossfader.process(harmonics.data(), outputs.data());
+            const float gain = float(k) / 4.f;
+            for(size_t i = 0; i < 8; ++i)
+            {
+                CATCH_CHECK(outputs[i] == Approx(expected1[i] * (1.f - gain) + expected2[i] * gain).margin(1e-6));
+            }
+        }
+        CATCH_CHECK_FALSE(crossfader.isFading());
+    }
+
+    CATCH_SECTION("Block")
+    {
+        std::vector<std::vector<float>> inputs(7, std::vector<float>(16));
+        std::vector<std::vector<float>> blocks(8, std::vector<float>(16));
+        std::vector<const float*> ins(7);
+        std::vector<float*> outs(8);
+        for(size_t i = 0; i < 7; ++i)
+        {
+            std::fill(inputs[i].begin(), inputs[i].end(), harmonics[i]);
+            ins[i] = inputs[i].data();
+        }
+        for(size_t i = 0; i < 8; ++i) { outs[i] = blocks[i].data(); }
+
+        crossfader.setFadeLength(10);
+        crossfader.publish(decoder2);
+        // published during the crossfade, taken after
+        crossfader.processBlock(ins.data(), outs.data());
+        crossfader.publish(decoder1);
+        for(size_t j = 0; j < 16; ++j)
+        {
+            const float gain = std::min(float(j + 1) / 10.f, 1.f);
+            for(size_t i = 0; i < 8; ++i)
+            {
+                CATCH_CHECK(blocks[i][j] == Approx(expected1[i] * (1.f - gain) + expected2[i] * gain).margin(1e-6));
+            }
+        }
+        CATCH_CHECK_FALSE(crossfader.isFading());
+        crossfader.processBlock(ins.data(), outs.data());
+        CATCH_CHECK(blocks[0][0] == Approx(expected2[0] * 0.9f + expected1[0] * 0.1f).margin(1e-6));
+        CATCH_CHECK(blocks[0][9] == Approx(expected1[0]).margin(1e-6));
+    }
+
+    CATCH_SECTION("Threads")
+    {
+        // a control thread publishes while the audio thread decodes
+        crossfader.setFadeLength(3);
+        std::atomic<bool> done {false};
+        std::thread control([&]()
+        {
+            for(size_t k = 0; k < 2000; ++k)
+            {
+                crossfader.publish((k & 1) ? decoder1.getMatrix() : decoder2.getMatrix());
+            }
+            crossfader.publish(decoder2);
+            done = true;
+        });
+        while(!done)
+        {
+            crossfader.process(harmonics.data(), outputs.data());
+        }
+        control.join();
+        for(size_t k = 0; k < 8; ++k)
+        {
+            crossfader.process(harmonics.data(), outputs.data());
+        }
+        for(size_t i = 0; i < 8; ++i)
+        {
+            CATCH_CHECK(outputs[i] == Approx(expected2[i]).margin(1e-6));
+        }
+    }
+}
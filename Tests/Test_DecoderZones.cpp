@@ -0,0 +1,124 @@
+/*
+// Copyright (c) 2015 Pierre Guillot.
+// For information on usage and redistribution, and for a DISCLAIMER OF ALL
+// WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+*/
+
+#include <cfloat>
+#include <cmath>
+
+#include <Hoa.hpp>
+using namespace hoa;
+
+#define CATCH_CONFIG_PREFIX_ALL
+#include "catch.hpp"
+
+CATCH_TEST_CASE("DecoderZones", "[Decoder] [DecoderZones] [2D]")
+{
+    typedef Optim<Hoa2d, float> optim_t;
+    const size_t order = 3;
+    const size_t nharm = 7;
+    DecoderZones<Hoa2d, float> zones(order, {8, 5, 12}, 16);
+    DecoderRegular<Hoa2d, float> hall(order, 8);
+    DecoderIrregular<Hoa2d, float> lobby(order, 5);
+    DecoderRegular<Hoa2d, float> monitor(order, 12);
+    optim_t optim(order);
+    const std::vector<float> azimuths = {0.f, 0.8f, 2.f, 3.5f, 5.f};
+    for(size_t i = 0; i < 5; ++i) { lobby.setPlanewaveAzimuth(i, azimuths[i]); }
+    lobby.prepare();
+
+    CATCH_CHECK(zones.getNumberOfZones() == 3);
+    CATCH_CHECK(zones.getNumberOfPlanewaves() == 25);
+    CATCH_CHECK(zones.getNumberOfPlanewaves(1) == 5);
+    CATCH_CHECK(zones.getZoneOffset(0) == 0);
+    CATCH_CHECK(zones.getZoneOffset(1) == 8);
+    CATCH_CHECK(zones.getZoneOffset(2) == 13);
+
+    zones.setDecoder(0, hall);
+    zones.setDecoder(1, lobby);
+    zones.setDecoder(2, monitor);
+    zones.setMode(2, optim_t::MaxRe);
+    CATCH_CHECK((zones.getMode(0) == optim_t::Basic));
+    CATCH_CHECK((zones.getMode(2) == optim_t::MaxRe));
+
+    Encoder<Hoa2d, float> encoder(order);
+    std::vector<float> harmonics(nharm);
+    std::vector<float> optimized(nharm);
+    std::vector<float> outputs(25);
+    std::vector<float> expected(25);
+    auto separate = [&]()
+    {
+        hall.process(harmonics.data(), expected.data());
+        lobby.process(harmonics.data(), expected.data() + 8);
+        optim.setMode(optim_t::MaxRe);
+        optim.process(harmonics.data(), optimized.data());
+        monitor.process(optimized.data(), expected.data() + 13);
+    };
+
+    CATCH_SECTION("Sample")
+    {
+        const float input = 0.5f;
+        for(size_t k = 0; k < 6; ++k)
+        {
+            encoder.setAzimuth(float(k) * 1.1f);
+            encoder.process(&input, harmonics.data());
+            zones.process(harmonics.data(), outputs.data());
+            separate();
+            for(size_t i = 0; i < 25; ++i)
+            {
+                CATCH_CHECK(outputs[i] == Approx(expected[i]).margin(1e-5));
+            }
+        }
+    }
+
+    CATCH_SECTION("Block")
+    {
+        std::vector<float> inputs(nharm * 16);
+        std::vector<float> results(25 * 16);
+        std::vector<const float*> ins(nharm);
+        std::vector<float*> outs(25);
+        for(size_t i = 0; i < nharm; ++i) { ins[i] = inputs.data() + i * 16; }
+        for(size_t i = 0; i < 25; ++i) { outs[i] = results.data() + i * 16; }
+        for(size_t i = 0; i < inputs.size(); ++i) { inputs[i] = std::sin(float(i) * 0.7f); }
+        zones.processBlock(ins.data(), outs.data());
+        for(size_t j = 0; j < 16; ++j)
+        {
+            for(size_t i = 0; i < nharm; ++i) { harmonics[i] = inputs[i * 16 + j]; }
+            separate();
+            for(size_t i = 0; i < 25; ++i)
+            {
+                CATCH_CHECK(results[i * 16 + j] == Approx(expected[i]).margin(1e-5));
+            }
+        }
+    }
+
+    CATCH_SECTION("Swap")
+    {
+        const float input = 1.f;
+        encoder.setAzimuth(0.4f);
+        encoder.process(&input, harmonics.data());
+        zones.process(harmonics.data(), outputs.data());
+        separate();
+        const std::vector<float> before = expected;
+
+        // only the lobby changes during the crossfade
+        zones.setFadeLength(4);
+        lobby.setPlanewaveAzimuth(0, 6.f);
+        lobby.prepare();
+        zones.setDecoder(1, lobby);
+        separate();
+        for(size_t k = 1; k <= 4; ++k)
+        {
+            zones.process(harmonics.data(), outputs.data());
+            const float gain = float(k) / 4.f;
+            for(size_t i = 0; i < 25; ++i)
+            {
+                CATCH_CHECK(outputs[i] == Approx(before[i] * (1.f - gain) + expected[i] * gain).margin(1e-5));
+                if(i < 8 || i >= 13)
+                {
+                    CATCH_CHECK(outputs[i] == Approx(before[i]).margin(1e-5));
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,105 @@
+/*
+// Copyright (c) 2015 Pierre Guillot.
+// For information on usage and redistribution, and for a DISCLAIMER OF ALL
+// WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+*/
+
+#include <cfloat>
+#include <cmath>
+
+#include <Hoa.hpp>
+using namespace hoa;
+
+#define CATCH_CONFIG_PREFIX_ALL
+#include "catch.hpp"
+
+template <typename T>
+static std::vector<T> hoa_fft_signal(const size_t size)
+{
+    std::vector<T> signal(size);
+    for(size_t i = 0; i < size; ++i)
+    {
+        signal[i] = T(std::sin(double(i) * 0.37) + double(i % 3) * 0.2 - ((i % 7 == 0) ? 0.5 : 0.));
+    }
+    return signal;
+}
+
+CATCH_TEST_CASE("Fft", "[Fft]")
+{
+    CATCH_SECTION("Naive DFT")
+    {
+        for(size_t size : {4ul, 8ul, 16ul, 32ul, 64ul, 128ul, 512ul, 2048ul})
+        {
+            Fft<double> fft(size);
+            CATCH_CHECK(fft.getSize() == size);
+            CATCH_CHECK(fft.getNumberOfBins() == size / 2 + 1);
+            const auto signal = hoa_fft_signal<double>(size);
+            std::vector<double> real(size / 2 + 1);
+            std::vector<double> imag(size / 2 + 1);
+            fft.forward(signal.data(), real.data(), imag.data());
+            for(size_t k = 0; k <= size / 2; ++k)
+            {
+                double re = 0., im = 0.;
+                for(size_t i = 0; i < size; ++i)
+                {
+                    const double angle = HOA_2PI * double((k * i) % size) / double(size);
+                    re += signal[i] * std::cos(angle);
+                    im -= signal[i] * std::sin(angle);
+                }
+                CATCH_CHECK(real[k] == Approx(re).margin(1e-9));
+                CATCH_CHECK(imag[k] == Approx(im).margin(1e-9));
+            }
+        }
+    }
+
+    CATCH_SECTION("Round trip")
+    {
+        // the error grows with the logarithm of the size
+        for(size_t size = 32; size <= 65536; size *= 2)
+        {
+            Fft<double> fftd(size);
+            Fft<float> fftf(size);
+            const auto sigd = hoa_fft_signal<double>(size);
+            const auto sigf = hoa_fft_signal<float>(size);
+            std::vector<double> reald(size / 2 + 1), imagd(size / 2 + 1), resultd(size);
+            std::vector<float> realf(size / 2 + 1), imagf(size / 2 + 1), resultf(size);
+            fftd.forward(sigd.data(), reald.data(), imagd.data());
+            fftd.inverse(reald.data(), imagd.data(), resultd.data());
+            fftf.forward(sigf.data(), realf.data(), imagf.data());
+            fftf.inverse(realf.data(), imagf.data(), resultf.data());
+            double errord = 0., errorf = 0., errorspectrum = 0.;
+            for(size_t i = 0; i < size; ++i)
+            {
+                errord = std::max(errord, std::abs(resultd[i] - sigd[i]));
+                errorf = std::max(errorf, std::abs(double(resultf[i]) - double(sigf[i])));
+            }
+            for(size_t k = 0; k <= size / 2; ++k)
+            {
+                errorspectrum = std::max(errorspectrum, std::abs(double(realf[k]) - reald[k]));
+                errorspectrum = std::max(errorspectrum, std::abs(double(imagf[k]) - imagd[k]));
+            }
+            CATCH_CHECK(errord < 1e-13);
+            CATCH_CHECK(errorf < 1e-5);
+            CATCH_CHECK(errorspectrum < double(size) * 1e-6);
+        }
+    }
+
+    CATCH_SECTION("Plans")
+    {
+        // the instances of a size share the plan
+        Fft<float> fft1(1024);
+        Fft<float> fft2(1024);
+        Fft<float> fft3(2048);
+        CATCH_CHECK(&fft1.getPlan() == &fft2.getPlan());
+        CATCH_CHECK(&fft1.getPlan() != &fft3.getPlan());
+        CATCH_CHECK(Fft<float>::getPlan(1024).get() == &fft1.getPlan());
+        CATCH_CHECK(fft1.getPlan().radix2);
+        CATCH_CHECK_FALSE(fft3.getPlan().radix2);
+        Fft<float> copy = fft1;
+        CATCH_CHECK(&copy.getPlan() == &fft1.getPlan());
+
+        CATCH_CHECK(Fft<float>::getPowerOfTwo(3) == 4);
+        CATCH_CHECK(Fft<float>::getPowerOfTwo(96) == 128);
+        CATCH_CHECK(Fft<float>::getPowerOfTwo(128) == 128);
+    }
+}
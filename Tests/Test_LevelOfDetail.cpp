@@ -0,0 +1,169 @@
+/*
+// Copyright (c) 2015 Pierre Guillot.
+// For information on usage and redistribution, and for a DISCLAIMER OF ALL
+// WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+*/
+
+#include <cfloat>
+#include <cmath>
+
+#include <Hoa.hpp>
+using namespace hoa;
+
+#define CATCH_CONFIG_PREFIX_ALL
+#include "catch.hpp"
+
+CATCH_TEST_CASE("LevelOfDetail", "[LevelOfDetail] [Decoder] [2D]")
+{
+    const size_t nplws = 12;
+    const size_t vsize = 16;
+    LevelOfDetail<Hoa2d, float> lod(5, nplws, vsize);
+    DecoderRegular<Hoa2d, float> decoder5(5, nplws);
+    DecoderRegular<Hoa2d, float> decoder2(2, nplws);
+
+    // nothing prepared yet
+    std::vector<float> harmonics(11);
+    std::vector<float> outputs(nplws);
+    lod.process(harmonics.data(), outputs.data());
+    for(auto value : outputs) { CATCH_CHECK(value == 0.f); }
+
+    lod.setDecoder(decoder5);
+    lod.setDecoder(decoder2);
+    CATCH_CHECK(lod.hasMatrix(5));
+    CATCH_CHECK(lod.hasMatrix(2));
+    CATCH_CHECK_FALSE(lod.hasMatrix(3));
+    CATCH_CHECK(lod.getFadeLength() == vsize);
+
+    Encoder<Hoa2d, float> encoder(5);
+    const float input = 1.f;
+    std::vector<float> expected5(nplws);
+    std::vector<float> expected2(nplws);
+    encoder.setAzimuth(0.9f);
+    encoder.process(&input, harmonics.data());
+    decoder5.process(harmonics.data(), expected5.data());
+    decoder2.process(harmonics.data(), expected2.data());
+
+    CATCH_SECTION("Sample")
+    {
+        // the first order is used without fade
+        lod.setFadeLength(4);
+        lod.process(harmonics.data(), outputs.data());
+        CATCH_CHECK(lod.getCurrentOrder() == 5);
+        CATCH_CHECK_FALSE(lod.isFading());
+        for(size_t i = 0; i < nplws; ++i)
+        {
+            CATCH_CHECK(outputs[i] == Approx(expected5[i]).margin(1e-6));
+        }
+
+        // the order 3 has no matrix and is replaced by the order 2
+        lod.setOrder(3);
+        for(size_t k = 1; k <= 4; ++k)
+        {
+            lod.process(harmonics.data(), outputs.data());
+            CATCH_CHECK(lod.getCurrentOrder() == 2);
+            const float gain = float(k) / 4.f;
+            for(size_t i = 0; i < nplws; ++i)
+            {
+                CATCH_CHECK(outputs[i] == Approx(expected5[i] * (1.f - gain) + expected2[i] * gain).margin(1e-6));
+            }
+        }
+        CATCH_CHECK_FALSE(lod.isFading());
+        CATCH_CHECK(lod.getNumberOfActiveHarmonics() == 5);
+
+        // the harmonics of the upper degrees are not read
+        std::vector<float> truncated(harmonics.begin(), harmonics.begin() + 5);
+        lod.process(truncated.data(), outputs.data());
+        for(size_t i = 0; i < nplws; ++i)
+        {
+            CATCH_CHECK(outputs[i] == Approx(expected2[i]).margin(1e-6));
+        }
+
+        // an order over the maximum is clipped
+        lod.setOrder(9);
+        CATCH_CHECK(lod.getOrder() == 5);
+    }
+
+    CATCH_SECTION("Block")
+    {
+        std::vector<float> inputs(11 * vsize);
+        std::vector<float> results(nplws * vsize);
+        std::vector<const float*> ins(11);
+        std::vector<float*> outs(nplws);
+        for(size_t i = 0; i < 11; ++i)
+        {
+            ins[i] = inputs.data() + i * vsize;
+            for(size_t j = 0; j < vsize; ++j) { inputs[i * vsize + j] = harmonics[i]; }
+        }
+        for(size_t i = 0; i < nplws; ++i) { outs[i] = results.data() + i * vsize; }
+
+        lod.setOrder(2);
+        lod.processBlock(ins.data(), outs.data());
+        for(size_t i = 0; i < nplws; ++i)
+        {
+            for(size_t j = 0; j < vsize; ++j)
+            {
+                CATCH_CHECK(results[i * vsize + j] == Approx(expected2[i]).margin(1e-6));
+            }
+        }
+
+        // the order is restored over a vector
+        lod.setOrder(5);
+        lod.processBlock(ins.data(), outs.data());
+        for(size_t i = 0; i < nplws; ++i)
+        {
+            for(size_t j = 0; j < vsize; ++j)
+            {
+                const float gain = float(j + 1) / float(vsize);
+                CATCH_CHECK(results[i * vsize + j] == Approx(expected2[i] * (1.f - gain) + expected5[i] * gain).margin(1e-6));
+            }
+        }
+        lod.processBlock(ins.data(), outs.data());
+        CATCH_CHECK(lod.getCurrentOrder() == 5);
+        for(size_t i = 0; i < nplws; ++i)
+        {
+            CATCH_CHECK(results[i * vsize] == Approx(expected5[i]).margin(1e-6));
+        }
+    }
+}
+
+CATCH_TEST_CASE("LoadController", "[LevelOfDetail] [3D]")
+{
+    LoadController<Hoa3d, float> controller(1, 4);
+    controller.setHold(4);
+    CATCH_CHECK(controller.getOrder() == 4);
+
+    // a single slow vector reduces the order, then the controller waits
+    CATCH_CHECK(controller.update(0.9f, 1.f) == 3);
+    for(size_t i = 0; i < 4; ++i)
+    {
+        CATCH_CHECK(controller.update(0.9f, 1.f) == 3);
+    }
+    CATCH_CHECK(controller.update(0.9f, 1.f) == 2);
+
+    // the order never goes under the minimum
+    for(size_t i = 0; i < 64; ++i)
+    {
+        controller.update(2.f, 1.f);
+    }
+    CATCH_CHECK(controller.getOrder() == 1);
+
+    // a moderate load isn't enough to increase the order: 0.3 x 9 / 4 > 0.5
+    for(size_t i = 0; i < 128; ++i)
+    {
+        controller.update(0.3f, 1.f);
+    }
+    CATCH_CHECK(controller.getOrder() == 1);
+    CATCH_CHECK(controller.getLoad() == Approx(0.3f).margin(1e-3));
+
+    // a low load restores the order step by step
+    for(size_t i = 0; i < 128; ++i)
+    {
+        controller.update(0.01f, 1.f);
+    }
+    CATCH_CHECK(controller.getOrder() == 4);
+
+    controller.update(1.f, 1.f);
+    controller.reset();
+    CATCH_CHECK(controller.getOrder() == 4);
+    CATCH_CHECK(controller.getLoad() == 0.f);
+}
@@ -0,0 +1,193 @@
+/*
+// Copyright (c) 2015 Pierre Guillot.
+// For information on usage and redistribution, and for a DISCLAIMER OF ALL
+// WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+*/
+
+#include <cfloat>
+#include <cmath>
+
+#include <Hoa.hpp>
+using namespace hoa;
+
+#define CATCH_CONFIG_PREFIX_ALL
+#include "catch.hpp"
+
+CATCH_TEST_CASE("Mixed Order 3D", "[MixedOrder] [Harmonics] [Encoder] [Optim] [Decoder] [3D]")
+{
+    const size_t order = 7;
+    const size_t vertical = 3;
+    const size_t nharm = 24;
+    const size_t nfull = 64;
+    typedef Harmonic<Hoa3d, float> harmonic3d;
+    typedef Harmonic<Hoa2d, float> harmonic2d;
+
+    CATCH_SECTION("Harmonics")
+    {
+        CATCH_CHECK(harmonic3d::getNumberOfHarmonics(order, vertical) == nharm);
+        CATCH_CHECK(harmonic3d::getNumberOfHarmonics(order, order) == nfull);
+        CATCH_CHECK(harmonic3d::getNumberOfHarmonics(order, 0) == 15);
+        CATCH_CHECK(harmonic2d::getNumberOfHarmonics(order, vertical) == 15);
+
+        Encoder<Hoa3d, float> mixed(order, vertical);
+        CATCH_CHECK(mixed.isMixedOrder());
+        CATCH_CHECK(mixed.getVerticalOrder() == vertical);
+        CATCH_CHECK(mixed.getNumberOfHarmonics() == nharm);
+        for(size_t i = 0; i < 16; ++i)
+        {
+            CATCH_CHECK(mixed.getHarmonicAcn(i) == i);
+        }
+        // [4, -4], [4, 4], [5, -5], [5, 5], ...
+        for(size_t l = 4; l <= order; ++l)
+        {
+            const size_t index = 16 + (l - 4) * 2;
+            CATCH_CHECK(mixed.getHarmonicDegree(index) == l);
+            CATCH_CHECK(mixed.getHarmonicOrder(index) == -long(l));
+            CATCH_CHECK(mixed.getHarmonicOrder(index + 1) == long(l));
+            CATCH_CHECK(mixed.getHarmonicAcn(index) == l * l);
+            CATCH_CHECK(mixed.getHarmonicIndex(l, -long(l)) == index);
+            CATCH_CHECK(mixed.getHarmonicIndex(l, long(l)) == index + 1);
+        }
+        CATCH_CHECK(mixed.getHarmonicIndex(5, 2) == nharm);
+
+        // the full order and the 2D ignore the vertical order
+        Encoder<Hoa3d, float> full(order, order);
+        CATCH_CHECK_FALSE(full.isMixedOrder());
+        CATCH_CHECK(full.getNumberOfHarmonics() == nfull);
+        Encoder<Hoa2d, float> horizontal(order, vertical);
+        CATCH_CHECK_FALSE(horizontal.isMixedOrder());
+        CATCH_CHECK(horizontal.getNumberOfHarmonics() == 15);
+    }
+
+    CATCH_SECTION("Encoder")
+    {
+        Encoder<Hoa3d, float> mixed(order, vertical);
+        Encoder<Hoa3d, float> full(order);
+        std::vector<float> outputs(nharm);
+        std::vector<float> expected(nfull);
+        const float input = 0.8f;
+        for(size_t k = 0; k < 64; ++k)
+        {
+            const float azimuth = float(k) * 0.77f;
+            const float elevation = float(k) * 0.23f - 3.f;
+            const float radius = float(k % 5) * 0.4f;
+            mixed.setCoordinates(radius, azimuth, elevation);
+            full.setCoordinates(radius, azimuth, elevation);
+            mixed.process(&input, outputs.data());
+            full.process(&input, expected.data());
+            for(size_t i = 0; i < nharm; ++i)
+            {
+                CATCH_CHECK(outputs[i] == Approx(expected[mixed.getHarmonicAcn(i)]).margin(1e-5));
+            }
+        }
+
+        // the horizontal only order
+        Encoder<Hoa3d, float> flat(order, 0);
+        flat.setAzimuth(1.3f);
+        flat.setElevation(0.5f);
+        full.setCoordinates(1.f, 1.3f, 0.5f);
+        flat.process(&input, outputs.data());
+        full.process(&input, expected.data());
+        for(size_t i = 0; i < flat.getNumberOfHarmonics(); ++i)
+        {
+            CATCH_CHECK(outputs[i] == Approx(expected[flat.getHarmonicAcn(i)]).margin(1e-5));
+        }
+    }
+
+    CATCH_SECTION("Optim")
+    {
+        for(auto mode : {Optim<Hoa3d, float>::Basic, Optim<Hoa3d, float>::MaxRe, Optim<Hoa3d, float>::InPhase})
+        {
+            Optim<Hoa3d, float> mixed(order, vertical);
+            Optim<Hoa3d, float> full(order);
+            mixed.setMode(mode);
+            full.setMode(mode);
+            CATCH_CHECK(mixed.getNumberOfHarmonics() == nharm);
+            for(size_t i = 0; i < nharm; ++i)
+            {
+                CATCH_CHECK(mixed.getWeights()[i] == Approx(full.getWeights()[mixed.getHarmonicAcn(i)]));
+            }
+        }
+    }
+
+    CATCH_SECTION("Exchanger")
+    {
+        Exchanger<Hoa3d, float> exchanger(order, vertical);
+        Exchanger<Hoa3d, float> full(order);
+        std::vector<float> inputs(nharm);
+        std::vector<float> expanded(nfull);
+        std::vector<float> outputs(nharm);
+        std::vector<float> expected(nfull);
+        for(size_t i = 0; i < nharm; ++i) { inputs[i] = float(i + 1); }
+
+        exchanger.expand(inputs.data(), expanded.data());
+        for(size_t i = 0; i < nfull; ++i)
+        {
+            const size_t degree = harmonic3d::getDegree(i);
+            const long azimuthal = harmonic3d::getOrder(i);
+            if(harmonic3d::isInMixedOrder(degree, azimuthal, vertical))
+            {
+                CATCH_CHECK(expanded[i] == inputs[exchanger.getHarmonicIndex(degree, azimuthal)]);
+            }
+            else
+            {
+                CATCH_CHECK(expanded[i] == 0.f);
+            }
+        }
+        exchanger.contract(expanded.data(), outputs.data());
+        CATCH_CHECK(outputs == inputs);
+
+        exchanger.setNormalization(Exchanger<Hoa3d, float>::toN3D);
+        full.setNormalization(Exchanger<Hoa3d, float>::toN3D);
+        exchanger.process(inputs.data(), outputs.data());
+        full.process(expanded.data(), expected.data());
+        for(size_t i = 0; i < nharm; ++i)
+        {
+            CATCH_CHECK(outputs[i] == Approx(expected[exchanger.getHarmonicAcn(i)]));
+        }
+    }
+
+    CATCH_SECTION("Decoder")
+    {
+        // 49 loudspeakers: 3 rings and the top
+        const size_t nplws = 49;
+        DecoderModeMatching<Hoa3d, float> decoder(order, nplws, vertical);
+        CATCH_CHECK(decoder.getNumberOfHarmonics() == nharm);
+        size_t index = 0;
+        const std::vector<std::pair<size_t, float>> rings = {{24, 0.f}, {16, 0.6f}, {8, 1.1f}, {1, 1.5707963f}};
+        for(auto const& ring : rings)
+        {
+            for(size_t i = 0; i < ring.first; ++i, ++index)
+            {
+                decoder.setPlanewaveAzimuth(index, float(i) * float(HOA_2PI) / float(ring.first) + ring.second);
+                decoder.setPlanewaveElevation(index, ring.second);
+            }
+        }
+        decoder.setRegularization(0.f);
+        decoder.prepare();
+
+        // the harmonics are recreated when the loudspeakers are encoded again
+        Encoder<Hoa3d, float> encoder(order, vertical);
+        std::vector<float> harmonics(nharm);
+        std::vector<float> outputs(nplws);
+        std::vector<float> temp(nharm);
+        std::vector<float> result(nharm);
+        const float input = 1.f;
+        encoder.setAzimuth(0.4f);
+        encoder.setElevation(0.2f);
+        encoder.process(&input, harmonics.data());
+        decoder.process(harmonics.data(), outputs.data());
+        std::fill(result.begin(), result.end(), 0.f);
+        for(size_t j = 0; j < nplws; ++j)
+        {
+            encoder.setAzimuth(decoder.getPlanewaveAzimuth(j));
+            encoder.setElevation(decoder.getPlanewaveElevation(j));
+            encoder.process(&outputs[j], temp.data());
+            for(size_t i = 0; i < nharm; ++i) { result[i] += temp[i]; }
+        }
+        for(size_t i = 0; i < nharm; ++i)
+        {
+            CATCH_CHECK(result[i] == Approx(harmonics[i]).margin(1e-3));
+        }
+    }
+}
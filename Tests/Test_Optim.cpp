@@ -177,3 +177,96 @@ CATCH_TEST_CASE("Optim 3D", "[Optim] [3D]")
         CATCH_CHECK(std::abs(ouputs[63] - inputs[63] * hoa_float_t(0.0002913752978201956)) < epsilon);
     }
 }
+
+CATCH_TEST_CASE("Optim Dual Band", "[Optim] [3D]")
+{
+    typedef Optim<Hoa3d, hoa_float_t> optim_t;
+    const size_t order = 3;
+    const size_t nharm = 16;
+    const hoa_float_t samplerate = 48000.f;
+    OptimDualBand<Hoa3d, hoa_float_t> dual(order, samplerate, 400.f, 32);
+    optim_t maxre(order);
+    maxre.setMode(optim_t::MaxRe);
+    CATCH_CHECK((dual.getLowMode() == optim_t::Basic));
+    CATCH_CHECK((dual.getHighMode() == optim_t::MaxRe));
+    CATCH_CHECK(dual.getFrequency() == Approx(400.f));
+
+    // returns the amplitude of each harmonic for a sine in all the harmonics
+    auto amplitudes = [&](const hoa_float_t frequency)
+    {
+        std::vector<hoa_float_t> inputs(nharm);
+        std::vector<hoa_float_t> outputs(nharm);
+        std::vector<hoa_float_t> result(nharm, 0.f);
+        dual.clear();
+        for(size_t j = 0; j < 24000; ++j)
+        {
+            const hoa_float_t x = std::sin(hoa_float_t(HOA_2PI) * frequency * hoa_float_t(j) / samplerate);
+            std::fill(inputs.begin(), inputs.end(), x);
+            dual.process(inputs.data(), outputs.data());
+            if(j >= 24000 - 960)
+            {
+                for(size_t i = 0; i < nharm; ++i) { result[i] += outputs[i] * outputs[i]; }
+            }
+        }
+        for(auto& value : result) { value = std::sqrt(value / hoa_float_t(480)); }
+        return result;
+    };
+
+    CATCH_SECTION("Bands")
+    {
+        const std::vector<hoa_float_t> low  = amplitudes(50.f);
+        const std::vector<hoa_float_t> high = amplitudes(8000.f);
+        for(size_t i = 0; i < nharm; ++i)
+        {
+            CATCH_CHECK(low[i] == Approx(1.f).margin(1e-2));
+            CATCH_CHECK(high[i] == Approx(maxre.getWeights()[i]).margin(1e-2));
+        }
+    }
+
+    CATCH_SECTION("All-pass")
+    {
+        // the sum of the bands keeps the magnitude at the crossover frequency
+        dual.setModes(optim_t::MaxRe, optim_t::MaxRe);
+        const std::vector<hoa_float_t> cross = amplitudes(400.f);
+        for(size_t i = 0; i < nharm; ++i)
+        {
+            CATCH_CHECK(cross[i] == Approx(maxre.getWeights()[i]).margin(1e-2));
+        }
+    }
+
+    CATCH_SECTION("Block")
+    {
+        OptimDualBand<Hoa3d, hoa_float_t> block(order, 44100.f, 600.f, 32);
+        dual.setSampleRate(44100.f);
+        dual.setFrequency(600.f);
+        CATCH_CHECK(block.getVectorSize() == 32);
+        std::vector<hoa_float_t> inputs(nharm * 32);
+        std::vector<hoa_float_t> outputs(nharm * 32);
+        std::vector<hoa_float_t> frame(nharm);
+        std::vector<hoa_float_t> expected(nharm);
+        std::vector<const hoa_float_t*> ins(nharm);
+        std::vector<hoa_float_t*> outs(nharm);
+        for(size_t i = 0; i < nharm; ++i)
+        {
+            ins[i] = inputs.data() + i * 32;
+            outs[i] = outputs.data() + i * 32;
+        }
+        for(size_t k = 0; k < 4; ++k)
+        {
+            for(size_t i = 0; i < inputs.size(); ++i)
+            {
+                inputs[i] = std::sin(hoa_float_t(i * 7 + k * 13));
+            }
+            block.processBlock(ins.data(), outs.data());
+            for(size_t j = 0; j < 32; ++j)
+            {
+                for(size_t i = 0; i < nharm; ++i) { frame[i] = inputs[i * 32 + j]; }
+                dual.process(frame.data(), expected.data());
+                for(size_t i = 0; i < nharm; ++i)
+                {
+                    CATCH_CHECK(outputs[i * 32 + j] == Approx(expected[i]).margin(1e-5));
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,158 @@
+/*
+// Copyright (c) 2015 Pierre Guillot.
+// For information on usage and redistribution, and for a DISCLAIMER OF ALL
+// WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+*/
+
+#include <cfloat>
+#include <cmath>
+
+#include <Hoa.hpp>
+using namespace hoa;
+
+#define CATCH_CONFIG_PREFIX_ALL
+#include "catch.hpp"
+
+CATCH_TEST_CASE("Panner 2D", "[Panner] [2D]")
+{
+    typedef Panner<Hoa2d, float> panner_t;
+    panner_t panner(5, 2, 16);
+    const std::vector<float> azimuths = {0.f, 1.f, 2.5f, 4.f, 5.2f};
+    for(size_t i = 0; i < 5; ++i) { panner.setPlanewaveAzimuth(i, azimuths[i]); }
+    panner.prepare();
+    CATCH_CHECK(panner.getNumberOfSources() == 2);
+    CATCH_CHECK(panner.getVectorSize() == 16);
+
+    CATCH_SECTION("Amplitude")
+    {
+        // on a loudspeaker
+        panner.setAzimuth(0, 2.5f);
+        CATCH_CHECK(panner.getGain(0, 2) == Approx(1.f));
+        CATCH_CHECK(panner.getGain(0, 1) == Approx(0.f).margin(1e-6));
+
+        // between two loudspeakers, across the origin
+        for(float azimuth : {0.4f, 1.7f, 3.1f, 4.6f, 5.9f})
+        {
+            panner.setAzimuth(1, azimuth);
+            float x = 0.f, y = 0.f, energy = 0.f;
+            size_t count = 0;
+            for(size_t i = 0; i < 5; ++i)
+            {
+                const float gain = panner.getGain(1, i);
+                CATCH_CHECK(gain >= 0.f);
+                count += size_t(gain > 0.f);
+                x += gain * std::cos(azimuths[i]);
+                y += gain * std::sin(azimuths[i]);
+                energy += gain * gain;
+            }
+            CATCH_CHECK(count == 2);
+            CATCH_CHECK(energy == Approx(1.f));
+            CATCH_CHECK(std::atan2(y, x) == Approx(std::atan2(std::sin(azimuth), std::cos(azimuth))).margin(1e-5));
+        }
+    }
+
+    CATCH_SECTION("Intensity")
+    {
+        panner.setMode(panner_t::Intensity);
+        CATCH_CHECK((panner.getMode() == panner_t::Intensity));
+        panner.setAzimuth(0, 0.5f);
+        const float g0 = panner.getGain(0, 0);
+        const float g1 = panner.getGain(0, 1);
+        CATCH_CHECK(g0 * g0 + g1 * g1 == Approx(1.f));
+        const float x = g0 * g0 + g1 * g1 * std::cos(1.f);
+        const float y = g1 * g1 * std::sin(1.f);
+        CATCH_CHECK(std::atan2(y, x) == Approx(0.5f).margin(1e-5));
+    }
+
+    CATCH_SECTION("Block")
+    {
+        panner.setAzimuth(0, 0.3f);
+        panner.setAzimuth(1, 3.f);
+        std::vector<float> inputs(2 * 16);
+        std::vector<float> outputs(5 * 16);
+        std::vector<const float*> ins = {inputs.data(), inputs.data() + 16};
+        std::vector<float*> outs(5);
+        for(size_t i = 0; i < 5; ++i) { outs[i] = outputs.data() + i * 16; }
+        for(size_t i = 0; i < inputs.size(); ++i) { inputs[i] = std::sin(float(i)); }
+
+        // the first block interpolates the new gains, the second one doesn't
+        panner.processBlock(ins.data(), outs.data());
+        panner.processBlock(ins.data(), outs.data());
+        std::vector<float> sample(2);
+        std::vector<float> expected(5);
+        for(size_t j = 0; j < 16; ++j)
+        {
+            sample[0] = inputs[j];
+            sample[1] = inputs[16 + j];
+            panner.process(sample.data(), expected.data());
+            for(size_t i = 0; i < 5; ++i)
+            {
+                CATCH_CHECK(outputs[i * 16 + j] == Approx(expected[i]).margin(1e-6));
+            }
+        }
+
+        // a moving source crossfades between the pairs
+        std::vector<float> before(5), after(5);
+        for(size_t i = 0; i < 5; ++i) { before[i] = panner.getGain(0, i); }
+        panner.setAzimuth(0, 1.6f);
+        for(size_t i = 0; i < 5; ++i) { after[i] = panner.getGain(0, i); }
+        std::fill(inputs.begin() + 16, inputs.end(), 0.f);
+        panner.processBlock(ins.data(), outs.data());
+        for(size_t j = 0; j < 16; ++j)
+        {
+            const float t = float(j + 1) / 16.f;
+            for(size_t i = 0; i < 5; ++i)
+            {
+                CATCH_CHECK(outputs[i * 16 + j] == Approx(inputs[j] * (before[i] * (1.f - t) + after[i] * t)).margin(1e-6));
+            }
+        }
+    }
+}
+
+CATCH_TEST_CASE("Panner 3D", "[Panner] [3D]")
+{
+    // a dome of 60 loudspeakers
+    const std::vector<std::pair<size_t, float>> rings = {{24, 0.f}, {16, 0.35f}, {12, 0.8f}, {7, 1.2f}, {1, 1.5707963f}};
+    Panner<Hoa3d, float> panner(60, 1, 32);
+    size_t index = 0;
+    for(auto const& ring : rings)
+    {
+        for(size_t i = 0; i < ring.first; ++i, ++index)
+        {
+            panner.setPlanewaveAzimuth(index, float(i) * float(HOA_2PI) / float(ring.first));
+            panner.setPlanewaveElevation(index, ring.second);
+        }
+    }
+    panner.prepare();
+
+    for(size_t k = 0; k < 200; ++k)
+    {
+        const float azimuth = float(k) * 2.39996323f;
+        const float elevation = std::asin(float(k) / 200.f);
+        panner.setAzimuth(0, azimuth);
+        panner.setElevation(0, elevation);
+        float x = 0.f, y = 0.f, z = 0.f, energy = 0.f;
+        size_t count = 0;
+        for(size_t i = 0; i < 60; ++i)
+        {
+            const float gain = panner.getGain(0, i);
+            CATCH_CHECK(gain >= 0.f);
+            count += size_t(gain > 0.f);
+            const float a = panner.getPlanewaveAzimuth(i);
+            const float e = panner.getPlanewaveElevation(i);
+            x += gain * std::cos(a) * std::cos(e);
+            y += gain * std::sin(a) * std::cos(e);
+            z += gain * std::sin(e);
+            energy += gain * gain;
+        }
+        CATCH_CHECK(count >= 1);
+        CATCH_CHECK(count <= 3);
+        CATCH_CHECK(energy == Approx(1.f));
+
+        // the velocity vector points to the source
+        const float norm = std::sqrt(x * x + y * y + z * z);
+        const float dot = (x * std::cos(azimuth) * std::cos(elevation)
+                           + y * std::sin(azimuth) * std::cos(elevation) + z * std::sin(elevation)) / norm;
+        CATCH_CHECK(dot == Approx(1.f).margin(1e-4));
+    }
+}
@@ -0,0 +1,266 @@
+/*
+// Copyright (c) 2015 Pierre Guillot.
+// For information on usage and redistribution, and for a DISCLAIMER OF ALL
+// WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+*/
+
+#include <cfloat>
+#include <cmath>
+
+#include <Hoa.hpp>
+using namespace hoa;
+
+#define CATCH_CONFIG_PREFIX_ALL
+#include "catch.hpp"
+
+// the harmonics of a plane wave
+static std::vector<double> hoa_encode(const size_t order, const double azimuth, const double elevation)
+{
+    Encoder<Hoa3d, double> encoder(order);
+    std::vector<double> harmonics(encoder.getNumberOfHarmonics());
+    encoder.processDirections(1, &azimuth, &elevation, harmonics.data());
+    return harmonics;
+}
+
+// the harmonics of a plane wave moved by a rotation matrix
+static std::vector<double> hoa_encode_rotated(const size_t order, const double azimuth, const double elevation, const double* matrix)
+{
+    const double d[3] = {std::cos(azimuth) * std::cos(elevation), std::sin(azimuth) * std::cos(elevation), std::sin(elevation)};
+    const double x = matrix[0] * d[0] + matrix[1] * d[1] + matrix[2] * d[2];
+    const double y = matrix[3] * d[0] + matrix[4] * d[1] + matrix[5] * d[2];
+    const double z = matrix[6] * d[0] + matrix[7] * d[1] + matrix[8] * d[2];
+    return hoa_encode(order, std::atan2(y, x), std::asin(std::max(-1., std::min(1., z))));
+}
+
+CATCH_TEST_CASE("Rotate 3D", "[Rotate] [3D]")
+{
+    const size_t order = 5;
+    Rotate<Hoa3d, double> rotate(order);
+    const size_t nharmos = rotate.getNumberOfHarmonics();
+    std::vector<double> outputs(nharmos);
+
+    CATCH_SECTION("Angles")
+    {
+        // the identity
+        const auto harmonics = hoa_encode(order, 0.7, 0.3);
+        rotate.process(harmonics.data(), outputs.data());
+        for(size_t i = 0; i < nharmos; ++i)
+        {
+            CATCH_CHECK(outputs[i] == Approx(harmonics[i]).margin(1e-9));
+        }
+
+        // the yaw increases the azimuth
+        rotate.setYaw(1.2);
+        CATCH_CHECK(rotate.getYaw() == Approx(1.2));
+        rotate.process(harmonics.data(), outputs.data());
+        auto expected = hoa_encode(order, 1.9, 0.3);
+        for(size_t i = 0; i < nharmos; ++i)
+        {
+            CATCH_CHECK(outputs[i] == Approx(expected[i]).margin(1e-9));
+        }
+
+        // the pitch raises the azimuth 0 and the roll raises the azimuth pi/2
+        const auto front = hoa_encode(order, 0., 0.);
+        rotate.setYawPitchRoll(0., 0.4, 0.);
+        rotate.process(front.data(), outputs.data());
+        expected = hoa_encode(order, 0., 0.4);
+        for(size_t i = 0; i < nharmos; ++i)
+        {
+            CATCH_CHECK(outputs[i] == Approx(expected[i]).margin(1e-9));
+        }
+        const auto side = hoa_encode(order, HOA_PI2, 0.);
+        rotate.setYawPitchRoll(0., 0., 0.5);
+        rotate.process(side.data(), outputs.data());
+        expected = hoa_encode(order, HOA_PI2, 0.5);
+        for(size_t i = 0; i < nharmos; ++i)
+        {
+            CATCH_CHECK(outputs[i] == Approx(expected[i]).margin(1e-9));
+        }
+
+        // any rotation of any direction, in-place
+        rotate.setYawPitchRoll(-2.1, 0.8, 1.3);
+        for(size_t k = 0; k < 8; ++k)
+        {
+            const double azimuth = double(k) * 0.9 - 2.;
+            const double elevation = double(k) * 0.2 - 0.7;
+            auto result = hoa_encode(order, azimuth, elevation);
+            rotate.process(result.data(), result.data());
+            expected = hoa_encode_rotated(order, azimuth, elevation, rotate.getMatrix());
+            for(size_t i = 0; i < nharmos; ++i)
+            {
+                CATCH_CHECK(result[i] == Approx(expected[i]).margin(1e-9));
+            }
+        }
+    }
+
+    CATCH_SECTION("Quaternion")
+    {
+        // a rotation of 1 radian around the z axis is a yaw
+        Rotate<Hoa3d, double> yaw(order);
+        yaw.setYaw(1.);
+        rotate.setQuaternion(std::cos(0.5), 0., 0., std::sin(0.5));
+        for(size_t i = 0; i < 9; ++i)
+        {
+            CATCH_CHECK(rotate.getMatrix()[i] == Approx(yaw.getMatrix()[i]).margin(1e-12));
+        }
+
+        // the matrices of the degrees are orthogonal
+        const double s = 1. / std::sqrt(3.);
+        rotate.setQuaternion(std::cos(0.6), std::sin(0.6) * s, -std::sin(0.6) * s, std::sin(0.6) * s);
+        for(size_t l = 0; l <= order; ++l)
+        {
+            const size_t size = l * 2 + 1;
+            const double* matrix = rotate.getDegreeMatrix(l);
+            for(size_t i = 0; i < size; ++i)
+            {
+                for(size_t j = 0; j < size; ++j)
+                {
+                    double dot = 0.;
+                    for(size_t k = 0; k < size; ++k) { dot += matrix[i * size + k] * matrix[j * size + k]; }
+                    CATCH_CHECK(dot == Approx(i == j ? 1. : 0.).margin(1e-9));
+                }
+            }
+        }
+    }
+
+    CATCH_SECTION("Block")
+    {
+        const size_t vsize = 21;
+        const auto harmonics = hoa_encode(order, 0.4, -0.2);
+        std::vector<double> inputs(nharmos * vsize);
+        std::vector<double> results(nharmos * vsize);
+        std::vector<const double*> ins(nharmos);
+        std::vector<double*> outs(nharmos);
+        for(size_t i = 0; i < nharmos; ++i)
+        {
+            std::fill(inputs.begin() + i * vsize, inputs.begin() + (i + 1) * vsize, harmonics[i]);
+            ins[i] = inputs.data() + i * vsize;
+            outs[i] = results.data() + i * vsize;
+        }
+
+        // the first block goes from the identity to the rotation
+        rotate.setYawPitchRoll(0.9, -0.3, 0.2);
+        rotate.process(harmonics.data(), outputs.data());
+        rotate.processBlock(vsize, ins.data(), outs.data());
+        for(size_t i = 0; i < nharmos; ++i)
+        {
+            for(size_t n = 0; n < vsize; ++n)
+            {
+                const double ratio = double(n + 1) / double(vsize);
+                const double expected = harmonics[i] * (1. - ratio) + outputs[i] * ratio;
+                CATCH_CHECK(results[i * vsize + n] == Approx(expected).margin(1e-9));
+            }
+        }
+
+        // the next block keeps the rotation, in-place
+        std::vector<const double*> inplace(outs.begin(), outs.end());
+        results = inputs;
+        rotate.processBlock(vsize, inplace.data(), outs.data());
+        for(size_t i = 0; i < nharmos; ++i)
+        {
+            for(size_t n = 0; n < vsize; ++n)
+            {
+                CATCH_CHECK(results[i * vsize + n] == Approx(outputs[i]).margin(1e-9));
+            }
+        }
+    }
+}
+
+CATCH_TEST_CASE("Binaural Head Tracking", "[Rotate] [Decoder] [3D]")
+{
+    typedef DecoderBinaural<Hoa3d, double, hrir::Sadie_D2_3D> decoder_t;
+    const size_t order = 3;
+    const size_t vsize = 64;
+    const size_t nblocks = 8;
+    const double yaw = 0.8, pitch = 0.3, roll = -0.2;
+    const double azimuth = 1.1, elevation = 0.4;
+    decoder_t tracked(order);
+    decoder_t matrix(order);
+    decoder_t fixed(order);
+    tracked.prepare(vsize);
+    matrix.prepare(vsize);
+    fixed.prepare(vsize);
+    CATCH_CHECK(tracked.getHeadTrackingLatency() == vsize);
+
+    // a plane wave seen from the head is the plane wave moved by the inverse rotation
+    double head[9];
+    Rotate<Hoa3d, double>::getMatrix(yaw, pitch, roll, head);
+    const double inverse[9] = {head[0], head[3], head[6], head[1], head[4], head[7], head[2], head[5], head[8]};
+    const auto harmonics = hoa_encode(order, azimuth, elevation);
+    const auto relative = hoa_encode_rotated(order, azimuth, elevation, inverse);
+    const size_t nharmos = harmonics.size();
+
+    std::vector<double> source(vsize);
+    std::vector<double> inputs(nharmos * vsize);
+    std::vector<double> expected(nharmos * vsize);
+    std::vector<const double*> ins(nharmos);
+    std::vector<const double*> exps(nharmos);
+    for(size_t i = 0; i < nharmos; ++i)
+    {
+        ins[i] = inputs.data() + i * vsize;
+        exps[i] = expected.data() + i * vsize;
+    }
+    std::vector<double> outputs(2 * vsize);
+    std::vector<double> references(2 * vsize);
+    std::vector<double*> outs = {outputs.data(), outputs.data() + vsize};
+    std::vector<double*> refs = {references.data(), references.data() + vsize};
+
+    // the interpolation of the first block is applied to silence
+    tracked.setHeadOrientation(yaw, pitch, roll);
+    matrix.setHeadOrientation(yaw, pitch, roll);
+    tracked.processBlock(ins.data(), outs.data());
+    decoder_t::input_matrix_t block = decoder_t::input_matrix_t::Zero(nharmos, vsize);
+    decoder_t::output_matrix_t result(2, vsize);
+    matrix.processBlock(block, result);
+    fixed.processBlock(exps.data(), refs.data());
+    for(size_t b = 0; b < nblocks; ++b)
+    {
+        for(size_t n = 0; n < vsize; ++n)
+        {
+            const size_t t = b * vsize + n;
+            source[n] = std::sin(double(t) * 0.13) + ((t % 37 == 0) ? 1. : 0.);
+        }
+        for(size_t i = 0; i < nharmos; ++i)
+        {
+            for(size_t n = 0; n < vsize; ++n)
+            {
+                inputs[i * vsize + n] = source[n] * harmonics[i];
+                expected[i * vsize + n] = source[n] * relative[i];
+            }
+        }
+        tracked.processBlock(ins.data(), outs.data());
+        fixed.processBlock(exps.data(), refs.data());
+        for(size_t n = 0; n < 2 * vsize; ++n)
+        {
+            CATCH_CHECK(outputs[n] == Approx(references[n]).margin(1e-9));
+        }
+
+        // the block of the Eigen matrices
+        for(size_t i = 0; i < nharmos; ++i)
+        {
+            for(size_t n = 0; n < vsize; ++n) { block(i, n) = inputs[i * vsize + n]; }
+        }
+        matrix.processBlock(block, result);
+        for(size_t n = 0; n < vsize; ++n)
+        {
+            CATCH_CHECK(result(0, n) == Approx(outputs[n]).margin(1e-12));
+            CATCH_CHECK(result(1, n) == Approx(outputs[vsize + n]).margin(1e-12));
+        }
+    }
+
+    // the quaternion of the same orientation gives the same rotation
+    decoder_t quaternion(order);
+    quaternion.prepare(vsize);
+    const double cy = std::cos(yaw * 0.5), sy = std::sin(yaw * 0.5);
+    const double cp = std::cos(pitch * 0.5), sp = std::sin(-pitch * 0.5);
+    const double cr = std::cos(roll * 0.5), sr = std::sin(roll * 0.5);
+    quaternion.setHeadOrientation(cy * cp * cr + sy * sp * sr, cy * cp * sr - sy * sp * cr,
+                                  cy * sp * cr + sy * cp * sr, sy * cp * cr - cy * sp * sr);
+    double rotation[9];
+    Rotate<Hoa3d, double>::getMatrix(cy * cp * cr + sy * sp * sr, cy * cp * sr - sy * sp * cr,
+                                     cy * sp * cr + sy * cp * sr, sy * cp * cr - cy * sp * sr, rotation);
+    for(size_t i = 0; i < 9; ++i)
+    {
+        CATCH_CHECK(rotation[i] == Approx(head[i]).margin(1e-12));
+    }
+}
@@ -0,0 +1,150 @@
+/*
+// Copyright (c) 2015 Pierre Guillot.
+// For information on usage and redistribution, and for a DISCLAIMER OF ALL
+// WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+*/
+
+#include <cfloat>
+#include <cmath>
+
+#include <Hoa.hpp>
+using namespace hoa;
+
+#define CATCH_CONFIG_PREFIX_ALL
+#include "catch.hpp"
+
+CATCH_TEST_CASE("VoiceManager 2D", "[Encoder] [VoiceManager] [2D]")
+{
+    VoiceManager<Hoa2d, float> manager(5, 4, 2);
+    Encoder<Hoa2d, float> encoder(5);
+    Encoder<Hoa2d, float> bed(1);
+    std::vector<float> inputs = {1.f, 0.5f, 0.1f, 0.8f};
+    std::vector<float> outputs(11);
+    std::vector<float> expected(11);
+    std::vector<float> temp(11);
+
+    for(size_t i = 0; i < 4; ++i)
+    {
+        manager.setAzimuth(i, float(i) * 1.2f);
+    }
+
+    CATCH_CHECK(manager.getNumberOfVoices() == 2);
+    CATCH_CHECK(manager.getNumberOfActiveVoices() == 2);
+    CATCH_CHECK(manager.getNumberOfSteals() == 0);
+
+    // measures the loudness and selects the two loudest sources
+    manager.process(inputs.data(), outputs.data());
+    manager.update();
+    CATCH_CHECK(manager.getLoudness(0) == Approx(1.f));
+    CATCH_CHECK(manager.getLoudness(3) == Approx(0.8f));
+    CATCH_CHECK(manager.isVoiceActive(0));
+    CATCH_CHECK(manager.isVoiceActive(3));
+
+    // the initial voices are arbitrary
+    manager.resetNumberOfSteals();
+
+    CATCH_SECTION("Culling")
+    {
+        manager.update();
+        CATCH_CHECK_FALSE(manager.isVoiceActive(1));
+        CATCH_CHECK_FALSE(manager.isVoiceActive(2));
+        manager.process(inputs.data(), outputs.data());
+
+        std::fill(expected.begin(), expected.end(), 0.f);
+        for(size_t i : {size_t(0), size_t(3)})
+        {
+            encoder.setAzimuth(float(i) * 1.2f);
+            encoder.process(&inputs[i], temp.data());
+            for(size_t j = 0; j < 11; ++j) { expected[j] += temp[j]; }
+        }
+        for(size_t j = 0; j < 11; ++j)
+        {
+            CATCH_CHECK(outputs[j] == Approx(expected[j]).margin(1e-6));
+        }
+    }
+
+    CATCH_SECTION("Bed")
+    {
+        manager.setBed(true);
+        manager.update();
+        manager.process(inputs.data(), outputs.data());
+
+        std::fill(expected.begin(), expected.end(), 0.f);
+        for(size_t i : {size_t(0), size_t(3)})
+        {
+            encoder.setAzimuth(float(i) * 1.2f);
+            encoder.process(&inputs[i], temp.data());
+            for(size_t j = 0; j < 11; ++j) { expected[j] += temp[j]; }
+        }
+        for(size_t i : {size_t(1), size_t(2)})
+        {
+            bed.setAzimuth(float(i) * 1.2f);
+            bed.process(&inputs[i], temp.data());
+            for(size_t j = 0; j < 3; ++j) { expected[j] += temp[j]; }
+        }
+        for(size_t j = 0; j < 11; ++j)
+        {
+            CATCH_CHECK(outputs[j] == Approx(expected[j]).margin(1e-6));
+        }
+    }
+
+    CATCH_SECTION("Steal and fade")
+    {
+        manager.setFadeLength(4);
+        manager.setPriority(2, 100.f);
+        manager.process(inputs.data(), outputs.data());
+        manager.update();
+        CATCH_CHECK(manager.getPriority(2) == Approx(100.f));
+        CATCH_CHECK(manager.getNumberOfSteals() == 1);
+        CATCH_CHECK(manager.isVoiceActive(2));
+        CATCH_CHECK(manager.isVoiceActive(3));
+
+        // the stolen voice fades out
+        CATCH_CHECK(manager.getNumberOfActiveVoices() == 3);
+        for(size_t i = 0; i < 4; ++i)
+        {
+            manager.process(inputs.data(), outputs.data());
+        }
+        CATCH_CHECK(manager.getNumberOfActiveVoices() == 2);
+        manager.update();
+        CATCH_CHECK(manager.getNumberOfSteals() == 1);
+
+        manager.resetNumberOfSteals();
+        CATCH_CHECK(manager.getNumberOfSteals() == 0);
+    }
+
+    CATCH_SECTION("Mute")
+    {
+        manager.setMute(0, true);
+        manager.update();
+        CATCH_CHECK_FALSE(manager.isVoiceActive(0));
+        CATCH_CHECK(manager.isVoiceActive(1));
+        CATCH_CHECK(manager.getNumberOfSteals() == 0);
+    }
+}
+
+CATCH_TEST_CASE("VoiceManager 3D", "[Encoder] [VoiceManager] [3D]")
+{
+    VoiceManager<Hoa3d, float> manager(3, 3, 3);
+    MultiEncoder<Hoa3d, float> multi(3, 3);
+    std::vector<float> inputs = {1.f, 0.5f, 0.25f};
+    std::vector<float> outputs(16);
+    std::vector<float> expected(16);
+
+    for(size_t i = 0; i < 3; ++i)
+    {
+        manager.setAzimuth(i, float(i));
+        manager.setElevation(i, float(i) * 0.3f);
+        multi.setAzimuth(i, float(i));
+        multi.setElevation(i, float(i) * 0.3f);
+    }
+
+    // with enough voices the manager is equivalent to the multi encoder
+    manager.process(inputs.data(), outputs.data());
+    multi.process(inputs.data(), expected.data());
+    for(size_t j = 0; j < 16; ++j)
+    {
+        CATCH_CHECK(outputs[j] == Approx(expected[j]).margin(1e-6));
+    }
+    CATCH_CHECK(manager.getNumberOfActiveVoices() == 3);
+}